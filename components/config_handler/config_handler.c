@@ -9,6 +9,7 @@
 
 static const char *TAG = "config_rest";
 static const char *CONFIG_PATH = "/spiffs/config.json";
+static httpd_handle_t rest_server = NULL;
 
 void cjson_merge_objects(cJSON *target, const cJSON *patch)
 {
@@ -218,10 +219,13 @@ void start_rest_server(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.stack_size = 8192;
+    config.max_uri_handlers = 16; // Room for endpoints registered by the application
 
     httpd_handle_t server = NULL;
     if (httpd_start(&server, &config) == ESP_OK)
     {
+        rest_server = server;
+
         httpd_uri_t get_uri = {
             .uri = "/config",
             .method = HTTP_GET,
@@ -246,3 +250,9 @@ void start_rest_server(void)
         ESP_LOGI(TAG, "REST-Schnittstelle bereit auf /config");
     }
 }
+
+// Returns the running HTTP server so other modules can add endpoints
+httpd_handle_t get_rest_server(void)
+{
+    return rest_server;
+}
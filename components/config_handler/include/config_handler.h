@@ -1,3 +1,6 @@
 #pragma once
 
+#include "esp_http_server.h"
+
 void start_rest_server(void);
+httpd_handle_t get_rest_server(void);
@@ -0,0 +1,98 @@
+#include "my_config.h"
+
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Pair descriptors, one per start channel plus one for channels out of
+// range (defaults only), in two tables. Readers copy a pair out of the
+// active table; a load rebuilds the other one and makes it active.
+//
+// A reader counts itself in on the table it is about to read and then
+// checks that the table is still active, otherwise it backs out and
+// retries. So once a table is inactive and its count is zero, no reader
+// is inside it (the grace period), and it can be rebuilt even if the
+// last swap was only a moment ago.
+static ct_pair_t ct_tables[2][CT_CHANNELS + 1];
+static atomic_int active_table = 0;
+static atomic_uint table_readers[2];
+
+static int clamp_ct(int ct)
+{
+    return (ct < 0) ? 0 : (ct > CT_MAX_K ? CT_MAX_K : ct);
+}
+
+// Same fallback and ordering as get_ct_sorted used to apply per command
+static void resolve_ct_pair(ct_pair_t *pair, int ct1, int ct2, int default_min, int default_max)
+{
+    if (ct1 == 0 && ct2 == 0)
+    {
+        ct1 = default_min;
+        ct2 = default_max;
+    }
+    else if (ct1 == 0)
+    {
+        ct1 = default_min;
+    }
+    else if (ct2 == 0)
+    {
+        ct2 = default_max;
+    }
+    ct1 = clamp_ct(ct1);
+    ct2 = clamp_ct(ct2);
+
+    pair->ww_offset = (ct1 <= ct2) ? 0 : 1;
+    pair->ct_ww = (uint16_t)((ct1 <= ct2) ? ct1 : ct2);
+    pair->ct_cw = (uint16_t)((ct1 <= ct2) ? ct2 : ct1);
+
+    // With d <= 2^l and dividends below 2^(8 + l), ceil(2^(8 + 2l) / d)
+    // gives exact quotients; CT_MAX_K keeps recip within 32 bits
+    uint32_t d = 100u * (uint32_t)(pair->ct_cw - pair->ct_ww);
+    uint8_t l = 0;
+    while ((1u << l) < d)
+    {
+        l++;
+    }
+    pair->shift = 8 + 2 * l;
+    pair->recip = d ? (uint32_t)(((1ULL << pair->shift) + d - 1) / d) : 0;
+}
+
+void ct_pairs_resolve(const int *ct_config, int default_min, int default_max)
+{
+    int table = 1 - atomic_load(&active_table);
+
+    // Readers that picked this table before the last swap copy one pair
+    // and leave; let them finish
+    while (atomic_load(&table_readers[table]) != 0)
+    {
+        vTaskDelay(1);
+    }
+
+    ct_pair_t *pairs = ct_tables[table];
+    for (int ch = 0; ch < CT_CHANNELS; ++ch)
+    {
+        resolve_ct_pair(&pairs[ch], ct_config[ch], (ch + 1 < CT_CHANNELS) ? ct_config[ch + 1] : 0,
+                        default_min, default_max);
+    }
+    resolve_ct_pair(&pairs[CT_CHANNELS], 0, 0, default_min, default_max);
+
+    atomic_store(&active_table, table);
+}
+
+ct_pair_t get_ct_pair(int ch)
+{
+    int index = (ch >= 0 && ch < CT_CHANNELS) ? ch : CT_CHANNELS;
+
+    while (1)
+    {
+        int table = atomic_load(&active_table);
+        atomic_fetch_add(&table_readers[table], 1);
+        if (atomic_load(&active_table) == table)
+        {
+            ct_pair_t pair = ct_tables[table][index];
+            atomic_fetch_sub(&table_readers[table], 1);
+            return pair;
+        }
+        atomic_fetch_sub(&table_readers[table], 1); // Swapped meanwhile
+    }
+}
@@ -1,7 +1,35 @@
 #pragma once
 
+#include <stdint.h>
+
+#define CT_MAX_K 20000 // Configured color temperatures are clamped to 0..CT_MAX_K
+#define CT_CHANNELS 512
+
+// Tunable white pair at channels ch and ch + 1, resolved from ct_config and
+// default_ct whenever the configuration is loaded. recip and shift turn the
+// mix division by 100 * (ct_cw - ct_ww) into a multiply (exact for
+// dividends below 256 times the divisor).
+typedef struct
+{
+    uint16_t ct_ww;    // Warm end of the pair in K
+    uint16_t ct_cw;    // Cold end in K
+    uint32_t recip;    // ceil(2^shift / (100 * (ct_cw - ct_ww))), 0 if both ends are equal
+    uint8_t shift;
+    uint8_t ww_offset; // Warm channel is ch + ww_offset
+} ct_pair_t;
+
 void spiffs_init(void);
 void config_load_ct_values(const char *json);
 void config_load_from_spiffs(const char *path);
 void get_ct_range(int ch, int *min_ct, int *max_ct);
-void get_ct_sorted(int ch, int *ct_ww, int *ct_cw, int *ch_ww, int *ch_cw);
\ No newline at end of file
+void get_ct_sorted(int ch, int *ct_ww, int *ct_cw, int *ch_ww, int *ch_cw);
+
+// Rebuild the pair descriptors from ct_config (CT_CHANNELS entries, 0 = not
+// set). One writer at a time: the boot sequence, then the HTTP server task.
+// Runs before the DMX render task starts, so it never sees an unresolved
+// table; until then every pair is all zero (warm channel only).
+void ct_pairs_resolve(const int *ct_config, int default_min, int default_max);
+
+// Pair of channel ch, copied out of the active table. No lookups, logging
+// or waiting for writers; safe on the DMX hot path.
+ct_pair_t get_ct_pair(int ch);
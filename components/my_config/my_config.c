@@ -1,3 +1,4 @@
+#include "my_config.h"
 #include "cJSON.h"
 #include "esp_log.h"
 #include "esp_spiffs.h"
@@ -5,7 +6,7 @@
 
 #include "my_wifi.h"
 
-#define MAX_CHANNELS 512
+#define MAX_CHANNELS CT_CHANNELS
 static int ct_config[MAX_CHANNELS]; // 0 = not set
 
 static const char *TAG = "config";
@@ -13,6 +14,8 @@ static const char *TAG = "config";
 int default_min_ct = 3500;
 int default_max_ct = 6700;
 
+static void resolve_ct_pairs(void);
+
 void spiffs_init(void)
 {
     esp_vfs_spiffs_conf_t conf = {
@@ -57,6 +60,7 @@ void config_load_ct_values(const char *json)
     if (!root)
     {
         ESP_LOGE(TAG, "JSON parsing failed");
+        resolve_ct_pairs(); // Keep the previous CTs, or the defaults
         return;
     }
 
@@ -130,6 +134,23 @@ void config_load_ct_values(const char *json)
     ESP_LOGD(TAG, "Loaded default values after patch: min=%d, max=%d", default_min_ct, default_max_ct);
 
     cJSON_Delete(root);
+
+    // Missing channel CTs fall back to the defaults here, once, instead of
+    // warning on every DMXL command
+    resolve_ct_pairs();
+
+    int configured = 0;
+    for (int i = 1; i < MAX_CHANNELS; ++i)
+    {
+        configured += (ct_config[i] != 0);
+    }
+    ESP_LOGI(TAG, "CT profiles resolved: %d channels configured, others use %d–%d K",
+             configured, default_min_ct, default_max_ct);
+}
+
+static void resolve_ct_pairs(void)
+{
+    ct_pairs_resolve(ct_config, default_min_ct, default_max_ct);
 }
 
 void config_load_from_spiffs(const char *path)
@@ -138,6 +159,7 @@ void config_load_from_spiffs(const char *path)
     if (!f)
     {
         ESP_LOGE(TAG, "Cannot open file: %s", path);
+        resolve_ct_pairs(); // DMXL runs on the defaults
         return;
     }
 
@@ -150,6 +172,7 @@ void config_load_from_spiffs(const char *path)
     {
         ESP_LOGE(TAG, "Could not allocate memory for JSON buffer");
         fclose(f);
+        resolve_ct_pairs();
         return;
     }
 
@@ -197,42 +220,10 @@ void get_ct_range(int ch, int *min_ct, int *max_ct)
 
 void get_ct_sorted(int ch, int *ct_ww, int *ct_cw, int *ch_ww, int *ch_cw)
 {
-    int ct1 = (ch >= 0 && ch < MAX_CHANNELS) ? ct_config[ch] : 0;
-    int ct2 = (ch + 1 >= 0 && ch + 1 < MAX_CHANNELS) ? ct_config[ch + 1] : 0;
-
-    int ch1 = ch;
-    int ch2 = ch + 1;
+    ct_pair_t pair = get_ct_pair(ch);
 
-    // Fallback for missing configuration
-    if (ct1 == 0 && ct2 == 0)
-    {
-        ct1 = default_min_ct;
-        ct2 = default_max_ct;
-        ESP_LOGW(TAG, "CT for both channels %d/%d missing – using defaults %dK/%dK", ch1, ch2, ct1, ct2);
-    }
-    else if (ct1 == 0)
-    {
-        ct1 = default_min_ct;
-        ESP_LOGW(TAG, "CT for channel %d missing – using default %dK", ch1, ct1);
-    }
-    else if (ct2 == 0)
-    {
-        ct2 = default_max_ct;
-        ESP_LOGW(TAG, "CT for channel %d missing – using default %dK", ch2, ct2);
-    }
-
-    if (ct1 <= ct2)
-    {
-        *ct_ww = ct1;
-        *ch_ww = ch1;
-        *ct_cw = ct2;
-        *ch_cw = ch2;
-    }
-    else
-    {
-        *ct_ww = ct2;
-        *ch_ww = ch2;
-        *ct_cw = ct1;
-        *ch_cw = ch1;
-    }
+    *ct_ww = pair.ct_ww;
+    *ct_cw = pair.ct_cw;
+    *ch_ww = ch + pair.ww_offset;
+    *ch_cw = ch + 1 - pair.ww_offset;
 }
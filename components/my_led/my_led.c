@@ -61,7 +61,7 @@ void my_led_init(int gpio)
 
     gpio_set_level(led_gpio, 1); // LED aus
 
-    xTaskCreate(led_status_task, "led_status_task", 2048, NULL, 2, NULL);
+    xTaskCreatePinnedToCore(led_status_task, "led_status_task", 2048, NULL, 2, NULL, PRO_CPU_NUM);
 }
 
 // Benutzeraktion (z. B. WLAN-Wechsel) signalisieren
@@ -242,6 +242,7 @@ void my_wifi_init(void)
 
     connect_to_wifi(current_network);
 
-    xTaskCreate(button_task, "wifi_button_task", 2048, NULL, 5, NULL);
-    xTaskCreate(reconnect_task, "reconnect_task", 4096, NULL, 5, &reconnect_task_handle);
+    // Helpers stay on the Wi-Fi core below the gateway's network tasks
+    xTaskCreatePinnedToCore(button_task, "wifi_button_task", 2048, NULL, 2, NULL, PRO_CPU_NUM);
+    xTaskCreatePinnedToCore(reconnect_task, "reconnect_task", 4096, NULL, 2, &reconnect_task_handle, PRO_CPU_NUM);
 }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Art-Net 4 protocol constants
+#define ARTNET_PORT 6454
+#define ARTNET_HEADER_SIZE 10          // "Art-Net\0" + OpCode
+#define ARTNET_DMX_HEADER_SIZE 18
+#define ARTNET_POLL_MIN_SIZE 12
+#define ARTNET_POLL_REPLY_SIZE 239
+#define ARTNET_PROTOCOL_VERSION 14
+#define ARTNET_MAX_PORT_ADDRESS 0x7FFF // 15 bit Net/SubNet/Universe
+#define ARTNET_SEQUENCE_RESYNC 8       // Out-of-order frames in a row before the sequence is reset
+
+// OpCodes (transmitted little endian)
+typedef enum {
+    ARTNET_OP_POLL = 0x2000,
+    ARTNET_OP_POLL_REPLY = 0x2100,
+    ARTNET_OP_DMX = 0x5000
+} artnet_opcode_t;
+
+// Parser / filter results
+typedef enum {
+    ARTNET_OK = 0,
+    ARTNET_ERR_HEADER,       // Too short or not an Art-Net packet
+    ARTNET_ERR_VERSION,      // Protocol version below 14
+    ARTNET_ERR_LENGTH,       // DMX length missing, zero, above 512 or truncated
+    ARTNET_NOT_OURS,         // Port-Address is not mapped to a local universe
+    ARTNET_OUT_OF_ORDER      // Sequence number older than the last accepted frame
+} artnet_result_t;
+
+// Parsed ArtDmx; data points into the receive buffer
+typedef struct {
+    uint8_t sequence;       // 0 = sequencing disabled by the sender
+    uint8_t physical;
+    uint16_t port_address;  // Net (7 bit) | SubNet (4 bit) | Universe (4 bit)
+    uint16_t length;        // Slots in data (1-512)
+    const uint8_t *data;    // Slot 1 onwards, start code not included
+} artnet_dmx_t;
+
+// Values reported in ArtPollReply
+typedef struct {
+    uint8_t ip[4];
+    uint8_t mac[6];
+    const char *short_name;
+    const char *long_name;
+} artnet_node_info_t;
+
+// Statistics
+typedef struct {
+    uint32_t dmx_received;      // ArtDmx packets parsed
+    uint32_t dmx_accepted;      // Forwarded to a local universe
+    uint32_t dmx_filtered;      // Port-Address not ours
+    uint32_t dmx_out_of_order;  // Dropped by the sequence check
+    uint32_t polls_received;
+    uint32_t packets_invalid;   // Art-Net packets that failed to parse
+} artnet_stats_t;
+
+// Receiver setup: local universe n listens on base_port_address + n
+void artnet_init(uint16_t base_port_address, int universe_count);
+uint16_t artnet_port_address(int net, int subnet, int universe);
+
+// Packet parsing
+bool artnet_is_packet(const uint8_t *buf, size_t len);
+uint16_t artnet_get_opcode(const uint8_t *buf);
+artnet_result_t artnet_parse_dmx(const uint8_t *buf, size_t len, artnet_dmx_t *out);
+artnet_result_t artnet_parse_poll(const uint8_t *buf, size_t len);
+
+// Map a parsed ArtDmx to a local universe and apply the sequence check
+artnet_result_t artnet_accept_dmx(const artnet_dmx_t *dmx, int *universe);
+
+// Build the ArtPollReply for one local universe (BindIndex universe + 1),
+// returns the packet size
+size_t artnet_build_poll_reply(uint8_t *buf, const artnet_node_info_t *info, int universe);
+
+// The server task counts and publishes; readers get the last published copy
+void artnet_publish_stats(void);
+artnet_stats_t artnet_get_stats(void);
+void artnet_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "udp_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Command queue configuration
+#define CMD_QUEUE_LENGTH 64          // Must be a power of two
+#define CMD_QUEUE_PAYLOAD_SIZE 2048  // Payload bytes, must be a power of two
+
+// Queue entry types
+typedef enum {
+    CMD_QUEUE_COMMAND,   // Pre-parsed command, range levels in the payload
+    CMD_QUEUE_UNIVERSE,  // Raw universe data in the payload, takes over the universe
+    CMD_QUEUE_SPAN       // Raw levels in the payload for a channel span
+} cmd_queue_kind_t;
+
+typedef struct {
+    cmd_queue_kind_t kind;
+    udp_parsed_command_t cmd;  // CMD_QUEUE_COMMAND
+    uint8_t universe;          // CMD_QUEUE_UNIVERSE/SPAN: target universe
+    uint16_t start;            // CMD_QUEUE_SPAN: first channel
+    uint16_t fade_ms;          // CMD_QUEUE_SPAN: fade time, 0 = immediate
+    uint16_t length;           // Payload bytes, 0 if none
+    uint16_t payload_offset;   // Start of the payload in the payload ring
+    uint32_t payload_end;      // Payload ring position after this entry
+    int64_t received_us;       // esp_timer timestamp of the source packet
+    int64_t queued_us;         // esp_timer timestamp of the push
+} cmd_queue_entry_t;
+
+// Consumer callback; payload is only valid during the call. Commands that
+// carried a payload pointer get it in payload, cmd.payload is stale.
+typedef void (*cmd_queue_handler_t)(const cmd_queue_entry_t *entry, const uint8_t *payload);
+
+// Lock-free single-producer/single-consumer queue between the UDP server
+// task (producer) and the DMX render task (consumer)
+void cmd_queue_reset(void);
+
+// Producer side - return false when the queue is full. Command payloads
+// are copied into the queue. A batch is published at once, so the render
+// task applies all of it in one frame.
+bool cmd_queue_push_command(const udp_parsed_command_t *cmd, int64_t received_us);
+bool cmd_queue_push_commands(const udp_parsed_command_t *cmds, int count, int64_t received_us);
+bool cmd_queue_push_universe(int universe, const uint8_t *data, size_t len, int64_t received_us);
+bool cmd_queue_push_span(int universe, int start, const uint8_t *data, size_t len, int fade_ms, int64_t received_us);
+
+// Producer side - entries pushed between begin and end are published
+// together at the end; returns the queue depth after publishing
+void cmd_queue_batch_begin(void);
+uint32_t cmd_queue_batch_end(void);
+
+// Consumer side - runs handler for every entry queued before the call,
+// returns the number of entries handled
+int cmd_queue_drain(cmd_queue_handler_t handler);
+
+// Number of entries currently queued
+uint32_t cmd_queue_depth(void);
+
+#ifdef __cplusplus
+}
+#endif
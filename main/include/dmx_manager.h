@@ -11,7 +11,17 @@ extern "C" {
 
 // DMX Manager Configuration
 #define DMX_UNIVERSE_SIZE 512
-#define DMX_FADE_INTERVAL_MS 30
+#define DMX_MAX_UNIVERSES 2      // One per free UART (DMX_NUM_1, DMX_NUM_2)
+#define DMX_FRAME_INTERVAL_MS 30 // Default render/send frame clock (~33 Hz)
+#define DMX_MIN_FRAME_SLOTS 25   // Start code + 24 slots keeps the minimum packet time
+#define DMX_IDLE_HOLD_FRAMES 8   // Frames without changes before the frame clock stops
+#define DMX_IDLE_REFRESH_MS 250  // Resend interval while idle; receivers treat ~1 s without data as signal loss
+
+// DMX512 wire timing used to bound the frame rate (250 kbit/s, 11 bit slots)
+#define DMX_BREAK_US 176
+#define DMX_MAB_US 12
+#define DMX_SLOT_US 44
+#define DMX_MAX_FADE_MS (1 << 21) // ~35 min, bounds the fixed-point fade kernel
 
 // Command result types for better error handling
 typedef enum {
@@ -20,28 +30,104 @@ typedef enum {
     DMX_CMD_ERROR_INVALID_VALUE,
     DMX_CMD_ERROR_CONFIG_MISSING,
     DMX_CMD_ERROR_MEMORY,
-    DMX_CMD_ERROR_TIMEOUT
+    DMX_CMD_ERROR_INVALID_UNIVERSE
 } dmx_command_result_t;
 
-// DMX Manager functions
-esp_err_t dmx_manager_init(int tx_pin, int rx_pin, int en_pin);
+#define DMX_CHANGE_WORDS (DMX_UNIVERSE_SIZE / 32) // Words of a per-slot change bitmap
+
+// Called by the render task at the start of every frame, before fades
+// advance. Channel writes made from the hook are coalesced per slot: only
+// the last write and the last fade of a channel are applied, once the hook
+// returns.
+typedef void (*dmx_frame_hook_t)(void);
+
+// Called by the render task after a frame that published new values or
+// finished fades; must not block
+typedef void (*dmx_change_hook_t)(void);
+
+// Transceiver pins of one universe
+typedef struct {
+    int tx_pin;
+    int rx_pin;
+    int en_pin;
+} dmx_port_pins_t;
+
+// DMX Manager functions - universes are numbered from 0, universe n is
+// driven with pins[n]
+esp_err_t dmx_manager_init(const dmx_port_pins_t *pins, int universe_count);
 void dmx_manager_deinit(void);
 bool dmx_manager_is_initialized(void);
+int dmx_manager_get_universe_count(void);
+
+// Output configuration (system_config_t.dmx)
+typedef struct {
+    int max_slots;            // Configured universe size cap
+    int frame_interval_ms;    // Configured frame interval
+    int frame_slots;          // Slots sent per frame (longest universe)
+    uint32_t frame_period_us; // Effective frame period
+} dmx_output_info_t;
+
+esp_err_t dmx_manager_set_output(int universe_size, int interval_ms);
+dmx_output_info_t dmx_manager_get_output_info(void);
+
+// Render task control
+void dmx_manager_set_frame_hook(dmx_frame_hook_t hook);
+// Wake the render task for a frame if its clock stopped while idle; call
+// after queueing work for the frame hook. Channel writes do it themselves.
+void dmx_manager_request_frame(void);
+// Called by the frame hook for each applied command, feeds the latency
+// statistics and the per-stage traces (latency_trace.h)
+void dmx_manager_track_command(int universe, int64_t received_us, int64_t queued_us);
+
+// Change tracking for state feedback: while a change hook is set, the
+// render task collects the slots whose published value changed or whose
+// fade finished. take_changes copies and clears them, returns false if
+// there were none.
+void dmx_manager_set_change_hook(dmx_change_hook_t hook);
+bool dmx_manager_take_changes(int universe, uint32_t changed[DMX_CHANGE_WORDS]);
 
 // Channel operations
-dmx_command_result_t dmx_set_channel(int channel, uint8_t value, int fade_ms);
-dmx_command_result_t dmx_set_multi_channels(int start_channel, const uint8_t *values, int count, int fade_ms);
-dmx_command_result_t dmx_set_rgb(int channel, uint8_t r, uint8_t g, uint8_t b, int fade_ms);
-dmx_command_result_t dmx_set_tunable_white(int channel, uint8_t warm_white, uint8_t cold_white, int fade_ms);
-dmx_command_result_t dmx_set_light_ct(int channel, int brightness_percent, int color_temp_k, int fade_ms);
+dmx_command_result_t dmx_set_channel(int universe, int channel, uint8_t value, int fade_ms);
+dmx_command_result_t dmx_set_multi_channels(int universe, int start_channel, const uint8_t *values, int count, int fade_ms);
+dmx_command_result_t dmx_set_rgb(int universe, int channel, uint8_t r, uint8_t g, uint8_t b, int fade_ms);
+dmx_command_result_t dmx_set_tunable_white(int universe, int channel, uint8_t warm_white, uint8_t cold_white, int fade_ms);
+dmx_command_result_t dmx_set_light_ct(int universe, int channel, int brightness_percent, int color_temp_k, int fade_ms);
 
 // Utility functions
-uint8_t dmx_get_channel_value(int channel);
-bool dmx_is_channel_fading(int channel);
-void dmx_stop_all_fades(void);
+uint8_t dmx_get_channel_value(int universe, int channel);
+bool dmx_is_channel_fading(int universe, int channel);
+int dmx_get_active_fade_count(void); // All universes
+void dmx_stop_all_fades(int universe);
+
+// Statistics, published by the render task once per frame;
+// dmx_manager_get_stats returns a consistent snapshot
+typedef struct {
+    uint32_t frames_sent;       // Frames handed to dmx_send (per universe)
+    uint32_t frames_published;  // Universe frames with changed data
+    uint32_t frames_idle;       // Universe frames with nothing to render (lock skipped)
+    uint32_t bytes_written;     // Slot bytes copied into the driver buffer
+    uint32_t spans_written;     // dmx_write_offset calls (dirty spans)
+    uint32_t fades_started;     // Fades armed via start_fade
+    uint32_t fades_completed;   // Fades that reached their target
+    uint32_t commands_coalesced; // Channel writes and fades superseded within a frame
+    uint32_t latency_samples;   // Commands measured from receive to dmx_send
+    uint32_t latency_avg_us;
+    uint32_t latency_last_us;   // Oldest command of the last measured frame
+    uint32_t latency_max_us;
+    uint32_t jitter_samples;    // Frames measured from one dmx_send to the next
+    uint32_t jitter_avg_us;     // Deviation of that interval from the frame period
+    uint32_t jitter_max_us;
+    uint32_t wake_max_us;       // Frame clock tick to render task running
+    uint32_t render_wakeups;    // Render passes: clock ticks, requests while idle and keep-alives
+    uint32_t idle_sleeps;       // Times the frame clock stopped with nothing changing
+} dmx_manager_stats_t;
+
+dmx_manager_stats_t dmx_manager_get_stats(void);
+void dmx_manager_reset_stats(void);
 
 // Bounds checking
 bool dmx_is_channel_valid(int channel, int count);
+bool dmx_is_universe_valid(int universe);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compressed universe stream: magic, version, frame type, universe,
+// sequence, base sequence, then RLE tokens. Keyframes decode over an
+// all-zero universe, delta frames over the frame with the base sequence.
+#define DMX_STREAM_MAGIC 0xDD
+#define DMX_STREAM_VERSION 1
+#define DMX_STREAM_HEADER_SIZE 6
+
+// Tokens: 00nnnnnn skip n+1 slots, 01nnnnnn n+1 literal levels follow,
+// 1nnnnnnn repeat the next level n+1 times
+#define DMX_STREAM_TOKEN_SKIP 0x00
+#define DMX_STREAM_TOKEN_LITERAL 0x40
+#define DMX_STREAM_TOKEN_REPEAT 0x80
+
+typedef enum {
+    DMX_STREAM_KEYFRAME = 0,
+    DMX_STREAM_DELTA = 1
+} dmx_stream_frame_type_t;
+
+// Decoder results
+typedef enum {
+    DMX_STREAM_OK = 0,
+    DMX_STREAM_ERR_HEADER,       // Too short, wrong magic or frame type
+    DMX_STREAM_ERR_VERSION,      // Unsupported stream version
+    DMX_STREAM_ERR_CORRUPT,      // Tokens run past the data or the universe
+    DMX_STREAM_NOT_OURS,         // Universe not configured
+    DMX_STREAM_OUT_OF_ORDER,     // Frame not newer than the current one
+    DMX_STREAM_NEED_KEYFRAME     // Delta after a lost frame, waiting for a keyframe
+} dmx_stream_result_t;
+
+// Decoded frame; levels points at the universe's reference frame (slot 1
+// at index 0) and stays valid until the next decode for that universe
+typedef struct {
+    int universe;
+    bool keyframe;
+    int first;               // First slot written (0-based)
+    int count;               // Slots written from first on, 0 for an empty delta
+    const uint8_t *levels;
+} dmx_stream_frame_t;
+
+// Statistics
+typedef struct {
+    uint32_t keyframes;          // Keyframes decoded
+    uint32_t deltas;             // Delta frames decoded
+    uint32_t out_of_order;       // Stale deltas and keyframes dropped
+    uint32_t deltas_dropped;     // Deltas dropped while waiting for a keyframe
+    uint32_t resyncs;            // Lost or unqueued frames that required a keyframe
+    uint32_t packets_invalid;
+    uint32_t bytes_received;     // Encoded bytes of decoded frames
+    uint32_t slots_decoded;      // Slots written by decoded frames
+} dmx_stream_stats_t;
+
+// Decoder setup; every universe waits for a keyframe
+void dmx_stream_init(int universe_count);
+
+// Magic, version and frame type match
+bool dmx_stream_is_packet(const uint8_t *buf, size_t len);
+
+// Decode into the universe's reference frame. A header error leaves all
+// state untouched; a corrupt body drops the reference until the next keyframe.
+dmx_stream_result_t dmx_stream_decode(const uint8_t *buf, size_t len, dmx_stream_frame_t *out);
+
+// Drop the reference frame of a universe whose decoded frame could not
+// be applied, so its next deltas wait for a keyframe
+void dmx_stream_invalidate(int universe);
+
+// Published by the decoding task (UDP server), read from any task
+void dmx_stream_publish_stats(void);
+dmx_stream_stats_t dmx_stream_get_stats(void);
+void dmx_stream_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
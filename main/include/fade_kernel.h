@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed-point fade kernel, bit-exact with the original float interpolation
+//
+//   t = (float)elapsed / (float)duration
+//   value = roundf(start + (target - start) * t)
+//
+// The exact value is start + delta * elapsed / duration. Rounded half up
+// (what roundf() does for the non-negative values used here), with
+// d = 2 * duration it is start + floor((2 * delta * elapsed + duration) / d)
+// for rising fades and start - floor((2 * |delta| * elapsed + duration - 1) / d)
+// for falling ones. The division is a multiply with a reciprocal computed
+// once per fade: for n < 2^(8 + l) and d <= 2^l, ceil(2^(8 + 2l) / d) yields
+// exact quotients (Granlund/Montgomery), and DMX_MAX_FADE_MS keeps l <= 22
+// so recip fits 32 bit and n * recip 64 bit.
+//
+// The float expression is off the exact value by less than 2^-14 (two
+// roundings of at most 255 * 2^-24 and one of 2^-16 at a sum below 256).
+// Only when the exact value is that close to x.5 can the two round
+// differently; those steps are rare and take the float path, so every
+// step matches the original.
+typedef struct
+{
+    uint32_t recip; // ceil(2^shift / (2 * duration_ms))
+    uint8_t shift;
+} fade_kernel_t;
+
+#define FADE_KERNEL_TIE_BITS 14 // Float error bound, 2^-FADE_KERNEL_TIE_BITS
+
+// 1 <= duration_ms <= DMX_MAX_FADE_MS
+static inline fade_kernel_t fade_kernel_prepare(uint32_t duration_ms)
+{
+    uint32_t d = 2u * duration_ms;
+    uint8_t l = 0;
+    while ((1u << l) < d)
+    {
+        l++;
+    }
+
+    fade_kernel_t kernel;
+    kernel.shift = 8 + 2 * l;
+    kernel.recip = (uint32_t)(((1ULL << kernel.shift) + d - 1) / d);
+    return kernel;
+}
+
+// The original expression, kept for near-tie steps
+static inline uint8_t fade_kernel_float(uint8_t start, uint8_t target, uint32_t duration_ms, uint32_t elapsed_ms)
+{
+    float t = (float)(int)elapsed_ms / (float)(int)duration_ms;
+    float interpolated = start + (target - start) * t;
+    return (uint8_t)roundf(interpolated);
+}
+
+// Caller guarantees 0 <= elapsed_ms < duration_ms
+static inline uint8_t fade_kernel_value(const fade_kernel_t *kernel, uint8_t start, uint8_t target,
+                                        uint32_t duration_ms, uint32_t elapsed_ms)
+{
+    uint32_t d = 2u * duration_ms;
+    bool rising = target >= start;
+    uint32_t delta = rising ? (uint32_t)(target - start) : (uint32_t)(start - target);
+    uint32_t n = 2u * delta * elapsed_ms + duration_ms - (rising ? 0u : 1u);
+    uint32_t q = (uint32_t)(((uint64_t)n * kernel->recip) >> kernel->shift);
+
+    // Distance of the exact value from the rounding boundary, in 1/d
+    uint32_t r = n - q * d + (rising ? 0u : 1u);
+    uint32_t dist = (r < d - r) ? r : d - r;
+    if (((uint64_t)dist << FADE_KERNEL_TIE_BITS) <= d)
+    {
+        return fade_kernel_float(start, target, duration_ms, elapsed_ms);
+    }
+
+    return rising ? start + (uint8_t)q : start - (uint8_t)q;
+}
+
+#ifdef __cplusplus
+}
+#endif
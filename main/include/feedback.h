@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lwip/sockets.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// State feedback configuration
+#define FEEDBACK_MAX_SUBSCRIBERS 8
+#define FEEDBACK_LEASE_MS 60000            // Subscriptions expire unless renewed
+#define FEEDBACK_DEFAULT_INTERVAL_MS 100   // Minimum time between notifications
+#define FEEDBACK_MIN_INTERVAL_MS 20
+#define FEEDBACK_MAX_INTERVAL_MS 60000
+#define FEEDBACK_MAX_PACKET_SIZE 1024
+
+// Statistics
+typedef struct {
+    uint32_t subscribes;         // Subscriptions added or renewed
+    uint32_t unsubscribes;
+    uint32_t expired;            // Leases that ran out
+    uint32_t rejected;           // No free subscriber slot
+    uint32_t notifications;      // Datagrams sent
+    uint32_t channels_reported;  // Channel states sent
+    uint32_t rate_limited;       // Sends postponed by the subscriber interval
+    uint32_t send_errors;
+    uint32_t active_subscribers;
+} feedback_stats_t;
+
+// Starts the feedback task and hooks into the renderer's change tracking
+esp_err_t feedback_init(void);
+
+// Subscription handling (UDP server task). A subscription is identified by
+// address, port, universe and channel range; subscribing again renews its
+// lease. A new subscription reports every subscribed channel once right
+// away, a renewal does not.
+esp_err_t feedback_subscribe(const struct sockaddr_in *addr, int universe, int channel, int count, int interval_ms);
+void feedback_unsubscribe(const struct sockaddr_in *addr); // All subscriptions of this address
+
+// Safe from any task; the counters are published whenever the subscriber
+// table is released
+feedback_stats_t feedback_get_stats(void);
+void feedback_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
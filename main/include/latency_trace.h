@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-stage latency histograms of the command path. Plain C without
+// ESP-IDF dependencies: callers pass esp_timer_get_time() timestamps, so
+// the module also builds on the host.
+#define LATENCY_TRACE_FRAME_MAX 64   // Commands traced per frame, the rest are not sampled
+#define LATENCY_TRACE_SUB_BITS 3     // 8 buckets per power of two, <= 12.5% error
+#define LATENCY_TRACE_BUCKETS 176    // Up to about 16 s
+
+typedef enum {
+    LATENCY_STAGE_PARSE,   // recvfrom returned -> parsed and queued
+    LATENCY_STAGE_QUEUE,   // Queued -> applied by the render task
+    LATENCY_STAGE_RENDER,  // Applied -> frame rendered and written to the driver
+    LATENCY_STAGE_SEND,    // Frame rendered -> dmx_send issued
+    LATENCY_STAGE_TOTAL,   // recvfrom returned -> dmx_send issued
+    LATENCY_STAGE_COUNT
+} latency_stage_t;
+
+// Timestamps of one command on its way to the wire, in microseconds
+typedef struct {
+    int64_t received_us;
+    int64_t queued_us;
+    int64_t applied_us;
+    int64_t rendered_us;
+    int64_t sent_us;
+} latency_trace_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t p50_us;   // Percentiles are bucket upper bounds, capped at max_us
+    uint32_t p95_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} latency_summary_t;
+
+// Adds every stage of a completed trace. Single writer (render task);
+// summaries may be taken from any task and can be off by the samples
+// recorded meanwhile.
+void latency_trace_record(const latency_trace_t *trace);
+void latency_trace_add(latency_stage_t stage, uint32_t us);
+
+latency_summary_t latency_trace_summary(latency_stage_t stage);
+const char *latency_stage_name(latency_stage_t stage);
+
+// Safe from any task: the writer clears the histograms before its next
+// sample, summaries are empty until then
+void latency_trace_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
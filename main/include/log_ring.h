@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Deferred logging for the packet and render hot paths: a record stores
+// the format string pointer and its raw arguments in O(1), the flush task
+// formats and prints it later
+#define LOG_RING_SIZE 128      // Records, must be a power of two
+#define LOG_RING_MAX_ARGS 6
+#define LOG_RING_FLUSH_MS 50   // Flush task period
+#define LOG_RING_LINE_MAX 160  // Formatted line, longer lines are cut
+
+// Modules with per-module verbosity; names match their ESP_LOG tags
+typedef enum {
+    LOG_MODULE_UDP_SERVER,
+    LOG_MODULE_UDP_PROTOCOL,
+    LOG_MODULE_DMX_MANAGER,
+    LOG_MODULE_COUNT
+} log_module_t;
+
+// Statistics
+typedef struct {
+    uint32_t written;   // Records queued
+    uint32_t flushed;   // Records printed by the flush task
+    uint32_t dropped;   // Records lost because the ring was full
+} log_ring_stats_t;
+
+// Current level per module, read inline by LOG_RING to skip filtered records
+extern uint8_t log_ring_levels[LOG_MODULE_COUNT];
+
+// Sets every module to DEBUG or INFO (system_config_t.system.enable_debug_logging)
+// and starts the flush task
+esp_err_t log_ring_init(bool debug);
+
+// Runtime verbosity; also applied to the module's ESP_LOG tag
+void log_ring_set_level(log_module_t module, esp_log_level_t level);
+void log_ring_set_debug(bool debug); // All modules
+esp_log_level_t log_ring_get_level(log_module_t module);
+const char *log_ring_module_name(log_module_t module);
+bool log_ring_find_module(const char *name, log_module_t *module);
+
+// Queue a record; safe from any task, never blocks or formats. fmt must be
+// a string literal and the arguments integers or pointers to strings with
+// static storage (cast to uintptr_t), as they are read after the call.
+// Integer arguments are kept as 32 bits whatever the length modifier, and
+// are printed with the int or unsigned type of their conversion; %s and %p
+// take the slot as a pointer. Field widths given with '*' are not supported.
+void log_ring_write(log_module_t module, esp_log_level_t level, const char *fmt, const uintptr_t *args);
+
+log_ring_stats_t log_ring_get_stats(void);
+
+// Argument slots of a record. The leading pad keeps the initializer
+// non-empty for records without arguments; log_ring_write gets the slots
+// after it.
+#define LOG_RING_ARGS(...) ((const uintptr_t[LOG_RING_MAX_ARGS + 1]){0, __VA_ARGS__} + 1)
+
+#define LOG_RING(module, level, fmt, ...)                                              \
+    do {                                                                               \
+        if ((level) <= log_ring_levels[(module)]) {                                    \
+            log_ring_write((module), (level), (fmt), LOG_RING_ARGS(__VA_ARGS__));      \
+        }                                                                              \
+    } while (0)
+
+#define LOG_RING_E(module, fmt, ...) LOG_RING(module, ESP_LOG_ERROR, fmt, ##__VA_ARGS__)
+#define LOG_RING_W(module, fmt, ...) LOG_RING(module, ESP_LOG_WARN, fmt, ##__VA_ARGS__)
+#define LOG_RING_I(module, fmt, ...) LOG_RING(module, ESP_LOG_INFO, fmt, ##__VA_ARGS__)
+#define LOG_RING_D(module, fmt, ...) LOG_RING(module, ESP_LOG_DEBUG, fmt, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-source flood protection: one token bucket per sender address
+#define RATE_LIMIT_MAX_SOURCES 8
+#define RATE_LIMIT_IDLE_MS 10000    // A source slot can be reused after this
+#define RATE_LIMIT_DEFAULT_PPS 200  // Sustained packets per second per source
+#define RATE_LIMIT_DEFAULT_BURST 100
+
+// Traffic classes. Frames are shed first: they only pass while the
+// bucket is more than half full, commands pass down to the last token.
+typedef enum {
+    RATE_LIMIT_FRAME,    // Raw, Art-Net, sACN, span and stream universe data
+    RATE_LIMIT_COMMAND   // Channel commands and subscriptions
+} rate_limit_class_t;
+
+typedef enum {
+    RATE_LIMIT_PASS = 0,
+    RATE_LIMIT_HOLD,     // Command over the limit: hold it, latest per channel wins
+    RATE_LIMIT_DROP      // Frame over the limit: shed
+} rate_limit_verdict_t;
+
+// Per-source counters
+typedef struct {
+    uint32_t addr;               // IPv4 address, network byte order; 0 = overflow slot
+    uint32_t packets;
+    uint32_t frames_dropped;
+    uint32_t commands_held;
+    uint32_t last_seen_ms;
+} rate_limit_source_t;
+
+// Statistics
+typedef struct {
+    uint32_t packets_checked;
+    uint32_t frames_dropped;
+    uint32_t commands_held;
+    uint32_t sources_evicted;    // Idle slots handed to a new source
+    uint32_t sources_overflowed; // Packets from sources that found no free slot
+} rate_limit_stats_t;
+
+// packets_per_second 0 disables limiting; every packet passes
+void rate_limit_init(int packets_per_second, int burst);
+
+// Charge one packet to the source (server task only)
+rate_limit_verdict_t rate_limit_check(uint32_t addr, rate_limit_class_t cls, uint32_t now_ms);
+
+// Publishes the statistics and the source table for other tasks, applying
+// a pending reset (server task only)
+void rate_limit_publish_stats(void);
+
+// Copies up to max sources of the last publish, returns the number copied
+int rate_limit_get_sources(rate_limit_source_t *out, int max);
+
+rate_limit_stats_t rate_limit_get_stats(void);
+void rate_limit_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
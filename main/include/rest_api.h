@@ -0,0 +1,15 @@
+#pragma once
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Registers the gateway runtime endpoints on the configuration HTTP server
+esp_err_t rest_api_register(httpd_handle_t server);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// E1.31 (sACN) protocol constants
+#define SACN_PORT 5568
+#define SACN_DMP_DATA_OFFSET 126      // First slot after the START code
+#define SACN_MAX_PACKET_SIZE 638
+#define SACN_MAX_UNIVERSE 63999
+#define SACN_MAX_PRIORITY 200
+#define SACN_DEFAULT_PRIORITY 100
+#define SACN_MAX_SOURCES 4            // Tracked sources per universe
+#define SACN_SOURCE_TIMEOUT_MS 2500   // E1.31 network data loss timeout
+
+// Parser / source tracking results
+typedef enum {
+    SACN_OK = 0,
+    SACN_ERR_HEADER,       // Too short, wrong preamble or ACN identifier
+    SACN_ERR_VECTOR,       // Not an E1.31 data packet
+    SACN_ERR_LENGTH,       // PDU lengths do not match the datagram
+    SACN_IGNORED,          // Preview data or non-zero START code
+    SACN_NOT_OURS,         // Universe not mapped to a local universe
+    SACN_OUT_OF_ORDER,     // Sequence number older than the last one
+    SACN_LOW_PRIORITY,     // A higher priority source owns the universe
+    SACN_SOURCES_FULL,     // No free source slot
+    SACN_TERMINATED        // Source sent Stream_Terminated
+} sacn_result_t;
+
+// Parsed E1.31 data packet; pointers refer to the receive buffer
+typedef struct {
+    const uint8_t *cid;      // 16 byte component identifier
+    uint8_t priority;
+    uint8_t sequence;
+    uint8_t options;
+    uint16_t universe;
+    uint16_t length;         // Slots in data (0-512)
+    const uint8_t *data;     // Slot 1 onwards
+} sacn_packet_t;
+
+// Statistics
+typedef struct {
+    uint32_t packets_received;   // Data packets parsed
+    uint32_t packets_accepted;   // Forwarded to a local universe
+    uint32_t packets_filtered;   // Other universes, preview data, other START codes
+    uint32_t packets_invalid;
+    uint32_t out_of_order;
+    uint32_t low_priority;       // Dropped in favour of a higher priority source
+    uint32_t sources_full;
+    uint32_t sources_terminated;
+    uint32_t sources_timed_out;
+    uint32_t active_sources;     // Sources currently tracked
+} sacn_stats_t;
+
+// Receiver setup: local universe n listens on sACN universe base + n.
+// universe_count 0 disables sACN.
+void sacn_init(uint16_t base_universe, int universe_count);
+int sacn_get_universe_count(void);
+uint16_t sacn_get_universe(int local_universe);
+uint32_t sacn_multicast_address(uint16_t universe); // 239.255.hi.lo, host byte order
+
+// Parse an E1.31 data packet without copying
+sacn_result_t sacn_parse(const uint8_t *buf, size_t len, sacn_packet_t *out);
+
+// Track the sending source and decide whether its data drives the local
+// universe (highest priority wins, the current source keeps ties)
+sacn_result_t sacn_accept(const sacn_packet_t *packet, uint32_t now_ms, int *local_universe);
+
+// Counted and published by the UDP server task, read from any task
+void sacn_publish_stats(void);
+sacn_stats_t sacn_get_stats(void);
+void sacn_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
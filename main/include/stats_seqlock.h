@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Consistent statistics snapshots without locking the counting task: the
+// owning task counts into a private copy with plain increments and
+// publishes it now and then; readers on any task or core copy the
+// published version and retry if a publish overlapped.
+typedef struct {
+    _Atomic uint32_t seq;   // Odd while a publish is in progress
+    portMUX_TYPE mux;       // Writer only, keeps a publish from being preempted
+} stats_seqlock_t;
+
+#define STATS_SEQLOCK_INIT {.seq = 0, .mux = portMUX_INITIALIZER_UNLOCKED}
+
+// Writer side - one task per lock
+static inline void stats_seqlock_publish(stats_seqlock_t *lock, void *shared, const void *local, size_t size)
+{
+    portENTER_CRITICAL(&lock->mux);
+    uint32_t seq = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    atomic_store_explicit(&lock->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(shared, local, size);
+    atomic_store_explicit(&lock->seq, seq + 2, memory_order_release);
+    portEXIT_CRITICAL(&lock->mux);
+}
+
+// Reader side - any task; a publish is a short memcpy, so the retry
+// loop only spins while the writer runs on the other core
+static inline void stats_seqlock_read(stats_seqlock_t *lock, void *out, const void *shared, size_t size)
+{
+    uint32_t before;
+    uint32_t after;
+    do
+    {
+        before = atomic_load_explicit(&lock->seq, memory_order_acquire);
+        memcpy(out, shared, size);
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&lock->seq, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+#ifdef __cplusplus
+}
+#endif
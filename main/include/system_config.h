@@ -9,6 +9,11 @@
 extern "C" {
 #endif
 
+// Layout version of system_config_t in NVS. Bump it whenever a field is
+// added, removed or reordered: a blob stored by other firmware is then
+// ignored and the defaults apply.
+#define SYSTEM_CONFIG_VERSION 2
+
 // System configuration
 typedef struct {
     // Hardware pins
@@ -16,6 +21,10 @@ typedef struct {
         int dmx_tx_pin;
         int dmx_rx_pin;
         int dmx_en_pin;
+        int dmx_universe_count; // Physical universes (1 or 2)
+        int dmx2_tx_pin;        // Second universe, used when dmx_universe_count is 2
+        int dmx2_rx_pin;
+        int dmx2_en_pin;
         int debug_led_gpio;
     } hardware;
     
@@ -23,12 +32,29 @@ typedef struct {
     struct {
         uint16_t udp_port;
         uint16_t max_udp_buffer_size;
+        uint16_t source_rate_pps; // Packets per second per sender, 0 = unlimited
+        uint16_t source_burst;    // Packets a sender may send in one burst
     } network;
     
+    // Art-Net input: Port-Address of the first universe, the second
+    // universe listens on the next one
+    struct {
+        int net;      // 0-127
+        int subnet;   // 0-15
+        int universe; // 0-15
+    } artnet;
+    
+    // sACN (E1.31) input: first universe, the second one listens on the
+    // next universe number
+    struct {
+        bool enabled;
+        int universe; // 1-63999
+    } sacn;
+    
     // DMX configuration
     struct {
-        int universe_size;
-        int fade_interval_ms;
+        int universe_size;     // Maximum slots sent per frame (start code included)
+        int fade_interval_ms;  // Render/output frame interval, bounded by the wire time
     } dmx;
     
     // System settings
@@ -45,6 +71,10 @@ esp_err_t system_config_load_from_nvs(void);
 esp_err_t system_config_save_to_nvs(void);
 esp_err_t system_config_load_defaults(void);
 
+// Runtime updates (validated and persisted to NVS)
+esp_err_t system_config_set_dmx_output(int universe_size, int fade_interval_ms);
+esp_err_t system_config_set_debug_logging(bool enabled);
+
 // Configuration validation
 bool system_config_validate(const system_config_t* config);
 void system_config_print(const system_config_t* config);
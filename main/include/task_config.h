@@ -0,0 +1,40 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Task topology. Wi-Fi, lwIP and esp_timer run on PRO_CPU (see
+// sdkconfig.default); network receive and parse stay next to them, so
+// the DMX render task and the UART interrupts of its ports have APP_CPU
+// to themselves. The frame clock is dispatched from the esp_timer
+// interrupt on PRO_CPU rather than the esp_timer task, which runs below
+// Wi-Fi; the interrupt preempts the Wi-Fi task and wakes the render task
+// on APP_CPU directly.
+#define TASK_CORE_NETWORK PRO_CPU_NUM
+#if CONFIG_FREERTOS_UNICORE
+#define TASK_CORE_RENDER PRO_CPU_NUM
+#else
+#define TASK_CORE_RENDER APP_CPU_NUM
+#endif
+
+// Priorities and stacks of every gateway task. For reference: Wi-Fi 23,
+// esp_timer 22, lwIP 18 (all PRO_CPU); the Wi-Fi helper tasks of
+// my_wifi run at 2 on PRO_CPU.
+#define DMX_RENDER_TASK_PRIORITY 10 // Alone on APP_CPU, woken by the frame clock interrupt
+#define DMX_RENDER_TASK_STACK 4096
+
+#define UDP_SERVER_TASK_PRIORITY 5
+#define UDP_SERVER_TASK_STACK 8192
+
+#define FEEDBACK_TASK_PRIORITY 3
+#define FEEDBACK_TASK_STACK 4096
+
+#define LOG_FLUSH_TASK_PRIORITY 1
+#define LOG_FLUSH_TASK_STACK 4096
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "dmx_manager.h"
 
 #ifdef __cplusplus
@@ -11,6 +12,28 @@ extern "C" {
 // UDP Protocol Configuration
 #define UDP_PORT 6454
 #define MAX_UDP_BUFFER_SIZE 1024
+#define UDP_MAX_BATCH_COMMANDS 32 // Commands per datagram, must fit the command queue
+
+// Binary framing: magic, version, then records of
+// opcode, universe, start channel (u16), count (u16), fade ms (u16), payload.
+// Multi-byte fields are big endian; the magic byte never starts an ASCII
+// command or an Art-Net packet.
+#define UDP_BINARY_MAGIC 0xDB
+#define UDP_BINARY_VERSION 1
+#define UDP_BINARY_HEADER_SIZE 2
+#define UDP_BINARY_RECORD_SIZE 8  // Record header, payload follows
+
+// Raw span packets: magic, universe, start channel (u16), fade ms (u16),
+// then levels up to the end of the datagram. Only the span is written.
+#define UDP_SPAN_MAGIC 0xDC
+#define UDP_SPAN_HEADER_SIZE 6
+
+// Binary opcodes
+typedef enum {
+    UDP_BIN_OP_SET = 0x01,          // count levels from start channel, payload: count bytes
+    UDP_BIN_OP_FILL = 0x02,         // count channels to one level, payload: 1 byte
+    UDP_BIN_OP_LIGHT_CT = 0x03      // CT fixture at start (count 2), payload: brightness %, Kelvin (u16)
+} udp_binary_opcode_t;
 
 // Protocol command types
 typedef enum {
@@ -18,24 +41,99 @@ typedef enum {
     UDP_CMD_PERCENTAGE = 'P',       // Percentage control
     UDP_CMD_RGB = 'R',              // RGB control
     UDP_CMD_TUNABLE_WHITE = 'W',    // Tunable white control
-    UDP_CMD_LIGHT_CT = 'L'          // Light with color temperature
+    UDP_CMD_LIGHT_CT = 'L',         // Light with color temperature
+    UDP_CMD_SET_RANGE = 'S',        // Channel range from a payload (binary only)
+    UDP_CMD_FILL = 'F'              // Channel range to one level (binary only)
 } udp_command_type_t;
 
-// Parsed command structure
+// Parser results
+typedef enum {
+    UDP_PARSE_OK = 0,
+    UDP_PARSE_ERR_EMPTY,      // No data
+    UDP_PARSE_ERR_PREFIX,     // Does not start with "DMX"
+    UDP_PARSE_ERR_TYPE,       // Unknown command letter
+    UDP_PARSE_ERR_UNIVERSE,   // Universe prefix is 0
+    UDP_PARSE_ERR_CHANNEL,    // Channel missing or not a number
+    UDP_PARSE_ERR_VALUE,      // Value missing or not a number
+    UDP_PARSE_ERR_SPEED,      // Speed not a number
+    UDP_PARSE_ERR_OVERFLOW,   // Number does not fit in an int
+    UDP_PARSE_ERR_TRAILING,   // Unexpected data after the last field
+    UDP_PARSE_ERR_TOO_MANY,   // More than UDP_MAX_BATCH_COMMANDS in one datagram
+    UDP_PARSE_ERR_VERSION,    // Unsupported binary protocol version
+    UDP_PARSE_ERR_LENGTH,     // Binary record count or payload does not fit the datagram
+    UDP_PARSE_ERR_COUNT
+} udp_parse_error_t;
+
+// Parsed command structure. Both parsers decode values and fade times up
+// front, so executing a command needs no further arithmetic.
 typedef struct {
     udp_command_type_t type;
-    int channel;
-    int value;
-    int speed;
+    int universe;           // 0-based; "DMXC2:10#..." addresses universe 2 (index 1)
+    int channel;            // First channel
+    int count;              // Channels written by S and F
+    int value;              // Value as sent (ASCII only, for logging)
+    uint8_t levels[3];      // C/P/F: [0], R: r g b, W: ww cw
+    uint8_t brightness;     // L: 0-100%
+    uint16_t color_temp;    // L: Kelvin
+    int fade_ms;
+    const uint8_t *payload; // S: count levels; points into the datagram until queued
     bool valid;
 } udp_parsed_command_t;
 
+// Parsed raw span; data points into the datagram
+typedef struct {
+    int universe;           // 0-based
+    int start;              // First channel
+    int length;             // Levels in data
+    int fade_ms;
+    const uint8_t *data;
+} udp_span_t;
+
+// State feedback subscription: SUB[<universe>:]<channel>#<count>[#<interval_ms>]
+// or UNSUB, which drops every subscription of the sender. Notifications
+// go back to the address and port the request came from.
+typedef struct {
+    bool subscribe;
+    int universe;           // 0-based
+    int channel;            // First channel
+    int count;
+    int interval_ms;        // Minimum time between notifications, 0 = default
+} udp_subscription_t;
+
+// Result of parsing a multi-command datagram
+typedef struct {
+    int count;                     // Valid commands stored in the output array
+    int rejected;                  // Commands that failed to parse
+    udp_parse_error_t first_error; // Reason for the first rejected command
+    uint16_t errors[UDP_PARSE_ERR_COUNT]; // Rejected commands by reason
+} udp_batch_result_t;
+
 // Protocol functions
 esp_err_t udp_protocol_init(void);
 void udp_protocol_deinit(void);
 
 // Command parsing and execution
-udp_parsed_command_t udp_parse_command(const char* cmd);
+// Single pass over buf[0..len), no allocation and no NUL terminator needed
+udp_parse_error_t udp_parse_command(const char* buf, size_t len, udp_parsed_command_t* out);
+const char* udp_parse_error_name(udp_parse_error_t err);
+
+// Split a datagram on newlines or semicolons and parse every command;
+// empty segments are skipped
+udp_batch_result_t udp_parse_batch(const char* buf, size_t len, udp_parsed_command_t* out, int max_commands);
+
+// Binary datagrams are identified by their first byte; records are parsed
+// without copying and a datagram with any malformed record is rejected as
+// a whole.
+bool udp_is_binary_packet(const uint8_t* buf, size_t len);
+udp_batch_result_t udp_parse_binary(const uint8_t* buf, size_t len, udp_parsed_command_t* out, int max_commands);
+// Raw span packets, identified by their first byte like binary datagrams
+bool udp_is_span_packet(const uint8_t* buf, size_t len);
+udp_parse_error_t udp_parse_span(const uint8_t* buf, size_t len, udp_span_t* out);
+
+// Subscription requests ("SUB" / "UNSUB" prefix)
+bool udp_is_subscription(const char* buf, size_t len);
+udp_parse_error_t udp_parse_subscription(const char* buf, size_t len, udp_subscription_t* out);
+
 dmx_command_result_t udp_execute_command(const udp_parsed_command_t* cmd);
 dmx_command_result_t udp_handle_raw_command(const char* cmd);
 
@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "udp_protocol.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,9 +12,12 @@ extern "C" {
 // Network configuration
 #define UDP_DEFAULT_PORT 6454
 #define UDP_BUFFER_SIZE 1024
+#define UDP_RX_BATCH 16     // Datagrams read per socket and wakeup
 
 // UDP Server functions
-esp_err_t udp_server_init(uint16_t port);
+// receive_buffer_size is the largest expected datagram; the socket
+// buffers UDP_RX_BATCH of them (needs CONFIG_LWIP_SO_RCVBUF)
+esp_err_t udp_server_init(uint16_t port, int receive_buffer_size);
 void udp_server_deinit(void);
 bool udp_server_is_running(void);
 
@@ -22,17 +26,51 @@ esp_err_t udp_server_start(void);
 esp_err_t udp_server_stop(void);
 esp_err_t udp_server_restart(void);
 
-// Statistics
+// Commands applied by the render task, by protocol letter; raw covers
+// universe frames and spans (raw, Art-Net, sACN, stream)
+typedef enum {
+    UDP_STATS_CMD_CHANNEL,        // C
+    UDP_STATS_CMD_PERCENTAGE,     // P
+    UDP_STATS_CMD_RGB,            // R
+    UDP_STATS_CMD_TUNABLE_WHITE,  // W
+    UDP_STATS_CMD_LIGHT_CT,       // L
+    UDP_STATS_CMD_SET_RANGE,      // S (binary)
+    UDP_STATS_CMD_FILL,           // F (binary)
+    UDP_STATS_CMD_RAW,
+    UDP_STATS_CMD_COUNT
+} udp_stats_cmd_t;
+
+// Statistics. The server task and the render task each count into their
+// own copy and publish it once per wakeup or frame; udp_server_get_stats
+// returns a consistent snapshot of both.
 typedef struct {
     uint32_t packets_received;
     uint32_t packets_processed;
     uint32_t packets_invalid;
+    uint32_t bytes_received;    // Datagram bytes on the main and sACN ports
+    uint32_t commands_received; // Commands found in DMX datagrams (valid or not)
+    uint32_t commands_invalid;  // Commands rejected by the parser
     uint32_t commands_executed;
-    uint32_t command_errors;
+    uint32_t command_errors;    // Parse and execution failures
+    uint32_t queue_depth;       // Entries waiting for the render task
+    uint32_t queue_high_water;  // Highest depth seen at enqueue
+    uint32_t queue_overflows;   // Packets dropped because the queue was full
+    uint32_t packets_shed;      // Frames and subscriptions dropped by the rate limiter
+    uint32_t commands_held;     // Commands of sources over their rate, applied late
+    uint32_t commands_superseded; // Held commands replaced by a newer one
+    uint32_t commands_shed;     // Held range commands and held-set overflows
+    uint32_t rx_datagrams;      // Datagrams read on the main and sACN ports
+    uint32_t rx_wakeups;        // select() wakeups that found datagrams
+    uint32_t rx_batch_max;      // Most datagrams read in one wakeup
+    uint32_t rx_batch_limited;  // Wakeups that stopped at UDP_RX_BATCH on a socket
+    uint32_t rx_errors;         // recvfrom failures other than an empty socket
+    uint32_t commands_by_type[UDP_STATS_CMD_COUNT]; // Applied, including failed ones
+    uint32_t parse_errors[UDP_PARSE_ERR_COUNT];     // Rejected commands, spans and subscriptions
 } udp_server_stats_t;
 
 udp_server_stats_t udp_server_get_stats(void);
-void udp_server_reset_stats(void);
+void udp_server_reset_stats(void); // Applied by each task at its next publish
+const char *udp_stats_cmd_name(udp_stats_cmd_t type);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,194 @@
+#include "artnet.h"
+#include "dmx_manager.h"
+#include "stats_seqlock.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+static const uint8_t ARTNET_ID[8] = {'A', 'r', 't', '-', 'N', 'e', 't', '\0'};
+
+// Receiver state (UDP server task only)
+static uint16_t base_port_address = 0;
+static int universe_count = 1;
+static uint8_t last_sequence[DMX_MAX_UNIVERSES] = {0};
+static uint8_t sequence_drops[DMX_MAX_UNIVERSES] = {0};
+static bool output_active[DMX_MAX_UNIVERSES] = {false};
+static uint32_t poll_reply_count = 0;
+
+// Statistics: counted by the UDP server task, published for other tasks
+static artnet_stats_t artnet_stats = {0};
+static artnet_stats_t artnet_stats_shared = {0};
+static stats_seqlock_t artnet_stats_lock = STATS_SEQLOCK_INIT;
+static _Atomic bool stats_reset_requested = false;
+
+void artnet_init(uint16_t base, int count)
+{
+    base_port_address = base & ARTNET_MAX_PORT_ADDRESS;
+    universe_count = (count < 1) ? 1 : (count > DMX_MAX_UNIVERSES ? DMX_MAX_UNIVERSES : count);
+    memset(last_sequence, 0, sizeof(last_sequence));
+    memset(sequence_drops, 0, sizeof(sequence_drops));
+    memset(output_active, 0, sizeof(output_active));
+    poll_reply_count = 0;
+}
+
+uint16_t artnet_port_address(int net, int subnet, int universe)
+{
+    return (uint16_t)(((net & 0x7F) << 8) | ((subnet & 0x0F) << 4) | (universe & 0x0F));
+}
+
+bool artnet_is_packet(const uint8_t *buf, size_t len)
+{
+    return buf && len >= ARTNET_HEADER_SIZE && memcmp(buf, ARTNET_ID, sizeof(ARTNET_ID)) == 0;
+}
+
+// Caller checked artnet_is_packet()
+uint16_t artnet_get_opcode(const uint8_t *buf)
+{
+    return (uint16_t)(buf[8] | (buf[9] << 8));
+}
+
+// ArtDmx: ID[8] OpCode[2] ProtVer[2] Sequence Physical SubUni Net Length[2] Data[Length]
+artnet_result_t artnet_parse_dmx(const uint8_t *buf, size_t len, artnet_dmx_t *out)
+{
+    if (!artnet_is_packet(buf, len) || len < ARTNET_DMX_HEADER_SIZE ||
+        artnet_get_opcode(buf) != ARTNET_OP_DMX || !out)
+    {
+        artnet_stats.packets_invalid++;
+        return ARTNET_ERR_HEADER;
+    }
+
+    if (((buf[10] << 8) | buf[11]) < ARTNET_PROTOCOL_VERSION)
+    {
+        artnet_stats.packets_invalid++;
+        return ARTNET_ERR_VERSION;
+    }
+
+    // Length is big endian and should be even; odd lengths are accepted
+    uint16_t length = (uint16_t)((buf[16] << 8) | buf[17]);
+    if (length == 0 || length > DMX_UNIVERSE_SIZE || len - ARTNET_DMX_HEADER_SIZE < length)
+    {
+        artnet_stats.packets_invalid++;
+        return ARTNET_ERR_LENGTH;
+    }
+
+    out->sequence = buf[12];
+    out->physical = buf[13];
+    out->port_address = (uint16_t)(((buf[15] & 0x7F) << 8) | buf[14]);
+    out->length = length;
+    out->data = buf + ARTNET_DMX_HEADER_SIZE;
+
+    artnet_stats.dmx_received++;
+    return ARTNET_OK;
+}
+
+// ArtPoll: ID[8] OpCode[2] ProtVer[2] Flags DiagPriority ...
+artnet_result_t artnet_parse_poll(const uint8_t *buf, size_t len)
+{
+    if (!artnet_is_packet(buf, len) || len < ARTNET_POLL_MIN_SIZE ||
+        artnet_get_opcode(buf) != ARTNET_OP_POLL)
+    {
+        artnet_stats.packets_invalid++;
+        return ARTNET_ERR_HEADER;
+    }
+
+    artnet_stats.polls_received++;
+    return ARTNET_OK;
+}
+
+artnet_result_t artnet_accept_dmx(const artnet_dmx_t *dmx, int *universe)
+{
+    int index = (int)dmx->port_address - (int)base_port_address;
+    if (index < 0 || index >= universe_count)
+    {
+        artnet_stats.dmx_filtered++;
+        return ARTNET_NOT_OURS;
+    }
+
+    // Sequence 0 disables the check. Frames that are not newer than the
+    // last one are dropped; after a run of them the sender is assumed to
+    // have restarted and the sequence is taken over.
+    if (dmx->sequence != 0 && last_sequence[index] != 0)
+    {
+        int8_t diff = (int8_t)(dmx->sequence - last_sequence[index]);
+        if (diff <= 0 && sequence_drops[index] < ARTNET_SEQUENCE_RESYNC)
+        {
+            sequence_drops[index]++;
+            artnet_stats.dmx_out_of_order++;
+            return ARTNET_OUT_OF_ORDER;
+        }
+    }
+
+    last_sequence[index] = dmx->sequence;
+    sequence_drops[index] = 0;
+    output_active[index] = true;
+    artnet_stats.dmx_accepted++;
+
+    if (universe)
+    {
+        *universe = index;
+    }
+    return ARTNET_OK;
+}
+
+static void put_name(uint8_t *dst, size_t size, const char *name)
+{
+    if (name)
+    {
+        strncpy((char *)dst, name, size - 1);
+    }
+}
+
+size_t artnet_build_poll_reply(uint8_t *buf, const artnet_node_info_t *info, int universe)
+{
+    uint16_t port_address = (uint16_t)((base_port_address + universe) & ARTNET_MAX_PORT_ADDRESS);
+
+    memset(buf, 0, ARTNET_POLL_REPLY_SIZE);
+    memcpy(buf, ARTNET_ID, sizeof(ARTNET_ID));
+    buf[8] = ARTNET_OP_POLL_REPLY & 0xFF;
+    buf[9] = ARTNET_OP_POLL_REPLY >> 8;
+    memcpy(&buf[10], info->ip, 4);
+    buf[14] = ARTNET_PORT & 0xFF; // Port, little endian
+    buf[15] = ARTNET_PORT >> 8;
+    buf[18] = (uint8_t)(port_address >> 8);         // NetSwitch
+    buf[19] = (uint8_t)((port_address >> 4) & 0x0F); // SubSwitch
+    buf[21] = 0xFF;                                 // OEM unknown
+    buf[23] = 0xD0;                                 // Indicators normal, addresses set locally
+    put_name(&buf[26], 18, info->short_name);
+    put_name(&buf[44], 64, info->long_name);
+    snprintf((char *)&buf[108], 64, "#0001 [%04lu] Ready", (unsigned long)(++poll_reply_count % 10000));
+    buf[173] = 1;                                   // NumPorts
+    buf[174] = 0x80;                                // Port outputs DMX512 from Art-Net
+    buf[182] = output_active[universe] ? 0x80 : 0x00; // GoodOutput: data being transmitted
+    buf[190] = (uint8_t)(port_address & 0x0F);      // SwOut
+    buf[200] = 0x00;                                // StNode
+    memcpy(&buf[201], info->mac, 6);
+    memcpy(&buf[207], info->ip, 4);                 // BindIp
+    buf[211] = (uint8_t)(universe + 1);             // BindIndex
+    buf[212] = 0x08;                                // 15 bit Port-Address supported
+
+    return ARTNET_POLL_REPLY_SIZE;
+}
+
+// Server task only
+void artnet_publish_stats(void)
+{
+    if (atomic_exchange(&stats_reset_requested, false))
+    {
+        memset(&artnet_stats, 0, sizeof(artnet_stats));
+    }
+    stats_seqlock_publish(&artnet_stats_lock, &artnet_stats_shared, &artnet_stats, sizeof(artnet_stats));
+}
+
+artnet_stats_t artnet_get_stats(void)
+{
+    artnet_stats_t stats;
+    stats_seqlock_read(&artnet_stats_lock, &stats, &artnet_stats_shared, sizeof(stats));
+    return stats;
+}
+
+// Applied by the server task at its next publish
+void artnet_reset_stats(void)
+{
+    atomic_store(&stats_reset_requested, true);
+}
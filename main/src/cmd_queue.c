@@ -0,0 +1,208 @@
+#include "cmd_queue.h"
+#include "dmx_manager.h"
+
+#include <string.h>
+#include <stdatomic.h>
+#include "esp_timer.h"
+
+// Ring storage. Indexes run freely and are masked on access; head is only
+// written by the producer, tail only by the consumer. Payloads live in a
+// byte ring that is consumed in entry order: each entry records where its
+// payload ends, and the consumer frees up to there once it is handled.
+static cmd_queue_entry_t entries[CMD_QUEUE_LENGTH];
+static _Atomic uint32_t entry_head = 0;
+static _Atomic uint32_t entry_tail = 0;
+
+static uint8_t payloads[CMD_QUEUE_PAYLOAD_SIZE];
+static uint32_t payload_head = 0; // Producer only, published with entry_head
+static _Atomic uint32_t payload_tail = 0;
+
+// Producer's own head. It runs ahead of entry_head while a batch is open;
+// the staged entries are published when the batch ends.
+static uint32_t staged_head = 0;
+static bool batch_open = false;
+
+// Only call while neither side is running
+void cmd_queue_reset(void)
+{
+    atomic_store(&entry_head, 0);
+    atomic_store(&entry_tail, 0);
+    staged_head = 0;
+    batch_open = false;
+    payload_head = 0;
+    atomic_store(&payload_tail, 0);
+}
+
+// Reserve len contiguous payload bytes at *head. A payload that would wrap
+// starts at the beginning of the ring instead; the skipped tail is freed
+// together with it.
+static bool payload_reserve(uint32_t *head, size_t len, uint32_t *start)
+{
+    uint32_t pos = *head;
+    uint32_t offset = pos & (CMD_QUEUE_PAYLOAD_SIZE - 1);
+    if (offset + len > CMD_QUEUE_PAYLOAD_SIZE)
+    {
+        pos += CMD_QUEUE_PAYLOAD_SIZE - offset;
+    }
+
+    if (len > CMD_QUEUE_PAYLOAD_SIZE ||
+        pos + (uint32_t)len - atomic_load_explicit(&payload_tail, memory_order_acquire) > CMD_QUEUE_PAYLOAD_SIZE)
+    {
+        return false;
+    }
+
+    *start = pos;
+    *head = pos + (uint32_t)len;
+    return true;
+}
+
+// Copy a payload into the ring and record its position in the entry
+static bool payload_store(uint32_t *head, cmd_queue_entry_t *entry, const uint8_t *data, size_t len)
+{
+    uint32_t start = *head;
+    if (len > 0)
+    {
+        if (!payload_reserve(head, len, &start))
+        {
+            return false;
+        }
+        memcpy(&payloads[start & (CMD_QUEUE_PAYLOAD_SIZE - 1)], data, len);
+    }
+
+    entry->length = (uint16_t)len;
+    entry->payload_offset = (uint16_t)(start & (CMD_QUEUE_PAYLOAD_SIZE - 1));
+    entry->payload_end = *head;
+    return true;
+}
+
+static bool entry_ring_full(uint32_t head)
+{
+    return head - atomic_load_explicit(&entry_tail, memory_order_acquire) >= CMD_QUEUE_LENGTH;
+}
+
+// Make everything staged visible to the next drain, unless a batch is open
+static void entry_publish(uint32_t head)
+{
+    staged_head = head;
+    if (!batch_open)
+    {
+        atomic_store_explicit(&entry_head, head, memory_order_release);
+    }
+}
+
+void cmd_queue_batch_begin(void)
+{
+    batch_open = true;
+}
+
+uint32_t cmd_queue_batch_end(void)
+{
+    batch_open = false;
+    entry_publish(staged_head);
+    return cmd_queue_depth();
+}
+
+bool cmd_queue_push_command(const udp_parsed_command_t *cmd, int64_t received_us)
+{
+    return cmd_queue_push_commands(cmd, 1, received_us);
+}
+
+bool cmd_queue_push_commands(const udp_parsed_command_t *cmds, int count, int64_t received_us)
+{
+    uint32_t head = staged_head;
+    if (!cmds || count < 1 || count > CMD_QUEUE_LENGTH ||
+        entry_ring_full(head + (uint32_t)count - 1))
+    {
+        return false;
+    }
+
+    // Nothing is visible to the consumer until entry_head moves, so a batch
+    // that runs out of payload space is simply not published
+    uint32_t phead = payload_head;
+    int64_t queued_us = esp_timer_get_time();
+    for (int i = 0; i < count; ++i)
+    {
+        cmd_queue_entry_t *entry = &entries[(head + (uint32_t)i) & (CMD_QUEUE_LENGTH - 1)];
+        entry->kind = CMD_QUEUE_COMMAND;
+        entry->cmd = cmds[i];
+        entry->universe = 0;
+        entry->received_us = received_us;
+        entry->queued_us = queued_us;
+
+        size_t len = cmds[i].payload ? (size_t)cmds[i].count : 0;
+        if (!payload_store(&phead, entry, cmds[i].payload, len))
+        {
+            return false;
+        }
+    }
+    payload_head = phead;
+
+    // One release store makes the whole batch visible to the next drain
+    entry_publish(head + (uint32_t)count);
+    return true;
+}
+
+// Queue one entry with a payload
+static bool push_payload_entry(cmd_queue_entry_t *entry, const uint8_t *data, size_t len)
+{
+    uint32_t head = staged_head;
+    if (!data || len == 0 || len > DMX_UNIVERSE_SIZE || entry_ring_full(head) ||
+        !payload_store(&payload_head, entry, data, len))
+    {
+        return false;
+    }
+
+    entry->queued_us = esp_timer_get_time();
+    entries[head & (CMD_QUEUE_LENGTH - 1)] = *entry;
+    entry_publish(head + 1);
+    return true;
+}
+
+bool cmd_queue_push_universe(int universe, const uint8_t *data, size_t len, int64_t received_us)
+{
+    cmd_queue_entry_t entry = {
+        .kind = CMD_QUEUE_UNIVERSE,
+        .universe = (uint8_t)universe,
+        .received_us = received_us};
+    return push_payload_entry(&entry, data, len);
+}
+
+bool cmd_queue_push_span(int universe, int start, const uint8_t *data, size_t len, int fade_ms, int64_t received_us)
+{
+    cmd_queue_entry_t entry = {
+        .kind = CMD_QUEUE_SPAN,
+        .universe = (uint8_t)universe,
+        .start = (uint16_t)start,
+        .fade_ms = (uint16_t)fade_ms,
+        .received_us = received_us};
+    return push_payload_entry(&entry, data, len);
+}
+
+int cmd_queue_drain(cmd_queue_handler_t handler)
+{
+    uint32_t tail = atomic_load_explicit(&entry_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&entry_head, memory_order_acquire);
+    int handled = 0;
+
+    while (tail != head)
+    {
+        const cmd_queue_entry_t *entry = &entries[tail & (CMD_QUEUE_LENGTH - 1)];
+
+        if (handler)
+        {
+            handler(entry, entry->length ? &payloads[entry->payload_offset] : NULL);
+        }
+        atomic_store_explicit(&payload_tail, entry->payload_end, memory_order_release);
+
+        tail++;
+        atomic_store_explicit(&entry_tail, tail, memory_order_release);
+        handled++;
+    }
+
+    return handled;
+}
+
+uint32_t cmd_queue_depth(void)
+{
+    return atomic_load(&entry_head) - atomic_load(&entry_tail);
+}
@@ -1,10 +1,17 @@
 #include "dmx_manager.h"
 #include "my_config.h"
+#include "log_ring.h"
+#include "task_config.h"
+#include "latency_trace.h"
+#include "stats_seqlock.h"
+#include "fade_kernel.h"
 
 #include <string.h>
-#include <math.h>
+#include <stdatomic.h>
 #include "esp_log.h"
 #include "esp_dmx.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -12,11 +19,23 @@
 
 static const char *TAG = "dmx_manager";
 
-// DMX state management
-static bool dmx_initialized = false;
-static dmx_port_t dmx_port = DMX_NUM_1;
-static uint8_t dmx_data[DMX_UNIVERSE_SIZE] = {0};
-static SemaphoreHandle_t dmx_mutex = NULL;
+// The frame clock ticks from the esp_timer interrupt (see task_config.h)
+#if !CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+#error "The frame clock needs CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD"
+#endif
+
+// Dirty-span tracking: one bit per slot. dirty_bits collects writes since
+// the last publish (dmx_lock); spare_stale holds the slots the spare frame
+// missed when it was last swapped out (render task only). Only those spans
+// are copied into the spare frame and pushed into the driver buffer.
+#define DIRTY_WORDS (DMX_UNIVERSE_SIZE / 32)
+#define DIRTY_MERGE_GAP 4 // Clean slots bridged to save a driver call
+
+typedef struct
+{
+    uint16_t start;
+    uint16_t length;
+} dmx_span_t;
 
 // Fade state management
 typedef struct
@@ -25,17 +44,163 @@ typedef struct
     uint8_t start_value;
     uint8_t target_value;
     int duration_ms;
-    TickType_t start_time;
+    uint32_t start_ms;
+    uint16_t slot; // Position in active_fades while active
+    fade_kernel_t kernel;
 } fade_state_t;
 
-static fade_state_t fade_states[DMX_UNIVERSE_SIZE] = {0};
-static TaskHandle_t fade_task_handle = NULL;
+// Per-frame write coalescing: channel writes made from the frame hook are
+// collected per slot and applied once after the hook returns, so a channel
+// written several times in one frame takes the lock and arms a fade once.
+// A fade queued after a write starts from that write's value, as it would
+// if both had been applied in order.
+#define PENDING_VALUE 0x01 // Immediate write, stops a running fade
+#define PENDING_FADE 0x02  // Fade armed after the value is written
+
+typedef struct
+{
+    uint8_t flags;
+    uint8_t value;  // PENDING_VALUE
+    uint8_t target; // PENDING_FADE
+    int duration_ms;
+    uint32_t start_ms;
+} pending_write_t;
+
+// Per-universe state, one universe per DMX port.
+//
+// Universe buffers: writers and the render task stage into data under
+// dmx_lock (a short spinlock section, never a timed wait). The render task
+// copies staged data into the spare frame and publishes it by swapping
+// front, so readers and dmx_write never wait on writers.
+typedef struct
+{
+    dmx_port_t port;
+    uint8_t data[DMX_UNIVERSE_SIZE];
+    uint8_t frames[2][DMX_UNIVERSE_SIZE];
+    _Atomic(uint8_t *) front;
+    bool staged;      // data changed since the last publish
+    int highest_slot; // Highest array index ever written (dmx_lock)
+
+    // Active fade index: dense list of fading array indexes, so the render
+    // task only visits channels that are actually moving (dmx_lock)
+    fade_state_t fades[DMX_UNIVERSE_SIZE];
+    uint16_t active_fades[DMX_UNIVERSE_SIZE];
+    int active_fade_count;
+
+    uint32_t dirty_bits[DIRTY_WORDS];
+    uint32_t spare_stale[DIRTY_WORDS];
+    uint32_t frame_dirty[DIRTY_WORDS];
+    dmx_span_t frame_spans[DMX_UNIVERSE_SIZE / 2];
+    int frame_span_count;
+
+    // Slots changed since the last dmx_manager_take_changes (dmx_lock)
+    uint32_t changed_bits[DIRTY_WORDS];
+    bool changed;
+
+    // Writes coalesced during the frame hook (render task only)
+    pending_write_t pending[DMX_UNIVERSE_SIZE];
+    uint32_t pending_bits[DIRTY_WORDS];
+    bool has_pending;
+} dmx_universe_t;
+
+// UART per universe, UART0 stays with the console
+static const dmx_port_t universe_ports[DMX_MAX_UNIVERSES] = {DMX_NUM_1, DMX_NUM_2};
+
+// DMX state management
+static bool dmx_initialized = false;
+static dmx_universe_t universes[DMX_MAX_UNIVERSES];
+static int universe_count = 0;
+static portMUX_TYPE dmx_lock = portMUX_INITIALIZER_UNLOCKED;
+static dmx_span_t copy_spans[DMX_UNIVERSE_SIZE / 2]; // Render task only
+
+static TaskHandle_t render_task_handle = NULL;
+static dmx_frame_hook_t frame_hook = NULL;
+static dmx_change_hook_t change_hook = NULL;
+static bool batch_open = false; // Frame hook running (render task only)
+
+// Output timing: the render task is clocked by an esp_timer so the frame
+// rate is not bound to the 10 ms FreeRTOS tick. Frames are cut after the
+// highest slot ever written, and the period never undercuts the wire time
+// of the longest frame (ports transmit in parallel).
+static esp_timer_handle_t frame_timer = NULL;
+static uint32_t frame_period_us = 0;
+static _Atomic int max_frame_slots = DMX_UNIVERSE_SIZE;   // system_config dmx.universe_size
+static _Atomic int frame_interval_ms = DMX_FRAME_INTERVAL_MS; // system_config dmx.fade_interval_ms
+
+// Statistics, counted by the render task and published once per frame
+static dmx_manager_stats_t dmx_stats = {0};
+static dmx_manager_stats_t dmx_stats_shared = {0};
+static stats_seqlock_t dmx_stats_lock = STATS_SEQLOCK_INIT;
+static _Atomic bool stats_reset_requested = false;
+static _Atomic uint32_t fades_armed = 0; // Any task; folded into dmx_stats at publish
+static uint64_t latency_total_us = 0;
+
+// Idle path: after DMX_IDLE_HOLD_FRAMES frames without fades, writes or
+// frame requests the render task stops the frame clock and only wakes for
+// a keep-alive resend every DMX_IDLE_REFRESH_MS. Writers set
+// frame_requested and notify the task while it is idle; the task sets
+// render_idle before it looks at frame_requested a last time, so either
+// it sees the request or the writer sees the idle flag.
+static _Atomic bool render_idle = false;
+static _Atomic bool frame_requested = false;
+static int quiet_frames = 0; // Render task only
+
+// Frame timing (render task only, except tick_us from the frame clock interrupt)
+static _Atomic uint32_t tick_us = 0;   // Last frame clock tick, low 32 bits
+static int64_t last_send_us = 0;       // Previous frame's first dmx_send
+static uint32_t last_send_period_us = 0;
+static uint64_t jitter_total_us = 0;
+
+// Driver installation, done by the render task so the UART interrupts
+// are allocated on its core
+typedef struct
+{
+    const dmx_port_pins_t *pins;
+    int count;
+    esp_err_t result;
+    SemaphoreHandle_t done;
+} render_start_t;
+
+// Commands applied during the current render pass (render task only)
+static uint32_t frame_cmd_count = 0;
+static int64_t frame_cmd_sum_us = 0;
+static int64_t frame_cmd_oldest_us = 0;
+static latency_trace_t frame_traces[LATENCY_TRACE_FRAME_MAX];
+static uint8_t frame_trace_universe[LATENCY_TRACE_FRAME_MAX];
+static int frame_trace_count = 0;
 
 // Private function declarations
-static void fade_task(void *arg);
+static esp_err_t install_ports(const dmx_port_pins_t *pins, int count);
+static esp_err_t install_port(dmx_universe_t *u, const dmx_port_pins_t *pins);
+static void account_jitter(int64_t send_us);
+static dmx_universe_t *get_universe(int universe);
+static void render_task(void *arg);
+static bool render_pass(bool ticked);
+static void enter_idle(void);
+static void leave_idle(void);
+static bool render_frame(dmx_universe_t *u, uint32_t now_ms);
+static void write_frame(dmx_universe_t *u);
+static void mark_dirty(dmx_universe_t *u, int array_index, int count);
+static void mark_changed(dmx_universe_t *u, int array_index);
+static int collect_spans(const uint32_t *bits, dmx_span_t *spans);
+static int frame_slots(const dmx_universe_t *u);
+static int longest_frame_slots(void);
+static void update_frame_timer(void);
+static void frame_timer_callback(void *arg);
+static void account_latency(int64_t sent_us);
+static void record_traces(const int64_t *rendered_us, const int64_t *sent_us);
 static bool is_array_index_valid(int index);
-static dmx_command_result_t start_fade(int channel, uint8_t value, int duration_ms);
-static void stop_fade(int channel);
+static void light_ct_mix(const ct_pair_t *pair, uint32_t brightness_percent, int color_temp_k, uint8_t *val_ww, uint8_t *val_cw);
+static dmx_command_result_t start_fade(dmx_universe_t *u, int array_index, uint8_t value, int duration_ms);
+static void arm_fade(dmx_universe_t *u, int array_index, uint8_t value, int duration_ms, uint32_t start_ms);
+static bool is_batching(void);
+static void pend_value(dmx_universe_t *u, int array_index, uint8_t value);
+static void pend_fade(dmx_universe_t *u, int array_index, uint8_t value, int duration_ms, uint32_t start_ms);
+static void cancel_pending_fades(dmx_universe_t *u);
+static void commit_pending(dmx_universe_t *u);
+static void fade_index_add(dmx_universe_t *u, int array_index);
+static void fade_index_remove(dmx_universe_t *u, int array_index);
+static void fade_index_clear(dmx_universe_t *u);
 
 // Bounds checking functions
 bool dmx_is_channel_valid(int channel, int count)
@@ -45,14 +210,36 @@ bool dmx_is_channel_valid(int channel, int count)
     return (channel >= 1 && channel <= DMX_UNIVERSE_SIZE - count);
 }
 
+bool dmx_is_universe_valid(int universe)
+{
+    return (universe >= 0 && universe < universe_count);
+}
+
 static bool is_array_index_valid(int index)
 {
     // Original bug compatibility: index 0 is unused, valid indexes are 1 to DMX_UNIVERSE_SIZE-1
     return (index >= 1 && index < DMX_UNIVERSE_SIZE);
 }
 
-// Initialize DMX manager
-esp_err_t dmx_manager_init(int tx_pin, int rx_pin, int en_pin)
+static dmx_universe_t *get_universe(int universe)
+{
+    if (!dmx_initialized)
+    {
+        ESP_LOGE(TAG, "DMX manager not initialized");
+        return NULL;
+    }
+
+    if (!dmx_is_universe_valid(universe))
+    {
+        LOG_RING_W(LOG_MODULE_DMX_MANAGER, "Invalid universe: %d", universe);
+        return NULL;
+    }
+
+    return &universes[universe];
+}
+
+// Initialize DMX manager, one port per universe
+esp_err_t dmx_manager_init(const dmx_port_pins_t *pins, int count)
 {
     if (dmx_initialized)
     {
@@ -60,24 +247,122 @@ esp_err_t dmx_manager_init(int tx_pin, int rx_pin, int en_pin)
         return ESP_OK;
     }
 
-    // Create mutex for thread-safe operations
-    dmx_mutex = xSemaphoreCreateMutex();
-    if (dmx_mutex == NULL)
+    if (!pins || count < 1 || count > DMX_MAX_UNIVERSES)
+    {
+        ESP_LOGE(TAG, "Invalid universe count: %d", count);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Initialize data exactly like working code
+    memset(universes, 0, sizeof(universes));
+    atomic_store(&render_idle, false);
+    atomic_store(&frame_requested, false);
+    quiet_frames = 0;
+
+    // Create render task (frame clock: commands, fades, write, send) on
+    // its own core; it installs the drivers before it waits for ticks
+    render_start_t start = {
+        .pins = pins,
+        .count = count,
+        .result = ESP_FAIL,
+        .done = xSemaphoreCreateBinary()};
+    if (start.done == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create render start semaphore");
+        return ESP_ERR_NO_MEM;
+    }
+
+    BaseType_t task_result = xTaskCreatePinnedToCore(
+        render_task,
+        "dmx_render",
+        DMX_RENDER_TASK_STACK,
+        &start,
+        DMX_RENDER_TASK_PRIORITY,
+        &render_task_handle,
+        TASK_CORE_RENDER);
+
+    if (task_result != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create render task");
+        vSemaphoreDelete(start.done);
+        render_task_handle = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(start.done, portMAX_DELAY);
+    vSemaphoreDelete(start.done);
+    if (start.result != ESP_OK)
     {
-        ESP_LOGE(TAG, "Failed to create DMX mutex");
+        render_task_handle = NULL; // Deleted itself
+        return start.result;
+    }
+    universe_count = count;
+
+    // Create frame clock
+    const esp_timer_create_args_t timer_args = {
+        .callback = frame_timer_callback,
+        .dispatch_method = ESP_TIMER_ISR,
+        .name = "dmx_frame"};
+
+    if (esp_timer_create(&timer_args, &frame_timer) != ESP_OK)
+    {
+        // Without a clock nothing would wake the render task; undo the
+        // start so a later init can install the drivers again
+        ESP_LOGE(TAG, "Failed to create frame timer");
+        frame_timer = NULL;
+        vTaskDelete(render_task_handle);
+        render_task_handle = NULL;
+        for (int i = 0; i < universe_count; ++i)
+        {
+            dmx_driver_delete(universes[i].port);
+        }
+        universe_count = 0;
         return ESP_ERR_NO_MEM;
     }
+    update_frame_timer();
+
+    dmx_initialized = true;
+    ESP_LOGI(TAG, "DMX manager initialized successfully (%d universes)", count);
+
+    return ESP_OK;
+}
+
+// Install the drivers of all universes, none if one fails
+static esp_err_t install_ports(const dmx_port_pins_t *pins, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        universes[i].port = universe_ports[i];
+        esp_err_t err = install_port(&universes[i], &pins[i]);
+        if (err != ESP_OK)
+        {
+            for (int j = 0; j < i; ++j)
+            {
+                dmx_driver_delete(universes[j].port);
+            }
+            return err;
+        }
+    }
+    return ESP_OK;
+}
 
+// Install the driver for one universe and put its transceiver in TX mode
+static esp_err_t install_port(dmx_universe_t *u, const dmx_port_pins_t *pins)
+{
     // Initialize DMX driver with simple configuration like working code
     dmx_config_t config = DMX_CONFIG_DEFAULT;
 
-    dmx_driver_install(dmx_port, &config, NULL, 0);
-    dmx_set_pin(dmx_port, tx_pin, rx_pin, en_pin);
+    if (!dmx_driver_install(u->port, &config, NULL, 0))
+    {
+        ESP_LOGE(TAG, "Failed to install DMX driver on port %d", u->port);
+        return ESP_FAIL;
+    }
+    dmx_set_pin(u->port, pins->tx_pin, pins->rx_pin, pins->en_pin);
 
     // MAX1348 specific setup
     // Configure Enable pin for MAX1348 transceiver
     gpio_config_t en_pin_config = {
-        .pin_bit_mask = (1ULL << en_pin),
+        .pin_bit_mask = (1ULL << pins->en_pin),
         .mode = GPIO_MODE_OUTPUT,
         .pull_up_en = GPIO_PULLUP_DISABLE,
         .pull_down_en = GPIO_PULLDOWN_DISABLE,
@@ -85,34 +370,16 @@ esp_err_t dmx_manager_init(int tx_pin, int rx_pin, int en_pin)
     gpio_config(&en_pin_config);
 
     // Set MAX1348 to transmit mode (EN pin HIGH for TX mode)
-    gpio_set_level(en_pin, 1);
+    gpio_set_level(pins->en_pin, 1);
 
     // Small delay for MAX1348 to settle
     vTaskDelay(pdMS_TO_TICKS(10));
 
-    // Initialize data exactly like working code
-    memset(dmx_data, 0, sizeof(dmx_data));
-    memset(fade_states, 0, sizeof(fade_states));
-    dmx_write(dmx_port, dmx_data, DMX_UNIVERSE_SIZE);
-
-    // Create fade task
-    BaseType_t task_result = xTaskCreate(
-        fade_task,
-        "dmx_fade",
-        4096,
-        NULL,
-        5,
-        &fade_task_handle);
-
-    if (task_result != pdPASS)
-    {
-        ESP_LOGE(TAG, "Failed to create fade task");
-        // Continue anyway, like working code
-    }
-
-    dmx_initialized = true;
-    ESP_LOGI(TAG, "DMX manager initialized successfully");
+    atomic_store(&u->front, u->frames[0]);
+    dmx_write(u->port, u->frames[0], DMX_UNIVERSE_SIZE);
 
+    ESP_LOGI(TAG, "DMX port %d: TX=%d, RX=%d, EN=%d",
+             u->port, pins->tx_pin, pins->rx_pin, pins->en_pin);
     return ESP_OK;
 }
 
@@ -123,22 +390,29 @@ void dmx_manager_deinit(void)
         return;
     }
 
-    // Stop fade task
-    if (fade_task_handle != NULL)
+    // Stop frame clock and render task
+    if (frame_timer != NULL)
     {
-        vTaskDelete(fade_task_handle);
-        fade_task_handle = NULL;
+        esp_timer_stop(frame_timer);
+        esp_timer_delete(frame_timer);
+        frame_timer = NULL;
+        frame_period_us = 0;
+        last_send_us = 0;
     }
 
-    // Clean up DMX driver
-    dmx_driver_delete(dmx_port);
+    if (render_task_handle != NULL)
+    {
+        vTaskDelete(render_task_handle);
+        render_task_handle = NULL;
+    }
+    atomic_store(&render_idle, false);
 
-    // Clean up mutex
-    if (dmx_mutex != NULL)
+    // Clean up DMX drivers
+    for (int i = 0; i < universe_count; ++i)
     {
-        vSemaphoreDelete(dmx_mutex);
-        dmx_mutex = NULL;
+        dmx_driver_delete(universes[i].port);
     }
+    universe_count = 0;
 
     dmx_initialized = false;
     ESP_LOGI(TAG, "DMX manager deinitialized");
@@ -149,18 +423,109 @@ bool dmx_manager_is_initialized(void)
     return dmx_initialized;
 }
 
+int dmx_manager_get_universe_count(void)
+{
+    return universe_count;
+}
+
+void dmx_manager_set_frame_hook(dmx_frame_hook_t hook)
+{
+    frame_hook = hook;
+}
+
+void dmx_manager_set_change_hook(dmx_change_hook_t hook)
+{
+    change_hook = hook;
+}
+
+bool dmx_manager_take_changes(int universe, uint32_t changed[DMX_CHANGE_WORDS])
+{
+    if (!dmx_initialized || !dmx_is_universe_valid(universe) || !changed)
+    {
+        return false;
+    }
+
+    dmx_universe_t *u = &universes[universe];
+    portENTER_CRITICAL(&dmx_lock);
+    bool any = u->changed;
+    memcpy(changed, u->changed_bits, sizeof(u->changed_bits));
+    memset(u->changed_bits, 0, sizeof(u->changed_bits));
+    u->changed = false;
+    portEXIT_CRITICAL(&dmx_lock);
+
+    return any;
+}
+
+// Apply system_config dmx settings; takes effect on the next frame
+esp_err_t dmx_manager_set_output(int universe_size, int interval_ms)
+{
+    if (universe_size < 1 || universe_size > DMX_UNIVERSE_SIZE ||
+        interval_ms < 1 || interval_ms > 1000)
+    {
+        ESP_LOGW(TAG, "Invalid output config: %d slots, %d ms", universe_size, interval_ms);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    max_frame_slots = universe_size;
+    frame_interval_ms = interval_ms;
+    ESP_LOGI(TAG, "Output config: up to %d slots, frame interval %d ms", universe_size, interval_ms);
+    return ESP_OK;
+}
+
+dmx_output_info_t dmx_manager_get_output_info(void)
+{
+    dmx_output_info_t info = {
+        .max_slots = max_frame_slots,
+        .frame_interval_ms = frame_interval_ms,
+        .frame_slots = longest_frame_slots(),
+        .frame_period_us = frame_period_us};
+    return info;
+}
+
+void dmx_manager_request_frame(void)
+{
+    // Both seq_cst: the store is ordered before the load, see render_idle
+    atomic_store(&frame_requested, true);
+    if (atomic_load(&render_idle) && render_task_handle != NULL)
+    {
+        xTaskNotifyGive(render_task_handle);
+    }
+}
+
+// Called from the frame hook for every command applied in this pass
+void dmx_manager_track_command(int universe, int64_t received_us, int64_t queued_us)
+{
+    if (frame_cmd_count == 0 || received_us < frame_cmd_oldest_us)
+    {
+        frame_cmd_oldest_us = received_us;
+    }
+    frame_cmd_sum_us += received_us;
+    frame_cmd_count++;
+
+    // The frame and send times are filled in once the frame is out
+    if (frame_trace_count < LATENCY_TRACE_FRAME_MAX && universe >= 0 && universe < universe_count)
+    {
+        latency_trace_t *trace = &frame_traces[frame_trace_count];
+        trace->received_us = received_us;
+        trace->queued_us = queued_us;
+        trace->applied_us = esp_timer_get_time();
+        frame_trace_universe[frame_trace_count] = (uint8_t)universe;
+        frame_trace_count++;
+    }
+}
+
 // Set single channel
-dmx_command_result_t dmx_set_channel(int channel, uint8_t value, int fade_ms)
+dmx_command_result_t dmx_set_channel(int universe, int channel, uint8_t value, int fade_ms)
 {
-    if (!dmx_initialized)
+    dmx_universe_t *u = get_universe(universe);
+    if (!u)
     {
-        ESP_LOGE(TAG, "DMX manager not initialized");
-        return DMX_CMD_ERROR_MEMORY;
+        return DMX_CMD_ERROR_INVALID_UNIVERSE;
     }
 
     if (!dmx_is_channel_valid(channel, 1))
     {
-        ESP_LOGW(TAG, "Invalid channel: %d", channel);
+        LOG_RING_W(LOG_MODULE_DMX_MANAGER, "Invalid channel: %d", channel);
         return DMX_CMD_ERROR_INVALID_CHANNEL;
     }
 
@@ -168,46 +533,43 @@ dmx_command_result_t dmx_set_channel(int channel, uint8_t value, int fade_ms)
 
     if (fade_ms > 0)
     {
-        return start_fade(array_index, value, fade_ms);
+        return start_fade(u, array_index, value, fade_ms);
     }
-    else
-    {
-        stop_fade(array_index);
 
-        if (xSemaphoreTake(dmx_mutex, pdMS_TO_TICKS(100)) == pdTRUE)
-        {
-            dmx_data[array_index] = value;
-            dmx_write(dmx_port, dmx_data, DMX_UNIVERSE_SIZE);
-            // Remove dmx_send() - only send in main loop like original
-            xSemaphoreGive(dmx_mutex);
-            return DMX_CMD_SUCCESS;
-        }
-        else
-        {
-            ESP_LOGW(TAG, "Failed to acquire mutex in dmx_set_channel");
-            return DMX_CMD_ERROR_TIMEOUT;
-        }
+    if (is_batching())
+    {
+        pend_value(u, array_index, value);
+        return DMX_CMD_SUCCESS;
     }
+
+    portENTER_CRITICAL(&dmx_lock);
+    fade_index_remove(u, array_index);
+    u->data[array_index] = value;
+    mark_dirty(u, array_index, 1);
+    portEXIT_CRITICAL(&dmx_lock);
+
+    dmx_manager_request_frame();
+    return DMX_CMD_SUCCESS;
 }
 
 // Set multiple channels
-dmx_command_result_t dmx_set_multi_channels(int start_channel, const uint8_t *values, int count, int fade_ms)
+dmx_command_result_t dmx_set_multi_channels(int universe, int start_channel, const uint8_t *values, int count, int fade_ms)
 {
-    if (!dmx_initialized)
+    dmx_universe_t *u = get_universe(universe);
+    if (!u)
     {
-        ESP_LOGE(TAG, "DMX manager not initialized");
-        return DMX_CMD_ERROR_MEMORY;
+        return DMX_CMD_ERROR_INVALID_UNIVERSE;
     }
 
     if (!dmx_is_channel_valid(start_channel, count))
     {
-        ESP_LOGW(TAG, "Invalid channel range: %d-%d", start_channel, start_channel + count - 1);
+        LOG_RING_W(LOG_MODULE_DMX_MANAGER, "Invalid channel range: %d-%d", start_channel, start_channel + count - 1);
         return DMX_CMD_ERROR_INVALID_CHANNEL;
     }
 
     if (!values)
     {
-        ESP_LOGW(TAG, "NULL values pointer in dmx_set_multi_channels");
+        LOG_RING_W(LOG_MODULE_DMX_MANAGER, "NULL values pointer in dmx_set_multi_channels");
         return DMX_CMD_ERROR_INVALID_VALUE;
     }
 
@@ -217,7 +579,7 @@ dmx_command_result_t dmx_set_multi_channels(int start_channel, const uint8_t *va
     {
         for (int i = 0; i < count; ++i)
         {
-            dmx_command_result_t result = start_fade(array_start + i, values[i], fade_ms);
+            dmx_command_result_t result = start_fade(u, array_start + i, values[i], fade_ms);
             if (result != DMX_CMD_SUCCESS)
             {
                 return result;
@@ -225,285 +587,877 @@ dmx_command_result_t dmx_set_multi_channels(int start_channel, const uint8_t *va
         }
         return DMX_CMD_SUCCESS;
     }
-    else
+
+    if (is_batching())
     {
-        if (xSemaphoreTake(dmx_mutex, pdMS_TO_TICKS(100)) == pdTRUE)
-        {
-            for (int i = 0; i < count; ++i)
-            {
-                fade_states[array_start + i].active = false;
-                dmx_data[array_start + i] = values[i];
-            }
-            dmx_write(dmx_port, dmx_data, DMX_UNIVERSE_SIZE);
-            // Remove dmx_send() - only send in main loop like original
-            xSemaphoreGive(dmx_mutex);
-            return DMX_CMD_SUCCESS;
-        }
-        else
+        for (int i = 0; i < count; ++i)
         {
-            ESP_LOGW(TAG, "Failed to acquire mutex in dmx_set_multi_channels");
-            return DMX_CMD_ERROR_TIMEOUT;
+            pend_value(u, array_start + i, values[i]);
         }
+        return DMX_CMD_SUCCESS;
     }
+
+    portENTER_CRITICAL(&dmx_lock);
+    for (int i = 0; i < count; ++i)
+    {
+        fade_index_remove(u, array_start + i);
+        u->data[array_start + i] = values[i];
+    }
+    mark_dirty(u, array_start, count);
+    portEXIT_CRITICAL(&dmx_lock);
+
+    dmx_manager_request_frame();
+    return DMX_CMD_SUCCESS;
 }
 
 // Set RGB channels
-dmx_command_result_t dmx_set_rgb(int channel, uint8_t r, uint8_t g, uint8_t b, int fade_ms)
+dmx_command_result_t dmx_set_rgb(int universe, int channel, uint8_t r, uint8_t g, uint8_t b, int fade_ms)
 {
     uint8_t rgb_values[3] = {r, g, b};
-    return dmx_set_multi_channels(channel, rgb_values, 3, fade_ms);
+    return dmx_set_multi_channels(universe, channel, rgb_values, 3, fade_ms);
 }
 
 // Set tunable white channels
-dmx_command_result_t dmx_set_tunable_white(int channel, uint8_t warm_white, uint8_t cold_white, int fade_ms)
+dmx_command_result_t dmx_set_tunable_white(int universe, int channel, uint8_t warm_white, uint8_t cold_white, int fade_ms)
 {
     uint8_t tw_values[2] = {warm_white, cold_white};
-    return dmx_set_multi_channels(channel, tw_values, 2, fade_ms);
+    return dmx_set_multi_channels(universe, channel, tw_values, 2, fade_ms);
 }
 
-// Set light with color temperature
-dmx_command_result_t dmx_set_light_ct(int channel, int brightness_percent, int color_temp_k, int fade_ms)
+// Set light with color temperature (CT calibration is shared by all universes).
+// The pair comes precomputed from the CT config, so this is table lookups,
+// multiplies and shifts only.
+dmx_command_result_t dmx_set_light_ct(int universe, int channel, int brightness_percent, int color_temp_k, int fade_ms)
 {
-    if (!dmx_initialized)
+    if (!get_universe(universe))
     {
-        ESP_LOGE(TAG, "DMX manager not initialized");
-        return DMX_CMD_ERROR_MEMORY;
+        return DMX_CMD_ERROR_INVALID_UNIVERSE;
     }
 
     // Clamp brightness to valid range
     brightness_percent = (brightness_percent < 0) ? 0 : (brightness_percent > 100) ? 100
                                                                                    : brightness_percent;
 
-    // Get color temperature configuration
-    int ct_ww, ct_cw, ch_ww, ch_cw;
-    get_ct_sorted(channel, &ct_ww, &ct_cw, &ch_ww, &ch_cw);
+    ct_pair_t pair = get_ct_pair(channel);
+    uint8_t values[2];
+    light_ct_mix(&pair, (uint32_t)brightness_percent, color_temp_k,
+                 &values[pair.ww_offset], &values[1 - pair.ww_offset]);
+
+    return dmx_set_multi_channels(universe, channel, values, 2, fade_ms);
+}
+
+// Utility functions
+uint8_t dmx_get_channel_value(int universe, int channel)
+{
+    if (!dmx_initialized || !dmx_is_universe_valid(universe) || !dmx_is_channel_valid(channel, 1))
+    {
+        return 0;
+    }
+
+    int array_index = channel; // Use channel directly like original (bug compatibility)
+
+    // Lock-free: read from the last published frame
+    return atomic_load_explicit(&universes[universe].front, memory_order_acquire)[array_index];
+}
+
+bool dmx_is_channel_fading(int universe, int channel)
+{
+    if (!dmx_initialized || !dmx_is_universe_valid(universe) || !dmx_is_channel_valid(channel, 1))
+    {
+        return false;
+    }
 
-    // Clamp color temperature to configured range
-    if (color_temp_k < ct_ww)
-        color_temp_k = ct_ww;
-    if (color_temp_k > ct_cw)
-        color_temp_k = ct_cw;
+    int array_index = channel; // Use channel directly like original (bug compatibility)
 
-    // Calculate channel values
-    uint8_t val_ww = 0, val_cw = 0;
-    int brightness_255 = (brightness_percent * 255) / 100;
+    // Lock-free single-byte snapshot
+    return universes[universe].fades[array_index].active;
+}
 
-    if (color_temp_k <= ct_ww + 100)
+void dmx_stop_all_fades(int universe)
+{
+    dmx_universe_t *u = get_universe(universe);
+    if (!u)
     {
-        // Almost pure warm white
-        val_ww = brightness_255;
-        val_cw = 0;
+        return;
     }
-    else if (color_temp_k >= ct_cw - 100)
+
+    // Fades queued earlier in this frame would be running by now
+    if (is_batching())
     {
-        // Almost pure cold white
-        val_ww = 0;
-        val_cw = brightness_255;
+        cancel_pending_fades(u);
+    }
+
+    portENTER_CRITICAL(&dmx_lock);
+    fade_index_clear(u);
+    portEXIT_CRITICAL(&dmx_lock);
+}
+
+dmx_manager_stats_t dmx_manager_get_stats(void)
+{
+    dmx_manager_stats_t stats;
+    stats_seqlock_read(&dmx_stats_lock, &stats, &dmx_stats_shared, sizeof(stats));
+    return stats;
+}
+
+// Applied by the render task before its next publish
+void dmx_manager_reset_stats(void)
+{
+    atomic_store(&stats_reset_requested, true);
+}
+
+// Render task only
+static void publish_stats(void)
+{
+    uint32_t fades = atomic_exchange_explicit(&fades_armed, 0, memory_order_relaxed);
+    if (atomic_exchange(&stats_reset_requested, false))
+    {
+        memset(&dmx_stats, 0, sizeof(dmx_stats));
+        latency_total_us = 0;
+        jitter_total_us = 0;
+    }
+    dmx_stats.fades_started += fades;
+    stats_seqlock_publish(&dmx_stats_lock, &dmx_stats_shared, &dmx_stats, sizeof(dmx_stats));
+}
+
+int dmx_get_active_fade_count(void)
+{
+    if (!dmx_initialized)
+    {
+        return 0;
+    }
+
+    int count = 0;
+    for (int i = 0; i < universe_count; ++i)
+    {
+        count += universes[i].active_fade_count;
+    }
+    return count;
+}
+
+// Private functions
+
+// Brightness (0-100%) and color temperature to WW/CW levels:
+//   level = brightness * 255 / 100
+//   at most 100 K from an end of the pair: that channel only, at level
+//   otherwise each channel gets brightness * 255 * distance / (100 * range),
+//   rounded, and levels below 2% (5 of 255) are switched off
+static void light_ct_mix(const ct_pair_t *pair, uint32_t brightness_percent, int color_temp_k, uint8_t *val_ww, uint8_t *val_cw)
+{
+    int ct_ww = pair->ct_ww;
+    int ct_cw = pair->ct_cw;
+    int ct = (color_temp_k < ct_ww) ? ct_ww : (color_temp_k > ct_cw ? ct_cw : color_temp_k);
+
+    // n / 100 == (n * 5243) >> 19 for n < 43699
+    uint8_t level = (uint8_t)((brightness_percent * 255 * 5243) >> 19);
+
+    if (ct <= ct_ww + 100)
+    {
+        *val_ww = level; // Almost pure warm white
+        *val_cw = 0;
+        return;
+    }
+    if (ct >= ct_cw - 100)
+    {
+        *val_ww = 0; // Almost pure cold white
+        *val_cw = level;
+        return;
+    }
+
+    // Mixed: the rounding half of the divisor is 50 * range
+    uint32_t half = 50u * (uint32_t)(ct_cw - ct_ww);
+    uint32_t n_cw = brightness_percent * (uint32_t)(ct - ct_ww) * 255 + half;
+    uint32_t n_ww = brightness_percent * (uint32_t)(ct_cw - ct) * 255 + half;
+    uint8_t cw = (uint8_t)(((uint64_t)n_cw * pair->recip) >> pair->shift);
+    uint8_t ww = (uint8_t)(((uint64_t)n_ww * pair->recip) >> pair->shift);
+
+    *val_cw = (cw < 6) ? 0 : cw;
+    *val_ww = (ww < 6) ? 0 : ww;
+}
+
+static dmx_command_result_t start_fade(dmx_universe_t *u, int array_index, uint8_t value, int duration_ms)
+{
+    if (!is_array_index_valid(array_index))
+    {
+        LOG_RING_W(LOG_MODULE_DMX_MANAGER, "Invalid array index for start_fade: %d", array_index);
+        return DMX_CMD_ERROR_INVALID_CHANNEL;
+    }
+
+    if (duration_ms > DMX_MAX_FADE_MS)
+    {
+        duration_ms = DMX_MAX_FADE_MS;
+    }
+
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    if (is_batching())
+    {
+        pend_fade(u, array_index, value, duration_ms, now_ms);
     }
     else
     {
-        // Mixed color temperature
-        int range = ct_cw - ct_ww;
-        if (range <= 0)
+        arm_fade(u, array_index, value, duration_ms, now_ms);
+        dmx_manager_request_frame();
+    }
+    return DMX_CMD_SUCCESS;
+}
+
+// Start a fade from the slot's current value
+static void arm_fade(dmx_universe_t *u, int array_index, uint8_t value, int duration_ms, uint32_t start_ms)
+{
+    fade_state_t *fade = &u->fades[array_index];
+
+    portENTER_CRITICAL(&dmx_lock);
+    fade->start_value = u->data[array_index];
+    fade->target_value = value;
+    fade->duration_ms = duration_ms;
+    fade->start_ms = start_ms;
+    fade->kernel = fade_kernel_prepare((uint32_t)duration_ms);
+    fade_index_add(u, array_index);
+    if (array_index > u->highest_slot)
+    {
+        u->highest_slot = array_index;
+    }
+    portEXIT_CRITICAL(&dmx_lock);
+    atomic_fetch_add_explicit(&fades_armed, 1, memory_order_relaxed);
+}
+
+static bool is_batching(void)
+{
+    return batch_open && xTaskGetCurrentTaskHandle() == render_task_handle;
+}
+
+// Coalescing helpers - render task only. A write replaces whatever is
+// pending for the slot; a fade replaces a pending fade but keeps a pending
+// value, which it starts from.
+static void pend_value(dmx_universe_t *u, int array_index, uint8_t value)
+{
+    pending_write_t *p = &u->pending[array_index];
+    uint32_t bit = 1u << (array_index & 31);
+
+    if (u->pending_bits[array_index >> 5] & bit)
+    {
+        dmx_stats.commands_coalesced += ((p->flags & PENDING_VALUE) ? 1 : 0) + ((p->flags & PENDING_FADE) ? 1 : 0);
+    }
+    else
+    {
+        u->pending_bits[array_index >> 5] |= bit;
+        u->has_pending = true;
+    }
+
+    p->flags = PENDING_VALUE;
+    p->value = value;
+}
+
+static void pend_fade(dmx_universe_t *u, int array_index, uint8_t value, int duration_ms, uint32_t start_ms)
+{
+    pending_write_t *p = &u->pending[array_index];
+    uint32_t bit = 1u << (array_index & 31);
+
+    if (u->pending_bits[array_index >> 5] & bit)
+    {
+        if (p->flags & PENDING_FADE)
         {
-            ESP_LOGW(TAG, "Invalid CT range for channel %d", channel);
-            return DMX_CMD_ERROR_CONFIG_MISSING;
+            dmx_stats.commands_coalesced++;
         }
+    }
+    else
+    {
+        u->pending_bits[array_index >> 5] |= bit;
+        u->has_pending = true;
+        p->flags = 0;
+    }
 
-        long num_cw = (long)brightness_percent * (color_temp_k - ct_ww) * 255;
-        long num_ww = (long)brightness_percent * (ct_cw - color_temp_k) * 255;
-        long den = (long)range * 100;
-
-        val_cw = (uint8_t)((num_cw + den / 2) / den);
-        val_ww = (uint8_t)((num_ww + den / 2) / den);
+    p->flags |= PENDING_FADE;
+    p->target = value;
+    p->duration_ms = duration_ms;
+    p->start_ms = start_ms;
+}
 
-        // Remove very low values (< 2%)
-        if (val_cw * 100 / 255 < 2)
-            val_cw = 0;
-        if (val_ww * 100 / 255 < 2)
-            val_ww = 0;
+static void cancel_pending_fades(dmx_universe_t *u)
+{
+    for (int w = 0; w < DIRTY_WORDS; ++w)
+    {
+        for (uint32_t bits = u->pending_bits[w]; bits != 0; bits &= bits - 1)
+        {
+            int i = (w << 5) + __builtin_ctz(bits);
+            if (u->pending[i].flags & PENDING_FADE)
+            {
+                u->pending[i].flags &= ~PENDING_FADE;
+                dmx_stats.commands_coalesced++;
+                if (u->pending[i].flags == 0)
+                {
+                    u->pending_bits[w] &= ~(1u << (i & 31));
+                }
+            }
+        }
     }
+}
 
-    // Set channels based on which channel is lower
-    int start_ch = (ch_ww < ch_cw) ? ch_ww : ch_cw;
-    uint8_t values[2] = {0, 0};
-    values[ch_ww - start_ch] = val_ww;
-    values[ch_cw - start_ch] = val_cw;
+// Apply the surviving writes: the values of each 32-slot word under one
+// lock, then the fades, which start from those values
+static void commit_pending(dmx_universe_t *u)
+{
+    for (int w = 0; w < DIRTY_WORDS; ++w)
+    {
+        uint32_t pending = u->pending_bits[w];
+        if (pending == 0)
+        {
+            continue;
+        }
+        u->pending_bits[w] = 0;
 
-    ESP_LOGI(TAG, "Light CT %dK, Brightness %d%% → WW=%d (CH%d), CW=%d (CH%d)",
-             color_temp_k, brightness_percent, val_ww, ch_ww, val_cw, ch_cw);
+        portENTER_CRITICAL(&dmx_lock);
+        for (uint32_t bits = pending; bits != 0; bits &= bits - 1)
+        {
+            int i = (w << 5) + __builtin_ctz(bits);
+            if (u->pending[i].flags & PENDING_VALUE)
+            {
+                fade_index_remove(u, i);
+                u->data[i] = u->pending[i].value;
+                mark_dirty(u, i, 1);
+            }
+        }
+        portEXIT_CRITICAL(&dmx_lock);
 
-    return dmx_set_multi_channels(start_ch, values, 2, fade_ms);
+        for (uint32_t bits = pending; bits != 0; bits &= bits - 1)
+        {
+            int i = (w << 5) + __builtin_ctz(bits);
+            const pending_write_t *p = &u->pending[i];
+            if (p->flags & PENDING_FADE)
+            {
+                arm_fade(u, i, p->target, p->duration_ms, p->start_ms);
+            }
+        }
+    }
+    u->has_pending = false;
 }
 
-// Utility functions
-uint8_t dmx_get_channel_value(int channel)
+// Active fade index helpers - caller must hold dmx_lock
+static void fade_index_add(dmx_universe_t *u, int array_index)
 {
-    if (!dmx_initialized || !dmx_is_channel_valid(channel, 1))
+    if (u->fades[array_index].active)
     {
-        return 0;
+        return; // Already indexed, fade parameters were just re-armed
     }
 
-    uint8_t value = 0;
-    int array_index = channel; // Use channel directly like original (bug compatibility)
+    u->fades[array_index].slot = (uint16_t)u->active_fade_count;
+    u->active_fades[u->active_fade_count++] = (uint16_t)array_index;
+    u->fades[array_index].active = true;
+}
 
-    if (xSemaphoreTake(dmx_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+static void fade_index_remove(dmx_universe_t *u, int array_index)
+{
+    if (!u->fades[array_index].active)
     {
-        value = dmx_data[array_index];
-        xSemaphoreGive(dmx_mutex);
+        return;
     }
 
-    return value;
+    // Swap-remove: move the last entry into the freed slot
+    uint16_t slot = u->fades[array_index].slot;
+    uint16_t last = u->active_fades[--u->active_fade_count];
+    u->active_fades[slot] = last;
+    u->fades[last].slot = slot;
+    u->fades[array_index].active = false;
 }
 
-bool dmx_is_channel_fading(int channel)
+static void fade_index_clear(dmx_universe_t *u)
 {
-    if (!dmx_initialized || !dmx_is_channel_valid(channel, 1))
+    for (int n = 0; n < u->active_fade_count; ++n)
+    {
+        u->fades[u->active_fades[n]].active = false;
+    }
+    u->active_fade_count = 0;
+}
+
+// Advance fades and publish the staged universe, returns true when a new
+// frame was published
+static bool render_frame(dmx_universe_t *u, uint32_t now_ms)
+{
+    // Idle fast path: nothing fading and nothing staged, skip the lock.
+    // A write racing with this check is picked up on the next frame.
+    if (u->active_fade_count == 0 && !u->staged)
     {
         return false;
     }
 
-    int array_index = channel; // Use channel directly like original (bug compatibility)
-    bool fading = false;
+    portENTER_CRITICAL(&dmx_lock);
 
-    if (xSemaphoreTake(dmx_mutex, pdMS_TO_TICKS(10)) == pdTRUE)
+    // Only visit indexed fades; finished entries are swap-removed,
+    // so n is advanced only when the current slot stays active
+    for (int n = 0; n < u->active_fade_count;)
     {
-        fading = fade_states[array_index].active;
-        xSemaphoreGive(dmx_mutex);
+        int i = u->active_fades[n];
+        fade_state_t *fade = &u->fades[i];
+        int elapsed = (int)(now_ms - fade->start_ms);
+        int duration = fade->duration_ms;
+
+        if (duration <= 0)
+        {
+            u->data[i] = fade->target_value;
+            fade_index_remove(u, i);
+            mark_dirty(u, i, 1);
+            mark_changed(u, i);
+            dmx_stats.fades_completed++;
+            continue;
+        }
+
+        uint8_t new_value;
+        bool finished = false;
+
+        if (elapsed >= duration)
+        {
+            new_value = fade->target_value;
+            finished = true;
+        }
+        else
+        {
+            new_value = fade_kernel_value(&fade->kernel, fade->start_value, fade->target_value,
+                                          (uint32_t)duration, (uint32_t)elapsed);
+        }
+
+        if (u->data[i] != new_value)
+        {
+            u->data[i] = new_value;
+            mark_dirty(u, i, 1);
+        }
+
+        if (finished)
+        {
+            fade_index_remove(u, i);
+            mark_changed(u, i);
+            dmx_stats.fades_completed++;
+        }
+        else
+        {
+            ++n;
+        }
+    }
+
+    // Bring the spare frame up to date: slots written this frame plus the
+    // ones it missed while it was the front frame
+    uint8_t *front = atomic_load_explicit(&u->front, memory_order_relaxed);
+    uint8_t *spare = (front == u->frames[0]) ? u->frames[1] : u->frames[0];
+    bool publish = u->staged;
+    if (publish)
+    {
+        uint32_t refresh[DIRTY_WORDS];
+        for (int w = 0; w < DIRTY_WORDS; ++w)
+        {
+            u->frame_dirty[w] = u->dirty_bits[w];
+            refresh[w] = u->dirty_bits[w] | u->spare_stale[w];
+            u->dirty_bits[w] = 0;
+        }
+
+        if (change_hook != NULL)
+        {
+            for (int w = 0; w < DIRTY_WORDS; ++w)
+            {
+                u->changed_bits[w] |= u->frame_dirty[w];
+            }
+            u->changed = true;
+        }
+
+        int copy_count = collect_spans(refresh, copy_spans);
+        for (int n = 0; n < copy_count; ++n)
+        {
+            memcpy(spare + copy_spans[n].start, u->data + copy_spans[n].start, copy_spans[n].length);
+        }
+        u->staged = false;
     }
 
-    return fading;
+    portEXIT_CRITICAL(&dmx_lock);
+
+    if (publish)
+    {
+        atomic_store_explicit(&u->front, spare, memory_order_release);
+
+        // The frame swapped out now lacks exactly this frame's writes
+        memcpy(u->spare_stale, u->frame_dirty, sizeof(u->spare_stale));
+        u->frame_span_count = collect_spans(u->frame_dirty, u->frame_spans);
+    }
+    return publish;
 }
 
-void dmx_stop_all_fades(void)
+// Record a finished fade for state feedback - caller must hold dmx_lock
+static void mark_changed(dmx_universe_t *u, int array_index)
 {
-    if (!dmx_initialized)
+    if (change_hook != NULL)
     {
-        return;
+        u->changed_bits[array_index >> 5] |= 1u << (array_index & 31);
+        u->changed = true;
+    }
+}
+
+// Push the spans that changed in this frame into the driver buffer
+static void write_frame(dmx_universe_t *u)
+{
+    const uint8_t *front = atomic_load_explicit(&u->front, memory_order_relaxed);
+
+    // Never write into a packet that is still on the wire
+    dmx_wait_sent(u->port, pdMS_TO_TICKS(DMX_FRAME_INTERVAL_MS));
+    for (int n = 0; n < u->frame_span_count; ++n)
+    {
+        dmx_write_offset(u->port, u->frame_spans[n].start,
+                         front + u->frame_spans[n].start, u->frame_spans[n].length);
+        dmx_stats.bytes_written += u->frame_spans[n].length;
+    }
+    dmx_stats.spans_written += u->frame_span_count;
+}
+
+// Mark slots as changed - caller must hold dmx_lock
+static void mark_dirty(dmx_universe_t *u, int array_index, int count)
+{
+    for (int i = array_index; i < array_index + count; ++i)
+    {
+        u->dirty_bits[i >> 5] |= 1u << (i & 31);
     }
+    if (array_index + count - 1 > u->highest_slot)
+    {
+        u->highest_slot = array_index + count - 1;
+    }
+    u->staged = true;
+}
 
-    if (xSemaphoreTake(dmx_mutex, pdMS_TO_TICKS(100)) == pdTRUE)
+// Turn a dirty bitmap into slot spans, bridging gaps of up to
+// DIRTY_MERGE_GAP clean slots. Returns the number of spans.
+static int collect_spans(const uint32_t *bits, dmx_span_t *spans)
+{
+    int count = 0;
+    int i = 0;
+
+    while (i < DMX_UNIVERSE_SIZE)
     {
-        for (int i = 0; i < DMX_UNIVERSE_SIZE; i++)
+        // Find the next set bit
+        uint32_t word = bits[i >> 5] >> (i & 31);
+        if (word == 0)
+        {
+            i = (i | 31) + 1;
+            continue;
+        }
+        i += __builtin_ctz(word);
+
+        // Find the end of the run (first clear bit)
+        int start = i;
+        while (i < DMX_UNIVERSE_SIZE)
+        {
+            uint32_t clear = ~bits[i >> 5] >> (i & 31);
+            if (clear == 0)
+            {
+                i = (i | 31) + 1;
+                continue;
+            }
+            i += __builtin_ctz(clear);
+            break;
+        }
+        if (i > DMX_UNIVERSE_SIZE)
+        {
+            i = DMX_UNIVERSE_SIZE;
+        }
+
+        if (count > 0 && start - (spans[count - 1].start + spans[count - 1].length) <= DIRTY_MERGE_GAP)
         {
-            fade_states[i].active = false;
+            spans[count - 1].length = (uint16_t)(i - spans[count - 1].start);
+        }
+        else
+        {
+            spans[count].start = (uint16_t)start;
+            spans[count].length = (uint16_t)(i - start);
+            count++;
         }
-        xSemaphoreGive(dmx_mutex);
     }
+
+    return count;
 }
 
-// Private functions
-static dmx_command_result_t start_fade(int array_index, uint8_t value, int duration_ms)
+// Fold the commands applied in this pass into the latency statistics
+static void account_latency(int64_t sent_us)
 {
-    if (!is_array_index_valid(array_index))
+    if (frame_cmd_count == 0)
     {
-        ESP_LOGW(TAG, "Invalid array index for start_fade: %d", array_index);
-        return DMX_CMD_ERROR_INVALID_CHANNEL;
+        return;
     }
 
-    if (xSemaphoreTake(dmx_mutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    uint32_t worst = (uint32_t)(sent_us - frame_cmd_oldest_us);
+    latency_total_us += (uint64_t)((int64_t)frame_cmd_count * sent_us - frame_cmd_sum_us);
+    dmx_stats.latency_samples += frame_cmd_count;
+    dmx_stats.latency_avg_us = (uint32_t)(latency_total_us / dmx_stats.latency_samples);
+    dmx_stats.latency_last_us = worst;
+    if (worst > dmx_stats.latency_max_us)
     {
-        fade_states[array_index].start_value = dmx_data[array_index];
-        fade_states[array_index].target_value = value;
-        fade_states[array_index].duration_ms = duration_ms;
-        fade_states[array_index].start_time = xTaskGetTickCount();
-        fade_states[array_index].active = true;
-        xSemaphoreGive(dmx_mutex);
-        return DMX_CMD_SUCCESS;
+        dmx_stats.latency_max_us = worst;
     }
-    else
+
+    frame_cmd_count = 0;
+    frame_cmd_sum_us = 0;
+}
+
+// Complete the traces of this pass with their universe's render and send
+// times and add them to the stage histograms
+static void record_traces(const int64_t *rendered_us, const int64_t *sent_us)
+{
+    for (int i = 0; i < frame_trace_count; ++i)
     {
-        ESP_LOGW(TAG, "Failed to acquire mutex in start_fade");
-        return DMX_CMD_ERROR_TIMEOUT;
+        int universe = frame_trace_universe[i];
+        frame_traces[i].rendered_us = rendered_us[universe];
+        frame_traces[i].sent_us = sent_us[universe];
+        latency_trace_record(&frame_traces[i]);
     }
+    frame_trace_count = 0;
 }
 
-static void stop_fade(int array_index)
+// Slots to put on the wire: start code up to the highest written slot,
+// padded to the minimum packet length and capped by the configured size
+static int frame_slots(const dmx_universe_t *u)
 {
-    if (!is_array_index_valid(array_index))
+    int slots = u->highest_slot + 1;
+    if (slots < DMX_MIN_FRAME_SLOTS)
+    {
+        slots = DMX_MIN_FRAME_SLOTS;
+    }
+    if (slots > max_frame_slots)
+    {
+        slots = max_frame_slots;
+    }
+    return slots;
+}
+
+static int longest_frame_slots(void)
+{
+    int slots = DMX_MIN_FRAME_SLOTS;
+    for (int i = 0; i < universe_count; ++i)
+    {
+        int universe_slots = frame_slots(&universes[i]);
+        if (universe_slots > slots)
+        {
+            slots = universe_slots;
+        }
+    }
+    return slots;
+}
+
+// (Re)arm the frame clock when the configured interval or the longest
+// frame changed the effective period
+static void update_frame_timer(void)
+{
+    uint32_t period_us = (uint32_t)frame_interval_ms * 1000;
+    uint32_t wire_us = DMX_BREAK_US + DMX_MAB_US + (uint32_t)longest_frame_slots() * DMX_SLOT_US;
+    if (period_us < wire_us)
+    {
+        period_us = wire_us;
+    }
+
+    if (period_us == frame_period_us || frame_timer == NULL)
     {
-        ESP_LOGW(TAG, "Invalid array index for stop_fade: %d", array_index);
         return;
     }
 
-    if (xSemaphoreTake(dmx_mutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    // A stopped clock picks the new period up when it restarts
+    if (!atomic_load(&render_idle))
     {
-        fade_states[array_index].active = false;
-        xSemaphoreGive(dmx_mutex);
+        esp_timer_stop(frame_timer); // Not running on first call, error ignored
+        if (esp_timer_start_periodic(frame_timer, period_us) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Failed to start frame timer");
+            return;
+        }
     }
-    else
+    frame_period_us = period_us;
+    ESP_LOGI(TAG, "Frame clock %lu us (%d slots)", (unsigned long)period_us, longest_frame_slots());
+}
+
+// Runs in the esp_timer interrupt, so neither the Wi-Fi task nor the
+// esp_timer task can hold a tick back, and tick_us is the alarm time
+static void IRAM_ATTR frame_timer_callback(void *arg)
+{
+    atomic_store_explicit(&tick_us, (uint32_t)esp_timer_get_time(), memory_order_relaxed);
+    if (render_task_handle != NULL)
     {
-        ESP_LOGW(TAG, "Failed to acquire mutex in stop_fade");
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(render_task_handle, &woken);
+        if (woken == pdTRUE)
+        {
+            esp_timer_isr_dispatch_need_yield();
+        }
     }
 }
 
-// Fade task implementation
-static void fade_task(void *arg)
+// Deviation of the send-to-send interval from the frame period. The
+// first frame after a period change only restarts the measurement.
+static void account_jitter(int64_t send_us)
 {
-    ESP_LOGI(TAG, "DMX fade task started");
+    if (last_send_us != 0 && last_send_period_us == frame_period_us)
+    {
+        int64_t deviation = (send_us - last_send_us) - (int64_t)frame_period_us;
+        uint32_t jitter = (uint32_t)(deviation < 0 ? -deviation : deviation);
+        jitter_total_us += jitter;
+        dmx_stats.jitter_samples++;
+        dmx_stats.jitter_avg_us = (uint32_t)(jitter_total_us / dmx_stats.jitter_samples);
+        if (jitter > dmx_stats.jitter_max_us)
+        {
+            dmx_stats.jitter_max_us = jitter;
+        }
+    }
+
+    last_send_us = send_us;
+    last_send_period_us = frame_period_us;
+}
+
+// Render task: one deterministic step per frame clock tick - apply queued
+// commands, advance fades, publish, write to the driver and send. While
+// nothing changes the clock stops and the task only resends the frames
+// every DMX_IDLE_REFRESH_MS, so receivers keep their signal.
+static void render_task(void *arg)
+{
+    render_start_t *start = (render_start_t *)arg;
+    esp_err_t err = install_ports(start->pins, start->count);
+    start->result = err;
+    xSemaphoreGive(start->done); // start is gone after this
+    if (err != ESP_OK)
+    {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    ESP_LOGI(TAG, "DMX render task started on core %d", xPortGetCoreID());
 
     while (1)
     {
-        TickType_t now = xTaskGetTickCount();
-        bool updated = false;
+        // Clocked: wait for the next tick. Idle: a frame request or the
+        // keep-alive timeout, neither of them is a tick.
+        bool ticked = !atomic_load(&render_idle);
+        ulTaskNotifyTake(pdTRUE, ticked ? portMAX_DELAY : pdMS_TO_TICKS(DMX_IDLE_REFRESH_MS));
 
-        if (xSemaphoreTake(dmx_mutex, pdMS_TO_TICKS(100)) == pdTRUE)
+        if (render_pass(ticked))
         {
-            for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i)
+            quiet_frames = 0;
+            if (!ticked)
             {
-                if (!fade_states[i].active)
-                {
-                    continue;
-                }
-
-                int elapsed = (now - fade_states[i].start_time) * portTICK_PERIOD_MS;
-                int duration = fade_states[i].duration_ms;
-
-                if (duration <= 0)
-                {
-                    dmx_data[i] = fade_states[i].target_value;
-                    fade_states[i].active = false;
-                    updated = true;
-                    continue;
-                }
+                leave_idle();
+            }
+        }
+        else if (ticked && ++quiet_frames >= DMX_IDLE_HOLD_FRAMES)
+        {
+            enter_idle();
+        }
+    }
+}
 
-                uint8_t start = fade_states[i].start_value;
-                uint8_t target = fade_states[i].target_value;
-                uint8_t new_value;
+// One frame for every universe. All universes share the pass; each port
+// is started before the next one is rendered so the UARTs transmit in
+// parallel. Returns true while anything is still changing: a frame was
+// requested or published, or fades are running.
+static bool render_pass(bool ticked)
+{
+    bool active = atomic_exchange(&frame_requested, false);
+    dmx_stats.render_wakeups++;
 
-                if (elapsed >= duration)
-                {
-                    new_value = target;
-                    fade_states[i].active = false;
-                }
-                else
-                {
-                    float t = (float)elapsed / (float)duration;
-                    float interpolated = start + (target - start) * t;
-                    new_value = (uint8_t)roundf(interpolated);
-                }
+    if (ticked)
+    {
+        uint32_t wake_us = (uint32_t)(esp_timer_get_time() -
+                                      atomic_load_explicit(&tick_us, memory_order_relaxed));
+        if (wake_us > dmx_stats.wake_max_us)
+        {
+            dmx_stats.wake_max_us = wake_us;
+        }
+    }
 
-                if (dmx_data[i] != new_value)
-                {
-                    dmx_data[i] = new_value;
-                    updated = true;
-                }
-            }
+    // Apply queued commands first so they land in this frame; their
+    // channel writes are coalesced and committed once
+    if (frame_hook != NULL)
+    {
+        batch_open = true;
+        frame_hook();
+        batch_open = false;
 
-            // Send DMX data if updated (write only when changed)
-            if (updated)
+        for (int i = 0; i < universe_count; ++i)
+        {
+            if (universes[i].has_pending)
             {
-                dmx_write(dmx_port, dmx_data, DMX_UNIVERSE_SIZE);
+                commit_pending(&universes[i]);
             }
+        }
+    }
 
-            xSemaphoreGive(dmx_mutex);
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    bool changed = false;
+    int64_t rendered_us[DMX_MAX_UNIVERSES];
+    int64_t sent_us[DMX_MAX_UNIVERSES];
+    for (int i = 0; i < universe_count; ++i)
+    {
+        dmx_universe_t *u = &universes[i];
+
+        if (render_frame(u, now_ms))
+        {
+            write_frame(u);
+            dmx_stats.frames_published++;
+            active = true;
         }
         else
         {
-            ESP_LOGW(TAG, "Failed to acquire mutex in fade_task");
+            dmx_stats.frames_idle++;
+        }
+        changed |= u->changed;
+        active |= u->active_fade_count > 0;
+
+        rendered_us[i] = esp_timer_get_time();
+        if (i == 0)
+        {
+            // Only the frame clock has a period to deviate from
+            if (ticked)
+            {
+                account_jitter(rendered_us[i]);
+            }
+            else
+            {
+                last_send_us = 0;
+            }
         }
+        // Returns once the driver has started the frame
+        dmx_send_num(u->port, frame_slots(u));
+        sent_us[i] = esp_timer_get_time();
+        dmx_stats.frames_sent++;
+    }
+    account_latency(esp_timer_get_time());
+    record_traces(rendered_us, sent_us);
+    publish_stats();
 
-        // Fade task timing - exact from working code
-        vTaskDelay(pdMS_TO_TICKS(30));
+    // Feedback runs after the frames are on their way
+    if (changed && change_hook != NULL)
+    {
+        change_hook();
+    }
+
+    update_frame_timer();
+    return active;
+}
+
+// Stop the frame clock - render task only. A tick that fired before the
+// stop is dropped; requests made after render_idle is set notify anew.
+static void enter_idle(void)
+{
+    esp_timer_stop(frame_timer);
+    ulTaskNotifyTake(pdTRUE, 0);
+    atomic_store(&render_idle, true);
+
+    if (atomic_load(&frame_requested))
+    {
+        leave_idle(); // Raced with a writer, the next tick renders it
+        return;
+    }
+    quiet_frames = 0;
+    dmx_stats.idle_sleeps++;
+    publish_stats();
+}
+
+// Restart the frame clock - render task only
+static void leave_idle(void)
+{
+    atomic_store(&render_idle, false);
+    quiet_frames = 0;
+    last_send_us = 0; // The first tick restarts the jitter measurement
+    if (esp_timer_start_periodic(frame_timer, frame_period_us) != ESP_OK)
+    {
+        // Stay on keep-alive frames, the next request tries again
+        ESP_LOGE(TAG, "Failed to restart frame timer");
+        atomic_store(&render_idle, true);
     }
 }
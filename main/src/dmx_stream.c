@@ -0,0 +1,214 @@
+#include "dmx_stream.h"
+#include "dmx_manager.h"
+#include "stats_seqlock.h"
+
+#include <string.h>
+#include <stdatomic.h>
+
+typedef struct
+{
+    uint8_t levels[DMX_UNIVERSE_SIZE]; // Reference frame, slot 1 at index 0
+    uint8_t sequence;
+    bool synced;                       // Reference frame valid for deltas
+} dmx_stream_state_t;
+
+// Decoder state (UDP server task only)
+static int universe_count = 1;
+static dmx_stream_state_t states[DMX_MAX_UNIVERSES];
+
+// Statistics: the decoder runs on the UDP server task, which publishes them
+static dmx_stream_stats_t stream_stats = {0};
+static dmx_stream_stats_t stream_stats_shared = {0};
+static stats_seqlock_t stream_stats_lock = STATS_SEQLOCK_INIT;
+static _Atomic bool stats_reset_requested = false;
+
+void dmx_stream_init(int count)
+{
+    universe_count = (count < 1) ? 1 : (count > DMX_MAX_UNIVERSES ? DMX_MAX_UNIVERSES : count);
+    memset(states, 0, sizeof(states));
+}
+
+// A raw universe has to match the magic, version and frame type to be
+// mistaken for a stream frame
+bool dmx_stream_is_packet(const uint8_t *buf, size_t len)
+{
+    return buf && len >= DMX_STREAM_HEADER_SIZE && buf[0] == DMX_STREAM_MAGIC &&
+           buf[1] == DMX_STREAM_VERSION && buf[2] <= DMX_STREAM_DELTA;
+}
+
+// Apply RLE tokens to levels; tracks the written range in first/last
+static bool decode_tokens(const uint8_t *p, const uint8_t *end, uint8_t *levels, int *first, int *last)
+{
+    int slot = 0;
+
+    while (p < end)
+    {
+        uint8_t token = *p++;
+        int run;
+
+        if (token & DMX_STREAM_TOKEN_REPEAT)
+        {
+            run = (token & 0x7F) + 1;
+            if (p == end || slot + run > DMX_UNIVERSE_SIZE)
+            {
+                return false;
+            }
+            memset(&levels[slot], *p++, (size_t)run);
+        }
+        else if (token & DMX_STREAM_TOKEN_LITERAL)
+        {
+            run = (token & 0x3F) + 1;
+            if (end - p < run || slot + run > DMX_UNIVERSE_SIZE)
+            {
+                return false;
+            }
+            memcpy(&levels[slot], p, (size_t)run);
+            p += run;
+        }
+        else
+        {
+            run = (token & 0x3F) + 1;
+            if (slot + run > DMX_UNIVERSE_SIZE)
+            {
+                return false;
+            }
+            slot += run;
+            continue;
+        }
+
+        if (*first < 0)
+        {
+            *first = slot;
+        }
+        slot += run;
+        *last = slot - 1;
+    }
+
+    return true;
+}
+
+// Header: magic, version, type, universe, sequence, base sequence
+dmx_stream_result_t dmx_stream_decode(const uint8_t *buf, size_t len, dmx_stream_frame_t *out)
+{
+    if (!buf || len < DMX_STREAM_HEADER_SIZE || buf[0] != DMX_STREAM_MAGIC || !out ||
+        buf[2] > DMX_STREAM_DELTA)
+    {
+        stream_stats.packets_invalid++;
+        return DMX_STREAM_ERR_HEADER;
+    }
+
+    if (buf[1] != DMX_STREAM_VERSION)
+    {
+        stream_stats.packets_invalid++;
+        return DMX_STREAM_ERR_VERSION;
+    }
+
+    int universe = buf[3];
+    if (universe >= universe_count)
+    {
+        return DMX_STREAM_NOT_OURS;
+    }
+
+    dmx_stream_state_t *state = &states[universe];
+    bool keyframe = (buf[2] == DMX_STREAM_KEYFRAME);
+    uint8_t sequence = buf[4];
+
+    if (!keyframe)
+    {
+        if (!state->synced)
+        {
+            stream_stats.deltas_dropped++;
+            return DMX_STREAM_NEED_KEYFRAME;
+        }
+
+        if (buf[5] != state->sequence)
+        {
+            // A delta that is not newer is a late duplicate and harmless;
+            // anything else means a frame was lost
+            if ((int8_t)(sequence - state->sequence) <= 0)
+            {
+                stream_stats.out_of_order++;
+                return DMX_STREAM_OUT_OF_ORDER;
+            }
+            state->synced = false;
+            stream_stats.resyncs++;
+            stream_stats.deltas_dropped++;
+            return DMX_STREAM_NEED_KEYFRAME;
+        }
+    }
+    else
+    {
+        // A late keyframe would roll the universe back to older levels
+        if (state->synced && (int8_t)(sequence - state->sequence) <= 0)
+        {
+            stream_stats.out_of_order++;
+            return DMX_STREAM_OUT_OF_ORDER;
+        }
+        memset(state->levels, 0, sizeof(state->levels));
+    }
+
+    int first = -1;
+    int last = -1;
+    if (!decode_tokens(buf + DMX_STREAM_HEADER_SIZE, buf + len, state->levels, &first, &last))
+    {
+        state->synced = false;
+        stream_stats.packets_invalid++;
+        return DMX_STREAM_ERR_CORRUPT;
+    }
+
+    state->sequence = sequence;
+    state->synced = true;
+
+    out->universe = universe;
+    out->keyframe = keyframe;
+    out->levels = state->levels;
+    if (keyframe)
+    {
+        // Slots a keyframe skips are zero, so it covers the whole universe
+        out->first = 0;
+        out->count = DMX_UNIVERSE_SIZE;
+        stream_stats.keyframes++;
+    }
+    else
+    {
+        out->first = (first < 0) ? 0 : first;
+        out->count = (first < 0) ? 0 : last - first + 1;
+        stream_stats.deltas++;
+    }
+
+    stream_stats.bytes_received += (uint32_t)len;
+    stream_stats.slots_decoded += (uint32_t)out->count;
+    return DMX_STREAM_OK;
+}
+
+void dmx_stream_invalidate(int universe)
+{
+    if (universe >= 0 && universe < universe_count && states[universe].synced)
+    {
+        states[universe].synced = false;
+        stream_stats.resyncs++;
+    }
+}
+
+// Server task only
+void dmx_stream_publish_stats(void)
+{
+    if (atomic_exchange(&stats_reset_requested, false))
+    {
+        memset(&stream_stats, 0, sizeof(stream_stats));
+    }
+    stats_seqlock_publish(&stream_stats_lock, &stream_stats_shared, &stream_stats, sizeof(stream_stats));
+}
+
+dmx_stream_stats_t dmx_stream_get_stats(void)
+{
+    dmx_stream_stats_t stats;
+    stats_seqlock_read(&stream_stats_lock, &stats, &stream_stats_shared, sizeof(stats));
+    return stats;
+}
+
+// Applied by the server task at its next publish
+void dmx_stream_reset_stats(void)
+{
+    atomic_store(&stats_reset_requested, true);
+}
@@ -0,0 +1,413 @@
+#include "feedback.h"
+#include "dmx_manager.h"
+#include "task_config.h"
+#include "stats_seqlock.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "feedback";
+
+#define FEEDBACK_LINE_MAX 24    // "STATE2:511#255#1\n" plus margin
+#define FEEDBACK_IDLE_WAIT_MS 1000 // Lease check while nothing is pending
+
+typedef struct
+{
+    bool used;
+    struct sockaddr_in addr;
+    int universe;
+    int channel;
+    int count;
+    uint32_t interval_ms;
+    uint32_t last_sent_ms;
+    uint32_t renewed_ms;
+    bool has_pending;
+    bool postponed;
+    uint32_t pending[DMX_CHANGE_WORDS]; // Channels to report, one bit per slot
+} subscriber_t;
+
+// Subscriber table, shared by the UDP server task and the feedback task
+static subscriber_t subscribers[FEEDBACK_MAX_SUBSCRIBERS];
+static SemaphoreHandle_t subscribers_mutex = NULL;
+
+static TaskHandle_t feedback_task_handle = NULL;
+static int feedback_socket = -1;
+
+// Statistics, counted under subscribers_mutex by whichever task holds it
+// and published before it is released
+static feedback_stats_t feedback_stats = {0};
+static feedback_stats_t feedback_stats_shared = {0};
+static stats_seqlock_t feedback_stats_lock = STATS_SEQLOCK_INIT;
+
+// Private function declarations
+static void feedback_task(void *arg);
+static void notify_feedback_task(void);
+static bool merge_range(subscriber_t *sub, const uint32_t *changed);
+static void send_pending(subscriber_t *sub);
+static void remove_subscriber(subscriber_t *sub);
+static void publish_stats(void);
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+esp_err_t feedback_init(void)
+{
+    if (feedback_task_handle != NULL)
+    {
+        return ESP_OK;
+    }
+
+    subscribers_mutex = xSemaphoreCreateMutex();
+    if (subscribers_mutex == NULL)
+    {
+        ESP_LOGE(TAG, "Failed to create subscriber mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    feedback_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (feedback_socket < 0)
+    {
+        ESP_LOGE(TAG, "Unable to create feedback socket: errno %d", errno);
+        return ESP_FAIL;
+    }
+
+    BaseType_t task_result = xTaskCreatePinnedToCore(
+        feedback_task,
+        "dmx_feedback",
+        FEEDBACK_TASK_STACK,
+        NULL,
+        FEEDBACK_TASK_PRIORITY,
+        &feedback_task_handle,
+        TASK_CORE_NETWORK);
+
+    if (task_result != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create feedback task");
+        close(feedback_socket);
+        feedback_socket = -1;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "State feedback initialized");
+    return ESP_OK;
+}
+
+esp_err_t feedback_subscribe(const struct sockaddr_in *addr, int universe, int channel, int count, int interval_ms)
+{
+    if (!addr || !dmx_is_universe_valid(universe) || count < 1 || !dmx_is_channel_valid(channel, count))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (subscribers_mutex == NULL)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (interval_ms <= 0)
+    {
+        interval_ms = FEEDBACK_DEFAULT_INTERVAL_MS;
+    }
+    interval_ms = (interval_ms < FEEDBACK_MIN_INTERVAL_MS) ? FEEDBACK_MIN_INTERVAL_MS : (interval_ms > FEEDBACK_MAX_INTERVAL_MS ? FEEDBACK_MAX_INTERVAL_MS : interval_ms);
+
+    xSemaphoreTake(subscribers_mutex, portMAX_DELAY);
+
+    // Renew a matching subscription or take a free slot
+    subscriber_t *sub = NULL;
+    subscriber_t *free_slot = NULL;
+    for (int i = 0; i < FEEDBACK_MAX_SUBSCRIBERS; ++i)
+    {
+        subscriber_t *s = &subscribers[i];
+        if (!s->used)
+        {
+            if (!free_slot)
+            {
+                free_slot = s;
+            }
+        }
+        else if (s->addr.sin_addr.s_addr == addr->sin_addr.s_addr && s->addr.sin_port == addr->sin_port &&
+                 s->universe == universe && s->channel == channel && s->count == count)
+        {
+            sub = s;
+            break;
+        }
+    }
+
+    uint32_t now = now_ms();
+    if (!sub)
+    {
+        if (!free_slot)
+        {
+            feedback_stats.rejected++;
+            publish_stats();
+            xSemaphoreGive(subscribers_mutex);
+            ESP_LOGW(TAG, "No free subscriber slot");
+            return ESP_ERR_NO_MEM;
+        }
+
+        sub = free_slot;
+        memset(sub, 0, sizeof(*sub));
+        sub->used = true;
+        sub->addr = *addr;
+        sub->universe = universe;
+        sub->channel = channel;
+        sub->count = count;
+        sub->interval_ms = (uint32_t)interval_ms;
+        feedback_stats.active_subscribers++;
+
+        // Report the whole range once so the subscriber starts from the
+        // current state. A renewal only extends the lease: it keeps the
+        // send interval running and asks for nothing, so a stream of
+        // subscribe datagrams cannot trigger a report each.
+        sub->last_sent_ms = now - sub->interval_ms;
+        merge_range(sub, NULL);
+    }
+    else
+    {
+        sub->interval_ms = (uint32_t)interval_ms;
+    }
+
+    sub->renewed_ms = now;
+    feedback_stats.subscribes++;
+
+    dmx_manager_set_change_hook(notify_feedback_task);
+    publish_stats();
+    xSemaphoreGive(subscribers_mutex);
+
+    xTaskNotifyGive(feedback_task_handle);
+    return ESP_OK;
+}
+
+void feedback_unsubscribe(const struct sockaddr_in *addr)
+{
+    if (!addr || subscribers_mutex == NULL)
+    {
+        return;
+    }
+
+    xSemaphoreTake(subscribers_mutex, portMAX_DELAY);
+    for (int i = 0; i < FEEDBACK_MAX_SUBSCRIBERS; ++i)
+    {
+        if (subscribers[i].used && subscribers[i].addr.sin_addr.s_addr == addr->sin_addr.s_addr)
+        {
+            remove_subscriber(&subscribers[i]);
+            feedback_stats.unsubscribes++;
+        }
+    }
+    publish_stats();
+    xSemaphoreGive(subscribers_mutex);
+}
+
+feedback_stats_t feedback_get_stats(void)
+{
+    feedback_stats_t stats;
+    stats_seqlock_read(&feedback_stats_lock, &stats, &feedback_stats_shared, sizeof(stats));
+    return stats;
+}
+
+// Under the mutex like every other write, so it cannot lose a count
+// another task is making; the number of subscribers is kept
+void feedback_reset_stats(void)
+{
+    if (subscribers_mutex == NULL)
+    {
+        return;
+    }
+
+    xSemaphoreTake(subscribers_mutex, portMAX_DELAY);
+    uint32_t active = feedback_stats.active_subscribers;
+    memset(&feedback_stats, 0, sizeof(feedback_stats));
+    feedback_stats.active_subscribers = active;
+    publish_stats();
+    xSemaphoreGive(subscribers_mutex);
+}
+
+// Caller holds subscribers_mutex
+static void publish_stats(void)
+{
+    stats_seqlock_publish(&feedback_stats_lock, &feedback_stats_shared, &feedback_stats, sizeof(feedback_stats));
+}
+
+// Change hook - runs in the DMX render task
+static void notify_feedback_task(void)
+{
+    xTaskNotifyGive(feedback_task_handle);
+}
+
+// Caller holds subscribers_mutex
+static void remove_subscriber(subscriber_t *sub)
+{
+    sub->used = false;
+    feedback_stats.active_subscribers--;
+
+    // Stop change tracking in the renderer while nobody listens
+    if (feedback_stats.active_subscribers == 0)
+    {
+        dmx_manager_set_change_hook(NULL);
+    }
+}
+
+// Add the changed slots within the subscribed range to pending; NULL
+// marks the whole range. Returns true if anything was added.
+static bool merge_range(subscriber_t *sub, const uint32_t *changed)
+{
+    int first = sub->channel;
+    int last = sub->channel + sub->count - 1;
+    bool any = false;
+
+    for (int w = first >> 5; w <= last >> 5; ++w)
+    {
+        uint32_t mask = 0xFFFFFFFFu;
+        if (w == first >> 5)
+        {
+            mask &= 0xFFFFFFFFu << (first & 31);
+        }
+        if (w == last >> 5)
+        {
+            mask &= 0xFFFFFFFFu >> (31 - (last & 31));
+        }
+
+        uint32_t bits = changed ? (changed[w] & mask) : mask;
+        sub->pending[w] |= bits;
+        any |= (bits != 0);
+    }
+
+    sub->has_pending |= any;
+    return any;
+}
+
+// One line per pending channel: STATE<universe>:<channel>#<value>#<fading>
+static void send_pending(subscriber_t *sub)
+{
+    char packet[FEEDBACK_MAX_PACKET_SIZE];
+    int len = 0;
+    int last = sub->channel + sub->count - 1;
+
+    for (int ch = sub->channel; ch <= last; ++ch)
+    {
+        uint32_t word = sub->pending[ch >> 5];
+        if (word == 0)
+        {
+            ch |= 31; // Skip the rest of an empty word
+            continue;
+        }
+        if (!(word & (1u << (ch & 31))))
+        {
+            continue;
+        }
+
+        if (len + FEEDBACK_LINE_MAX > (int)sizeof(packet))
+        {
+            if (sendto(feedback_socket, packet, len, 0, (struct sockaddr *)&sub->addr, sizeof(sub->addr)) < 0)
+            {
+                feedback_stats.send_errors++;
+            }
+            feedback_stats.notifications++;
+            len = 0;
+        }
+
+        len += snprintf(packet + len, sizeof(packet) - len, "STATE%d:%d#%d#%d\n",
+                        sub->universe + 1, ch, dmx_get_channel_value(sub->universe, ch),
+                        dmx_is_channel_fading(sub->universe, ch) ? 1 : 0);
+        feedback_stats.channels_reported++;
+    }
+
+    if (len > 0)
+    {
+        if (sendto(feedback_socket, packet, len, 0, (struct sockaddr *)&sub->addr, sizeof(sub->addr)) < 0)
+        {
+            feedback_stats.send_errors++;
+        }
+        feedback_stats.notifications++;
+    }
+
+    memset(sub->pending, 0, sizeof(sub->pending));
+    sub->has_pending = false;
+    sub->postponed = false;
+}
+
+// Feedback task: woken by the renderer after frames with changes. Changes
+// are merged into each subscriber's pending set, so everything that
+// happened between two notifications goes out in one datagram.
+static void feedback_task(void *arg)
+{
+    uint32_t changed[DMX_CHANGE_WORDS];
+    TickType_t wait = portMAX_DELAY;
+
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        xSemaphoreTake(subscribers_mutex, portMAX_DELAY);
+
+        int universes = dmx_manager_get_universe_count();
+        for (int u = 0; u < universes; ++u)
+        {
+            if (!dmx_manager_take_changes(u, changed))
+            {
+                continue;
+            }
+            for (int i = 0; i < FEEDBACK_MAX_SUBSCRIBERS; ++i)
+            {
+                if (subscribers[i].used && subscribers[i].universe == u)
+                {
+                    merge_range(&subscribers[i], changed);
+                }
+            }
+        }
+
+        uint32_t now = now_ms();
+        bool pending = false;
+        for (int i = 0; i < FEEDBACK_MAX_SUBSCRIBERS; ++i)
+        {
+            subscriber_t *sub = &subscribers[i];
+            if (!sub->used)
+            {
+                continue;
+            }
+
+            if (now - sub->renewed_ms > FEEDBACK_LEASE_MS)
+            {
+                remove_subscriber(sub);
+                feedback_stats.expired++;
+                continue;
+            }
+
+            if (!sub->has_pending)
+            {
+                continue;
+            }
+
+            if (now - sub->last_sent_ms >= sub->interval_ms)
+            {
+                send_pending(sub);
+                sub->last_sent_ms = now;
+            }
+            else
+            {
+                if (!sub->postponed)
+                {
+                    sub->postponed = true;
+                    feedback_stats.rate_limited++;
+                }
+                pending = true;
+            }
+        }
+
+        bool active = feedback_stats.active_subscribers > 0;
+        publish_stats();
+        xSemaphoreGive(subscribers_mutex);
+
+        // Come back for postponed sends and lease expiry
+        wait = pending ? pdMS_TO_TICKS(FEEDBACK_MIN_INTERVAL_MS)
+                       : (active ? pdMS_TO_TICKS(FEEDBACK_IDLE_WAIT_MS) : portMAX_DELAY);
+    }
+}
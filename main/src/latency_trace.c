@@ -0,0 +1,148 @@
+#include "latency_trace.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SUB_BUCKETS (1u << LATENCY_TRACE_SUB_BITS)
+
+typedef struct
+{
+    uint32_t buckets[LATENCY_TRACE_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+} histogram_t;
+
+static const char *const stage_names[LATENCY_STAGE_COUNT] = {
+    [LATENCY_STAGE_PARSE] = "parse",
+    [LATENCY_STAGE_QUEUE] = "queue",
+    [LATENCY_STAGE_RENDER] = "render",
+    [LATENCY_STAGE_SEND] = "send",
+    [LATENCY_STAGE_TOTAL] = "total"};
+
+static histogram_t histograms[LATENCY_STAGE_COUNT];
+
+// Set by latency_trace_reset, applied by the writer before its next sample
+static _Atomic bool reset_requested = false;
+
+// Log-linear buckets: values below SUB_BUCKETS get one bucket each, above
+// that every power of two is split into SUB_BUCKETS equal parts
+static int bucket_index(uint32_t us)
+{
+    if (us < SUB_BUCKETS)
+    {
+        return (int)us;
+    }
+
+    int msb = 31 - __builtin_clz(us);
+    int sub = (int)((us >> (msb - LATENCY_TRACE_SUB_BITS)) & (SUB_BUCKETS - 1));
+    int index = (msb - LATENCY_TRACE_SUB_BITS + 1) * SUB_BUCKETS + sub;
+    return index < LATENCY_TRACE_BUCKETS ? index : LATENCY_TRACE_BUCKETS - 1;
+}
+
+// Largest value that falls into the bucket; the last one takes everything
+// above the range
+static uint32_t bucket_upper(int index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return (uint32_t)index;
+    }
+    if (index == LATENCY_TRACE_BUCKETS - 1)
+    {
+        return UINT32_MAX;
+    }
+
+    int shift = index / SUB_BUCKETS - 1;
+    uint32_t low = (SUB_BUCKETS + (uint32_t)(index % SUB_BUCKETS)) << shift;
+    return low + (1u << shift) - 1;
+}
+
+void latency_trace_add(latency_stage_t stage, uint32_t us)
+{
+    if (stage >= LATENCY_STAGE_COUNT)
+    {
+        return;
+    }
+
+    if (atomic_load_explicit(&reset_requested, memory_order_relaxed) && atomic_exchange(&reset_requested, false))
+    {
+        memset(histograms, 0, sizeof(histograms));
+    }
+
+    histogram_t *h = &histograms[stage];
+    h->buckets[bucket_index(us)]++;
+    h->count++;
+    if (us > h->max_us)
+    {
+        h->max_us = us;
+    }
+}
+
+// Clock steps backwards cannot happen with esp_timer; clamp anyway so a
+// bad trace lands in the first bucket instead of the last
+static uint32_t elapsed_us(int64_t from_us, int64_t to_us)
+{
+    int64_t us = to_us - from_us;
+    if (us < 0)
+    {
+        return 0;
+    }
+    return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+void latency_trace_record(const latency_trace_t *trace)
+{
+    latency_trace_add(LATENCY_STAGE_PARSE, elapsed_us(trace->received_us, trace->queued_us));
+    latency_trace_add(LATENCY_STAGE_QUEUE, elapsed_us(trace->queued_us, trace->applied_us));
+    latency_trace_add(LATENCY_STAGE_RENDER, elapsed_us(trace->applied_us, trace->rendered_us));
+    latency_trace_add(LATENCY_STAGE_SEND, elapsed_us(trace->rendered_us, trace->sent_us));
+    latency_trace_add(LATENCY_STAGE_TOTAL, elapsed_us(trace->received_us, trace->sent_us));
+}
+
+// Value below which at least percent of the samples fall
+static uint32_t percentile(const histogram_t *h, uint32_t count, uint32_t max_us, uint32_t percent)
+{
+    uint64_t rank = ((uint64_t)count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_TRACE_BUCKETS; ++i)
+    {
+        seen += h->buckets[i];
+        if (seen >= rank)
+        {
+            uint32_t upper = bucket_upper(i);
+            return upper < max_us ? upper : max_us;
+        }
+    }
+    return max_us;
+}
+
+latency_summary_t latency_trace_summary(latency_stage_t stage)
+{
+    latency_summary_t summary = {0};
+    if (stage >= LATENCY_STAGE_COUNT || atomic_load(&reset_requested))
+    {
+        return summary;
+    }
+
+    const histogram_t *h = &histograms[stage];
+    summary.count = h->count;
+    summary.max_us = h->max_us;
+    if (summary.count > 0)
+    {
+        summary.p50_us = percentile(h, summary.count, summary.max_us, 50);
+        summary.p95_us = percentile(h, summary.count, summary.max_us, 95);
+        summary.p99_us = percentile(h, summary.count, summary.max_us, 99);
+    }
+    return summary;
+}
+
+const char *latency_stage_name(latency_stage_t stage)
+{
+    return (stage < LATENCY_STAGE_COUNT) ? stage_names[stage] : "unknown";
+}
+
+void latency_trace_reset(void)
+{
+    atomic_store(&reset_requested, true);
+}
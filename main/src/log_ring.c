@@ -0,0 +1,269 @@
+#include "log_ring.h"
+#include "task_config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "log_ring";
+
+typedef struct
+{
+    const char *fmt;
+    uint32_t timestamp_ms;
+    uint8_t module;
+    uint8_t level;
+    uintptr_t args[LOG_RING_MAX_ARGS];
+} log_record_t;
+
+static const char *const module_tags[LOG_MODULE_COUNT] = {
+    [LOG_MODULE_UDP_SERVER] = "udp_server",
+    [LOG_MODULE_UDP_PROTOCOL] = "udp_protocol",
+    [LOG_MODULE_DMX_MANAGER] = "dmx_manager"};
+
+uint8_t log_ring_levels[LOG_MODULE_COUNT];
+
+// Multi-producer ring: writers reserve a slot and copy the record under
+// log_lock (a few stores, never a wait); the flush task reads outside it.
+// A full ring drops the new record, so records already queued stay intact.
+static log_record_t records[LOG_RING_SIZE];
+static uint32_t head = 0; // Next record to flush (flush task)
+static uint32_t tail = 0; // Next free record (log_lock)
+static portMUX_TYPE log_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t flush_task_handle = NULL;
+
+// Statistics (log_lock)
+static log_ring_stats_t ring_stats = {0};
+
+static void log_flush_task(void *arg);
+
+// Integer slots are read back as 32 bits, so they must hold at least that
+_Static_assert(sizeof(uintptr_t) >= sizeof(uint32_t), "log_ring argument slots narrower than 32 bits");
+
+esp_err_t log_ring_init(bool debug)
+{
+    log_ring_set_debug(debug);
+
+    if (flush_task_handle != NULL)
+    {
+        return ESP_OK;
+    }
+
+    // Lowest application priority: formatting and UART output only run
+    // when the network tasks are idle
+    BaseType_t task_result = xTaskCreatePinnedToCore(
+        log_flush_task,
+        "log_flush",
+        LOG_FLUSH_TASK_STACK,
+        NULL,
+        LOG_FLUSH_TASK_PRIORITY,
+        &flush_task_handle,
+        TASK_CORE_NETWORK);
+
+    if (task_result != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create log flush task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Deferred logging started (%s)", debug ? "debug" : "info");
+    return ESP_OK;
+}
+
+void log_ring_set_level(log_module_t module, esp_log_level_t level)
+{
+    if (module >= LOG_MODULE_COUNT)
+    {
+        return;
+    }
+
+    log_ring_levels[module] = (uint8_t)level;
+    esp_log_level_set(module_tags[module], level);
+}
+
+void log_ring_set_debug(bool debug)
+{
+    for (int m = 0; m < LOG_MODULE_COUNT; ++m)
+    {
+        log_ring_set_level((log_module_t)m, debug ? ESP_LOG_DEBUG : ESP_LOG_INFO);
+    }
+}
+
+esp_log_level_t log_ring_get_level(log_module_t module)
+{
+    return (module < LOG_MODULE_COUNT) ? (esp_log_level_t)log_ring_levels[module] : ESP_LOG_NONE;
+}
+
+const char *log_ring_module_name(log_module_t module)
+{
+    return (module < LOG_MODULE_COUNT) ? module_tags[module] : NULL;
+}
+
+bool log_ring_find_module(const char *name, log_module_t *module)
+{
+    for (int m = 0; name && m < LOG_MODULE_COUNT; ++m)
+    {
+        if (strcmp(name, module_tags[m]) == 0)
+        {
+            *module = (log_module_t)m;
+            return true;
+        }
+    }
+    return false;
+}
+
+void log_ring_write(log_module_t module, esp_log_level_t level, const char *fmt, const uintptr_t *args)
+{
+    uint32_t now_ms = esp_log_timestamp();
+
+    portENTER_CRITICAL(&log_lock);
+    if (tail - head >= LOG_RING_SIZE)
+    {
+        ring_stats.dropped++;
+        portEXIT_CRITICAL(&log_lock);
+        return;
+    }
+
+    log_record_t *rec = &records[tail & (LOG_RING_SIZE - 1)];
+    rec->fmt = fmt;
+    rec->timestamp_ms = now_ms;
+    rec->module = (uint8_t)module;
+    rec->level = (uint8_t)level;
+    memcpy(rec->args, args, sizeof(rec->args));
+    tail++;
+    ring_stats.written++;
+    portEXIT_CRITICAL(&log_lock);
+}
+
+log_ring_stats_t log_ring_get_stats(void)
+{
+    portENTER_CRITICAL(&log_lock);
+    log_ring_stats_t stats = ring_stats;
+    portEXIT_CRITICAL(&log_lock);
+    return stats;
+}
+
+// Format a record one conversion at a time, passing each argument with
+// the type its conversion expects. Handing the raw uintptr_t slots to a
+// single snprintf only works where uintptr_t and int have the same size.
+static void format_record(char *line, size_t size, const log_record_t *rec)
+{
+    char spec[16];
+    size_t pos = 0;
+    int arg = 0;
+    const char *p = rec->fmt;
+
+    while (*p != '\0' && pos < size - 1)
+    {
+        // Literal text up to the next conversion
+        const char *pct = strchr(p, '%');
+        size_t text = pct ? (size_t)(pct - p) : strlen(p);
+        if (text > size - 1 - pos)
+        {
+            text = size - 1 - pos;
+        }
+        memcpy(line + pos, p, text);
+        pos += text;
+        if (pct == NULL)
+        {
+            break;
+        }
+
+        // Flags, width and precision are kept, length modifiers dropped
+        const char *end = pct + 1;
+        size_t len = 1;
+        spec[0] = '%';
+        while (*end != '\0' && strchr("-+ #0123456789.hlzjt", *end) != NULL)
+        {
+            if (strchr("hlzjt", *end) == NULL && len < sizeof(spec) - 2)
+            {
+                spec[len++] = *end;
+            }
+            end++;
+        }
+        if (*end == '\0')
+        {
+            break;
+        }
+        spec[len++] = *end;
+        spec[len] = '\0';
+        p = end + 1;
+
+        if (*end == '%')
+        {
+            line[pos++] = '%';
+            continue;
+        }
+        if (arg >= LOG_RING_MAX_ARGS)
+        {
+            break;
+        }
+
+        uintptr_t value = rec->args[arg++];
+        int written;
+        switch (*end)
+        {
+        case 's':
+            written = snprintf(line + pos, size - pos, spec, (const char *)value);
+            break;
+        case 'p':
+            written = snprintf(line + pos, size - pos, spec, (void *)value);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            written = snprintf(line + pos, size - pos, spec, (unsigned int)(uint32_t)value);
+            break;
+        default: // d, i, c
+            written = snprintf(line + pos, size - pos, spec, (int)(int32_t)value);
+            break;
+        }
+        if (written < 0)
+        {
+            break;
+        }
+        pos += ((size_t)written < size - pos) ? (size_t)written : size - 1 - pos;
+    }
+    line[pos] = '\0';
+}
+
+// Flush task: format and print everything queued since the last pass,
+// then report records lost to a full ring
+static void log_flush_task(void *arg)
+{
+    char line[LOG_RING_LINE_MAX];
+    uint32_t reported_drops = 0;
+
+    while (1)
+    {
+        vTaskDelay(pdMS_TO_TICKS(LOG_RING_FLUSH_MS));
+
+        portENTER_CRITICAL(&log_lock);
+        uint32_t end = tail;
+        uint32_t dropped = ring_stats.dropped;
+        portEXIT_CRITICAL(&log_lock);
+
+        while (head != end)
+        {
+            // Slots between head and tail are never written by producers
+            const log_record_t *rec = &records[head & (LOG_RING_SIZE - 1)];
+            format_record(line, sizeof(line), rec);
+            ESP_LOG_LEVEL((esp_log_level_t)rec->level, module_tags[rec->module], "(%lu) %s",
+                          (unsigned long)rec->timestamp_ms, line);
+
+            portENTER_CRITICAL(&log_lock);
+            head++;
+            ring_stats.flushed++;
+            portEXIT_CRITICAL(&log_lock);
+        }
+
+        if (dropped != reported_drops)
+        {
+            ESP_LOGW(TAG, "%lu log records dropped, ring full", (unsigned long)(dropped - reported_drops));
+            reported_drops = dropped;
+        }
+    }
+}
@@ -6,13 +6,23 @@
 #include "esp_event.h"
 #include "nvs_flash.h"
 #include "esp_netif.h"
-#include "esp_dmx.h"
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 // System modules
 #include "system_config.h"
 #include "dmx_manager.h"
 #include "udp_server.h"
 #include "udp_protocol.h"
+#include "artnet.h"
+#include "sacn.h"
+#include "dmx_stream.h"
+#include "feedback.h"
+#include "rate_limit.h"
+#include "log_ring.h"
+#include "latency_trace.h"
+#include "rest_api.h"
 
 // Component modules
 #include "my_wifi.h"
@@ -22,6 +32,8 @@
 
 static const char *TAG = "main";
 
+#define STATS_REPORT_INTERVAL_MS 10000
+
 // System initialization functions
 static esp_err_t init_system_base(void);
 static esp_err_t init_system_components(void);
@@ -106,6 +118,13 @@ static esp_err_t init_system_base(void)
     // Print system configuration
     system_config_print(system_config_get());
 
+    // Deferred logging for the packet and render paths
+    err = log_ring_init(system_config_get()->system.enable_debug_logging);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Log ring init failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
     return ESP_OK;
 }
 
@@ -140,18 +159,21 @@ static esp_err_t init_dmx_system(void)
     
     const system_config_t *config = system_config_get();
 
-    // Initialize DMX manager
-    esp_err_t err = dmx_manager_init(
-        config->hardware.dmx_tx_pin,
-        config->hardware.dmx_rx_pin,
-        config->hardware.dmx_en_pin
-    );
+    // Initialize DMX manager, one port per universe
+    const dmx_port_pins_t pins[DMX_MAX_UNIVERSES] = {
+        {config->hardware.dmx_tx_pin, config->hardware.dmx_rx_pin, config->hardware.dmx_en_pin},
+        {config->hardware.dmx2_tx_pin, config->hardware.dmx2_rx_pin, config->hardware.dmx2_en_pin}
+    };
+    esp_err_t err = dmx_manager_init(pins, config->hardware.dmx_universe_count);
     
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "DMX manager initialization failed: %s", esp_err_to_name(err));
         return err;
     }
 
+    // Frame length cap and refresh interval
+    dmx_manager_set_output(config->dmx.universe_size, config->dmx.fade_interval_ms);
+
     // Initialize UDP protocol
     err = udp_protocol_init();
     if (err != ESP_OK) {
@@ -168,13 +190,26 @@ static esp_err_t init_network_services(void)
     
     const system_config_t *config = system_config_get();
 
+    // Art-Net universes follow the configured Port-Address
+    artnet_init(artnet_port_address(config->artnet.net, config->artnet.subnet, config->artnet.universe),
+                dmx_manager_get_universe_count());
+    sacn_init(config->sacn.universe, config->sacn.enabled ? dmx_manager_get_universe_count() : 0);
+    dmx_stream_init(dmx_manager_get_universe_count());
+    rate_limit_init(config->network.source_rate_pps, config->network.source_burst);
+
     // Initialize UDP server
-    esp_err_t err = udp_server_init(config->network.udp_port);
+    esp_err_t err = udp_server_init(config->network.udp_port, config->network.max_udp_buffer_size);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "UDP server initialization failed: %s", esp_err_to_name(err));
         return err;
     }
 
+    // State feedback to subscribed controllers
+    err = feedback_init();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "State feedback unavailable: %s", esp_err_to_name(err));
+    }
+
     // Start UDP server
     err = udp_server_start();
     if (err != ESP_OK) {
@@ -182,8 +217,9 @@ static esp_err_t init_network_services(void)
         return err;
     }
 
-    // Start REST server for configuration
+    // Start REST server for configuration and runtime endpoints
     start_rest_server();
+    rest_api_register(get_rest_server());
 
     // Signal successful startup
     my_led_blink(2, 200);
@@ -195,14 +231,71 @@ static esp_err_t start_main_loop(void)
 {
     ESP_LOGI(TAG, "Starting main loop...");
 
+    // DMX output runs in the render task; this loop only reports statistics
     TickType_t last_wake_time = xTaskGetTickCount();
+    dmx_manager_stats_t last_stats = dmx_manager_get_stats();
+    rate_limit_stats_t last_limit = rate_limit_get_stats();
+    udp_server_stats_t last_server = udp_server_get_stats();
     
     while (1) {
-        // Continuous DMX sending - exact timing from working code
-        dmx_send(DMX_NUM_1);
-        
-        // Use exact 30ms timing from working version
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(30));
+        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(STATS_REPORT_INTERVAL_MS));
+
+        dmx_manager_stats_t stats = dmx_manager_get_stats();
+        uint32_t seconds = STATS_REPORT_INTERVAL_MS / 1000;
+        ESP_LOGD(TAG, "Render: %lu frames/s (%lu published, %lu idle), %lu fades started/s, %lu writes coalesced/s",
+                 (unsigned long)((stats.frames_sent - last_stats.frames_sent) / seconds),
+                 (unsigned long)((stats.frames_published - last_stats.frames_published) / seconds),
+                 (unsigned long)((stats.frames_idle - last_stats.frames_idle) / seconds),
+                 (unsigned long)((stats.fades_started - last_stats.fades_started) / seconds),
+                 (unsigned long)((stats.commands_coalesced - last_stats.commands_coalesced) / seconds));
+        ESP_LOGD(TAG, "Driver writes: %lu bytes/s in %lu spans/s",
+                 (unsigned long)((stats.bytes_written - last_stats.bytes_written) / seconds),
+                 (unsigned long)((stats.spans_written - last_stats.spans_written) / seconds));
+        ESP_LOGD(TAG, "Command-to-wire latency: avg %lu us, last %lu us, max %lu us (%lu samples)",
+                 (unsigned long)stats.latency_avg_us, (unsigned long)stats.latency_last_us,
+                 (unsigned long)stats.latency_max_us, (unsigned long)stats.latency_samples);
+        latency_summary_t total = latency_trace_summary(LATENCY_STAGE_TOTAL);
+        ESP_LOGD(TAG, "Receive-to-send: p50 %lu us, p95 %lu us, p99 %lu us, max %lu us (%lu commands)",
+                 (unsigned long)total.p50_us, (unsigned long)total.p95_us, (unsigned long)total.p99_us,
+                 (unsigned long)total.max_us, (unsigned long)total.count);
+        ESP_LOGD(TAG, "Frame jitter: avg %lu us, max %lu us (%lu frames), tick-to-render max %lu us",
+                 (unsigned long)stats.jitter_avg_us, (unsigned long)stats.jitter_max_us,
+                 (unsigned long)stats.jitter_samples, (unsigned long)stats.wake_max_us);
+        ESP_LOGD(TAG, "Render wakeups: %lu/s, frame clock stopped %lu times",
+                 (unsigned long)((stats.render_wakeups - last_stats.render_wakeups) / seconds),
+                 (unsigned long)(stats.idle_sleeps - last_stats.idle_sleeps));
+        last_stats = stats;
+
+        udp_server_stats_t server = udp_server_get_stats();
+        uint32_t datagrams = server.rx_datagrams - last_server.rx_datagrams;
+        uint32_t wakeups = server.rx_wakeups - last_server.rx_wakeups;
+        uint32_t dropped = (server.packets_shed - last_server.packets_shed) +
+                           (server.queue_overflows - last_server.queue_overflows);
+        ESP_LOGD(TAG, "Receive: %lu datagrams/s in %lu wakeups/s (%lu.%02lu per wakeup, max %lu), %lu dropped/s, %lu recv errors",
+                 (unsigned long)(datagrams / seconds), (unsigned long)(wakeups / seconds),
+                 (unsigned long)(wakeups ? datagrams / wakeups : 0),
+                 (unsigned long)(wakeups ? datagrams * 100 / wakeups % 100 : 0),
+                 (unsigned long)server.rx_batch_max, (unsigned long)(dropped / seconds),
+                 (unsigned long)server.rx_errors);
+        last_server = server;
+
+        // One summary per interval instead of a log line per dropped packet
+        rate_limit_stats_t limit = rate_limit_get_stats();
+        if (limit.frames_dropped != last_limit.frames_dropped || limit.commands_held != last_limit.commands_held) {
+            rate_limit_source_t sources[RATE_LIMIT_MAX_SOURCES + 1];
+            int count = rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1);
+            ESP_LOGW(TAG, "Rate limit: %lu frames shed/s, %lu commands held/s",
+                     (unsigned long)((limit.frames_dropped - last_limit.frames_dropped) / seconds),
+                     (unsigned long)((limit.commands_held - last_limit.commands_held) / seconds));
+            for (int i = 0; i < count; ++i) {
+                struct in_addr addr = { .s_addr = sources[i].addr };
+                ESP_LOGW(TAG, "  %s: %lu packets, %lu frames shed, %lu commands held",
+                         sources[i].addr ? inet_ntoa(addr) : "(overflow)",
+                         (unsigned long)sources[i].packets, (unsigned long)sources[i].frames_dropped,
+                         (unsigned long)sources[i].commands_held);
+            }
+        }
+        last_limit = limit;
     }
 
     return ESP_OK;
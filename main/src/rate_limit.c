@@ -0,0 +1,192 @@
+#include "rate_limit.h"
+#include "stats_seqlock.h"
+
+#include <string.h>
+#include <stdatomic.h>
+
+#define TOKEN 1000            // Bucket levels are kept in thousandths of a packet
+#define MAX_REFILL_MS 60000   // Keeps the refill product within 32 bits
+
+typedef struct
+{
+    bool used;
+    uint32_t tokens;
+    rate_limit_source_t counters;
+} source_bucket_t;
+
+// Source table (UDP server task only). The last slot is shared by all
+// senders that find the table full of active sources.
+static source_bucket_t buckets[RATE_LIMIT_MAX_SOURCES + 1];
+static uint32_t rate_pps = RATE_LIMIT_DEFAULT_PPS;
+static uint32_t capacity = RATE_LIMIT_DEFAULT_BURST * TOKEN;
+
+// Statistics (UDP server task)
+static rate_limit_stats_t limit_stats = {0};
+
+// Statistics and source counters as last published for other tasks
+typedef struct
+{
+    rate_limit_stats_t stats;
+    int source_count;
+    rate_limit_source_t sources[RATE_LIMIT_MAX_SOURCES + 1];
+} rate_limit_snapshot_t;
+
+static rate_limit_snapshot_t snapshot;        // Built by the server task
+static rate_limit_snapshot_t snapshot_shared;
+static stats_seqlock_t snapshot_lock = STATS_SEQLOCK_INIT;
+static _Atomic bool stats_reset_requested = false;
+
+void rate_limit_init(int packets_per_second, int burst)
+{
+    rate_pps = (packets_per_second < 0) ? 0 : (uint32_t)packets_per_second;
+    capacity = (uint32_t)((burst < 2) ? 2 : burst) * TOKEN; // Room for the frame reserve
+    memset(buckets, 0, sizeof(buckets));
+    memset(&limit_stats, 0, sizeof(limit_stats));
+    rate_limit_publish_stats();
+}
+
+// Slot of addr, a free or idle slot for a new source, or the overflow slot
+static source_bucket_t *find_bucket(uint32_t addr, uint32_t now_ms)
+{
+    source_bucket_t *free_slot = NULL;
+    source_bucket_t *idle_slot = NULL;
+
+    for (int i = 0; i < RATE_LIMIT_MAX_SOURCES; ++i)
+    {
+        source_bucket_t *b = &buckets[i];
+        if (!b->used)
+        {
+            if (!free_slot)
+            {
+                free_slot = b;
+            }
+        }
+        else if (b->counters.addr == addr)
+        {
+            return b;
+        }
+        else if (now_ms - b->counters.last_seen_ms > RATE_LIMIT_IDLE_MS &&
+                 (!idle_slot || b->counters.last_seen_ms < idle_slot->counters.last_seen_ms))
+        {
+            idle_slot = b;
+        }
+    }
+
+    source_bucket_t *b = free_slot ? free_slot : idle_slot;
+    if (!b)
+    {
+        b = &buckets[RATE_LIMIT_MAX_SOURCES];
+        limit_stats.sources_overflowed++;
+        if (!b->used)
+        {
+            b->used = true;
+            b->tokens = capacity;
+            b->counters.last_seen_ms = now_ms;
+        }
+        return b;
+    }
+
+    if (b == idle_slot)
+    {
+        limit_stats.sources_evicted++;
+    }
+
+    // A new source starts with a full bucket
+    memset(b, 0, sizeof(*b));
+    b->used = true;
+    b->tokens = capacity;
+    b->counters.addr = addr;
+    b->counters.last_seen_ms = now_ms;
+    return b;
+}
+
+rate_limit_verdict_t rate_limit_check(uint32_t addr, rate_limit_class_t cls, uint32_t now_ms)
+{
+    limit_stats.packets_checked++;
+    if (rate_pps == 0)
+    {
+        return RATE_LIMIT_PASS;
+    }
+
+    source_bucket_t *b = find_bucket(addr, now_ms);
+    uint32_t elapsed = now_ms - b->counters.last_seen_ms;
+    b->counters.last_seen_ms = now_ms;
+    b->counters.packets++;
+
+    // rate_pps tokens per second are rate_pps thousandths per millisecond
+    uint32_t refill = (elapsed > MAX_REFILL_MS ? MAX_REFILL_MS : elapsed) * rate_pps;
+    b->tokens = (refill >= capacity - b->tokens) ? capacity : b->tokens + refill;
+
+    // Frames keep half the bucket in reserve for commands
+    uint32_t needed = (cls == RATE_LIMIT_FRAME) ? TOKEN + capacity / 2 : TOKEN;
+    if (b->tokens >= needed)
+    {
+        b->tokens -= TOKEN;
+        return RATE_LIMIT_PASS;
+    }
+
+    if (cls == RATE_LIMIT_FRAME)
+    {
+        b->counters.frames_dropped++;
+        limit_stats.frames_dropped++;
+        return RATE_LIMIT_DROP;
+    }
+
+    b->counters.commands_held++;
+    limit_stats.commands_held++;
+    return RATE_LIMIT_HOLD;
+}
+
+// Server task only. A reset clears the counters but keeps the sources
+// and their buckets.
+void rate_limit_publish_stats(void)
+{
+    if (atomic_exchange(&stats_reset_requested, false))
+    {
+        memset(&limit_stats, 0, sizeof(limit_stats));
+        for (int i = 0; i <= RATE_LIMIT_MAX_SOURCES; ++i)
+        {
+            uint32_t addr = buckets[i].counters.addr;
+            uint32_t last_seen_ms = buckets[i].counters.last_seen_ms;
+            memset(&buckets[i].counters, 0, sizeof(buckets[i].counters));
+            buckets[i].counters.addr = addr;
+            buckets[i].counters.last_seen_ms = last_seen_ms;
+        }
+    }
+
+    snapshot.stats = limit_stats;
+    snapshot.source_count = 0;
+    for (int i = 0; i <= RATE_LIMIT_MAX_SOURCES; ++i)
+    {
+        if (buckets[i].used)
+        {
+            snapshot.sources[snapshot.source_count++] = buckets[i].counters;
+        }
+    }
+    stats_seqlock_publish(&snapshot_lock, &snapshot_shared, &snapshot, sizeof(snapshot));
+}
+
+int rate_limit_get_sources(rate_limit_source_t *out, int max)
+{
+    rate_limit_snapshot_t copy;
+    stats_seqlock_read(&snapshot_lock, &copy, &snapshot_shared, sizeof(copy));
+    int count = 0;
+    for (int i = 0; i < copy.source_count && count < max; ++i)
+    {
+        out[count++] = copy.sources[i];
+    }
+    return count;
+}
+
+rate_limit_stats_t rate_limit_get_stats(void)
+{
+    rate_limit_snapshot_t copy;
+    stats_seqlock_read(&snapshot_lock, &copy, &snapshot_shared, sizeof(copy));
+    return copy.stats;
+}
+
+// Applied by the server task at its next publish
+void rate_limit_reset_stats(void)
+{
+    atomic_store(&stats_reset_requested, true);
+}
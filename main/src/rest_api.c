@@ -0,0 +1,399 @@
+#include "rest_api.h"
+#include "dmx_manager.h"
+#include "udp_server.h"
+#include "system_config.h"
+#include "log_ring.h"
+#include "latency_trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "cJSON.h"
+
+static const char *TAG = "rest_api";
+
+// Sends a cJSON object and frees it
+static esp_err_t send_json(httpd_req_t *req, cJSON *root)
+{
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!json)
+    {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
+    free(json);
+    return ESP_OK;
+}
+
+// GET /dmx/output – current output configuration and effective timing
+static esp_err_t get_output_handler(httpd_req_t *req)
+{
+    dmx_output_info_t info = dmx_manager_get_output_info();
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root)
+    {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    cJSON_AddNumberToObject(root, "universe_size", info.max_slots);
+    cJSON_AddNumberToObject(root, "fade_interval_ms", info.frame_interval_ms);
+    cJSON_AddNumberToObject(root, "frame_slots", info.frame_slots);
+    cJSON_AddNumberToObject(root, "frame_period_us", info.frame_period_us);
+    cJSON_AddNumberToObject(root, "refresh_hz",
+                            info.frame_period_us ? 1000000.0 / info.frame_period_us : 0);
+    return send_json(req, root);
+}
+
+// POST /dmx/output – {"universe_size": n, "fade_interval_ms": n}, applied
+// immediately and persisted to NVS
+static esp_err_t post_output_handler(httpd_req_t *req)
+{
+    char buffer[256];
+    int total_len = req->content_len;
+
+    if (total_len <= 0 || total_len >= sizeof(buffer))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid length");
+        return ESP_FAIL;
+    }
+
+    int ret = httpd_req_recv(req, buffer, total_len);
+    if (ret <= 0)
+    {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    buffer[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(buffer);
+    if (!json)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+
+    const system_config_t *config = system_config_get();
+    int universe_size = config->dmx.universe_size;
+    int interval_ms = config->dmx.fade_interval_ms;
+
+    cJSON *size_item = cJSON_GetObjectItem(json, "universe_size");
+    cJSON *interval_item = cJSON_GetObjectItem(json, "fade_interval_ms");
+    if (cJSON_IsNumber(size_item))
+    {
+        universe_size = size_item->valueint;
+    }
+    if (cJSON_IsNumber(interval_item))
+    {
+        interval_ms = interval_item->valueint;
+    }
+    cJSON_Delete(json);
+
+    esp_err_t err = system_config_set_dmx_output(universe_size, interval_ms);
+    if (err == ESP_ERR_INVALID_ARG)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid DMX output config");
+        return ESP_FAIL;
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to persist DMX output config: %s", esp_err_to_name(err));
+    }
+
+    dmx_manager_set_output(universe_size, interval_ms);
+    return get_output_handler(req);
+}
+
+static const char *const level_names[] = {"none", "error", "warn", "info", "debug", "verbose"};
+
+// GET /log – debug flag, per-module levels and deferred log ring counters
+static esp_err_t get_log_handler(httpd_req_t *req)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON *modules = root ? cJSON_AddObjectToObject(root, "modules") : NULL;
+    if (!modules)
+    {
+        cJSON_Delete(root);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    cJSON_AddBoolToObject(root, "debug", system_config_get()->system.enable_debug_logging);
+    for (int m = 0; m < LOG_MODULE_COUNT; ++m)
+    {
+        esp_log_level_t level = log_ring_get_level((log_module_t)m);
+        cJSON_AddStringToObject(modules, log_ring_module_name((log_module_t)m),
+                                level <= ESP_LOG_VERBOSE ? level_names[level] : "unknown");
+    }
+
+    log_ring_stats_t stats = log_ring_get_stats();
+    cJSON_AddNumberToObject(root, "written", stats.written);
+    cJSON_AddNumberToObject(root, "flushed", stats.flushed);
+    cJSON_AddNumberToObject(root, "dropped", stats.dropped);
+    return send_json(req, root);
+}
+
+// POST /log – {"debug": bool} sets every module and is persisted to NVS;
+// {"module": "udp_server", "level": "warn"} changes one module until reboot
+static esp_err_t post_log_handler(httpd_req_t *req)
+{
+    char buffer[128];
+    int total_len = req->content_len;
+
+    if (total_len <= 0 || total_len >= sizeof(buffer))
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid length");
+        return ESP_FAIL;
+    }
+
+    int ret = httpd_req_recv(req, buffer, total_len);
+    if (ret <= 0)
+    {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    buffer[ret] = '\0';
+
+    cJSON *json = cJSON_Parse(buffer);
+    if (!json)
+    {
+        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
+        return ESP_FAIL;
+    }
+
+    cJSON *debug_item = cJSON_GetObjectItem(json, "debug");
+    cJSON *module_item = cJSON_GetObjectItem(json, "module");
+    cJSON *level_item = cJSON_GetObjectItem(json, "level");
+
+    if (cJSON_IsBool(debug_item))
+    {
+        bool debug = cJSON_IsTrue(debug_item);
+        esp_err_t err = system_config_set_debug_logging(debug);
+        if (err != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Failed to persist debug logging: %s", esp_err_to_name(err));
+        }
+        log_ring_set_debug(debug);
+    }
+
+    if (cJSON_IsString(module_item) || cJSON_IsString(level_item))
+    {
+        log_module_t module;
+        int level = -1;
+        for (int l = 0; cJSON_IsString(level_item) && l < sizeof(level_names) / sizeof(level_names[0]); ++l)
+        {
+            if (strcmp(level_item->valuestring, level_names[l]) == 0)
+            {
+                level = l;
+            }
+        }
+
+        if (!cJSON_IsString(module_item) || !log_ring_find_module(module_item->valuestring, &module) ||
+            level < 0)
+        {
+            cJSON_Delete(json);
+            httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid module or level");
+            return ESP_FAIL;
+        }
+        log_ring_set_level(module, (esp_log_level_t)level);
+    }
+
+    cJSON_Delete(json);
+    return get_log_handler(req);
+}
+
+// Adds an object with name: value pairs for each counter of an array
+static cJSON *add_counters(cJSON *parent, const char *name, const uint32_t *counters, int count,
+                           const char *(*counter_name)(int))
+{
+    cJSON *object = cJSON_AddObjectToObject(parent, name);
+    for (int i = 0; object && i < count; ++i)
+    {
+        cJSON_AddNumberToObject(object, counter_name(i), counters[i]);
+    }
+    return object;
+}
+
+static const char *cmd_type_name(int type)
+{
+    return udp_stats_cmd_name((udp_stats_cmd_t)type);
+}
+
+// Counters start at UDP_PARSE_ERR_EMPTY, UDP_PARSE_OK is never counted
+static const char *parse_error_name(int index)
+{
+    return udp_parse_error_name((udp_parse_error_t)(index + 1));
+}
+
+// GET /stats – packet, command and frame counters
+static esp_err_t get_stats_handler(httpd_req_t *req)
+{
+    udp_server_stats_t udp = udp_server_get_stats();
+    dmx_manager_stats_t dmx = dmx_manager_get_stats();
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *packets = root ? cJSON_AddObjectToObject(root, "packets") : NULL;
+    cJSON *commands = root ? cJSON_AddObjectToObject(root, "commands") : NULL;
+    cJSON *dmx_object = root ? cJSON_AddObjectToObject(root, "dmx") : NULL;
+    if (!packets || !commands || !dmx_object)
+    {
+        cJSON_Delete(root);
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    cJSON_AddNumberToObject(packets, "received", udp.packets_received);
+    cJSON_AddNumberToObject(packets, "processed", udp.packets_processed);
+    cJSON_AddNumberToObject(packets, "invalid", udp.packets_invalid);
+    cJSON_AddNumberToObject(packets, "shed", udp.packets_shed);
+    cJSON_AddNumberToObject(packets, "datagrams", udp.rx_datagrams);
+    cJSON_AddNumberToObject(packets, "bytes", udp.bytes_received);
+    cJSON_AddNumberToObject(packets, "wakeups", udp.rx_wakeups);
+    cJSON_AddNumberToObject(packets, "batch_max", udp.rx_batch_max);
+    cJSON_AddNumberToObject(packets, "recv_errors", udp.rx_errors);
+
+    cJSON_AddNumberToObject(commands, "received", udp.commands_received);
+    cJSON_AddNumberToObject(commands, "invalid", udp.commands_invalid);
+    cJSON_AddNumberToObject(commands, "executed", udp.commands_executed);
+    cJSON_AddNumberToObject(commands, "errors", udp.command_errors);
+    cJSON_AddNumberToObject(commands, "held", udp.commands_held);
+    cJSON_AddNumberToObject(commands, "superseded", udp.commands_superseded);
+    cJSON_AddNumberToObject(commands, "shed", udp.commands_shed);
+    cJSON_AddNumberToObject(commands, "queue_depth", udp.queue_depth);
+    cJSON_AddNumberToObject(commands, "queue_high_water", udp.queue_high_water);
+    cJSON_AddNumberToObject(commands, "queue_overflows", udp.queue_overflows);
+    add_counters(commands, "by_type", udp.commands_by_type, UDP_STATS_CMD_COUNT, cmd_type_name);
+    add_counters(root, "parse_errors", udp.parse_errors + 1, UDP_PARSE_ERR_COUNT - 1, parse_error_name);
+
+    cJSON_AddNumberToObject(dmx_object, "frames_sent", dmx.frames_sent);
+    cJSON_AddNumberToObject(dmx_object, "frames_published", dmx.frames_published);
+    cJSON_AddNumberToObject(dmx_object, "frames_idle", dmx.frames_idle);
+    cJSON_AddNumberToObject(dmx_object, "render_wakeups", dmx.render_wakeups);
+    cJSON_AddNumberToObject(dmx_object, "idle_sleeps", dmx.idle_sleeps);
+    cJSON_AddNumberToObject(dmx_object, "fades_started", dmx.fades_started);
+    cJSON_AddNumberToObject(dmx_object, "fades_completed", dmx.fades_completed);
+    cJSON_AddNumberToObject(dmx_object, "fades_active", dmx_get_active_fade_count());
+    cJSON_AddNumberToObject(dmx_object, "writes_coalesced", dmx.commands_coalesced);
+    cJSON_AddNumberToObject(dmx_object, "jitter_avg_us", dmx.jitter_avg_us);
+    cJSON_AddNumberToObject(dmx_object, "jitter_max_us", dmx.jitter_max_us);
+    return send_json(req, root);
+}
+
+// DELETE /stats – clear the packet, command and frame counters
+static esp_err_t delete_stats_handler(httpd_req_t *req)
+{
+    udp_server_reset_stats();
+    dmx_manager_reset_stats();
+    httpd_resp_set_status(req, "202 Accepted");
+    httpd_resp_send(req, NULL, 0);
+    return ESP_OK;
+}
+
+// GET /latency – per-stage command latency percentiles in microseconds
+static esp_err_t get_latency_handler(httpd_req_t *req)
+{
+    cJSON *root = cJSON_CreateObject();
+    if (!root)
+    {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
+    for (int s = 0; s < LATENCY_STAGE_COUNT; ++s)
+    {
+        latency_summary_t summary = latency_trace_summary((latency_stage_t)s);
+        cJSON *stage = cJSON_AddObjectToObject(root, latency_stage_name((latency_stage_t)s));
+        if (!stage)
+        {
+            cJSON_Delete(root);
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        cJSON_AddNumberToObject(stage, "count", summary.count);
+        cJSON_AddNumberToObject(stage, "p50", summary.p50_us);
+        cJSON_AddNumberToObject(stage, "p95", summary.p95_us);
+        cJSON_AddNumberToObject(stage, "p99", summary.p99_us);
+        cJSON_AddNumberToObject(stage, "max", summary.max_us);
+    }
+    return send_json(req, root);
+}
+
+// DELETE /latency – start a new measurement
+static esp_err_t delete_latency_handler(httpd_req_t *req)
+{
+    latency_trace_reset();
+    return get_latency_handler(req);
+}
+
+esp_err_t rest_api_register(httpd_handle_t server)
+{
+    if (!server)
+    {
+        ESP_LOGW(TAG, "REST server not running, runtime endpoints unavailable");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    httpd_uri_t get_output_uri = {
+        .uri = "/dmx/output",
+        .method = HTTP_GET,
+        .handler = get_output_handler,
+        .user_ctx = NULL};
+
+    httpd_uri_t post_output_uri = {
+        .uri = "/dmx/output",
+        .method = HTTP_POST,
+        .handler = post_output_handler,
+        .user_ctx = NULL};
+
+    httpd_uri_t get_log_uri = {
+        .uri = "/log",
+        .method = HTTP_GET,
+        .handler = get_log_handler,
+        .user_ctx = NULL};
+
+    httpd_uri_t post_log_uri = {
+        .uri = "/log",
+        .method = HTTP_POST,
+        .handler = post_log_handler,
+        .user_ctx = NULL};
+
+    httpd_uri_t get_latency_uri = {
+        .uri = "/latency",
+        .method = HTTP_GET,
+        .handler = get_latency_handler,
+        .user_ctx = NULL};
+
+    httpd_uri_t delete_latency_uri = {
+        .uri = "/latency",
+        .method = HTTP_DELETE,
+        .handler = delete_latency_handler,
+        .user_ctx = NULL};
+
+    httpd_uri_t get_stats_uri = {
+        .uri = "/stats",
+        .method = HTTP_GET,
+        .handler = get_stats_handler,
+        .user_ctx = NULL};
+
+    httpd_uri_t delete_stats_uri = {
+        .uri = "/stats",
+        .method = HTTP_DELETE,
+        .handler = delete_stats_handler,
+        .user_ctx = NULL};
+
+    httpd_register_uri_handler(server, &get_output_uri);
+    httpd_register_uri_handler(server, &post_output_uri);
+    httpd_register_uri_handler(server, &get_log_uri);
+    httpd_register_uri_handler(server, &post_log_uri);
+    httpd_register_uri_handler(server, &get_latency_uri);
+    httpd_register_uri_handler(server, &delete_latency_uri);
+    httpd_register_uri_handler(server, &get_stats_uri);
+    httpd_register_uri_handler(server, &delete_stats_uri);
+    ESP_LOGI(TAG, "Runtime endpoints ready on /dmx/output, /log, /latency and /stats");
+    return ESP_OK;
+}
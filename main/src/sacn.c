@@ -0,0 +1,291 @@
+#include "sacn.h"
+#include "dmx_manager.h"
+#include "stats_seqlock.h"
+
+#include <string.h>
+#include <stdatomic.h>
+
+// E1.31 layer vectors and flags
+#define SACN_VECTOR_ROOT_DATA 0x00000004
+#define SACN_VECTOR_ROOT_EXTENDED 0x00000008 // Sync and discovery, not used
+#define SACN_VECTOR_FRAMING_DATA 0x00000002
+#define SACN_VECTOR_DMP_SET_PROPERTY 0x02
+#define SACN_DMP_ADDRESS_TYPE 0xA1
+#define SACN_OPTION_PREVIEW 0x80
+#define SACN_OPTION_TERMINATED 0x40
+
+static const uint8_t ACN_PACKET_ID[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+
+typedef struct
+{
+    bool used;
+    uint8_t cid[16];
+    uint8_t priority;
+    uint8_t sequence;
+    uint32_t last_seen_ms;
+} sacn_source_t;
+
+typedef struct
+{
+    sacn_source_t sources[SACN_MAX_SOURCES];
+    int owner; // Source whose data drives the universe, -1 if none
+} sacn_universe_t;
+
+// Receiver state (UDP server task only)
+static uint16_t base_universe = 1;
+static int universe_count = 0;
+static sacn_universe_t universes[DMX_MAX_UNIVERSES];
+
+// Statistics: counted by the UDP server task, published for other tasks
+static sacn_stats_t sacn_stats = {0};
+static sacn_stats_t sacn_stats_shared = {0};
+static stats_seqlock_t sacn_stats_lock = STATS_SEQLOCK_INIT;
+static _Atomic bool stats_reset_requested = false;
+
+static uint16_t read_u16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t read_u32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Low 12 bits of a PDU flags & length field
+static uint16_t pdu_length(const uint8_t *p)
+{
+    return (uint16_t)(((p[0] & 0x0F) << 8) | p[1]);
+}
+
+void sacn_init(uint16_t base, int count)
+{
+    base_universe = base;
+    universe_count = (count < 0) ? 0 : (count > DMX_MAX_UNIVERSES ? DMX_MAX_UNIVERSES : count);
+    memset(universes, 0, sizeof(universes));
+    for (int i = 0; i < DMX_MAX_UNIVERSES; ++i)
+    {
+        universes[i].owner = -1;
+    }
+    sacn_stats.active_sources = 0;
+    sacn_publish_stats();
+}
+
+int sacn_get_universe_count(void)
+{
+    return universe_count;
+}
+
+uint16_t sacn_get_universe(int local_universe)
+{
+    return (uint16_t)(base_universe + local_universe);
+}
+
+uint32_t sacn_multicast_address(uint16_t universe)
+{
+    return (239u << 24) | (255u << 16) | ((uint32_t)(universe >> 8) << 8) | (universe & 0xFF);
+}
+
+// Root layer (0), framing layer (38), DMP layer (115), slots (125)
+sacn_result_t sacn_parse(const uint8_t *buf, size_t len, sacn_packet_t *out)
+{
+    if (!buf || !out || len < SACN_DMP_DATA_OFFSET || len > SACN_MAX_PACKET_SIZE ||
+        read_u16(&buf[0]) != 0x0010 || read_u16(&buf[2]) != 0x0000 ||
+        memcmp(&buf[4], ACN_PACKET_ID, sizeof(ACN_PACKET_ID)) != 0)
+    {
+        sacn_stats.packets_invalid++;
+        return SACN_ERR_HEADER;
+    }
+
+    uint32_t root_vector = read_u32(&buf[18]);
+    if (root_vector == SACN_VECTOR_ROOT_EXTENDED)
+    {
+        sacn_stats.packets_filtered++;
+        return SACN_IGNORED;
+    }
+
+    if (root_vector != SACN_VECTOR_ROOT_DATA ||
+        read_u32(&buf[40]) != SACN_VECTOR_FRAMING_DATA ||
+        buf[117] != SACN_VECTOR_DMP_SET_PROPERTY || buf[118] != SACN_DMP_ADDRESS_TYPE ||
+        read_u16(&buf[119]) != 0x0000 || read_u16(&buf[121]) != 0x0001)
+    {
+        sacn_stats.packets_invalid++;
+        return SACN_ERR_VECTOR;
+    }
+
+    // Property count includes the START code
+    uint16_t count = read_u16(&buf[123]);
+    if (pdu_length(&buf[16]) != len - 16 || pdu_length(&buf[38]) != len - 38 ||
+        pdu_length(&buf[115]) != len - 115 || count < 1 || (size_t)count + 125 != len)
+    {
+        sacn_stats.packets_invalid++;
+        return SACN_ERR_LENGTH;
+    }
+
+    uint16_t universe = read_u16(&buf[113]);
+    if (universe < 1 || universe > SACN_MAX_UNIVERSE || buf[108] > SACN_MAX_PRIORITY)
+    {
+        sacn_stats.packets_invalid++;
+        return SACN_ERR_HEADER;
+    }
+
+    out->cid = &buf[22];
+    out->priority = buf[108];
+    out->sequence = buf[111];
+    out->options = buf[112];
+    out->universe = universe;
+    out->length = (uint16_t)(count - 1);
+    out->data = &buf[SACN_DMP_DATA_OFFSET];
+    sacn_stats.packets_received++;
+
+    // Preview data is for visualisers, other START codes are not levels
+    if ((out->options & SACN_OPTION_PREVIEW) || buf[125] != 0x00)
+    {
+        sacn_stats.packets_filtered++;
+        return SACN_IGNORED;
+    }
+
+    return SACN_OK;
+}
+
+static void remove_source(sacn_universe_t *u, int index)
+{
+    u->sources[index].used = false;
+    if (u->owner == index)
+    {
+        u->owner = -1;
+    }
+    sacn_stats.active_sources--;
+}
+
+// Drop sources that have been silent for the data loss timeout
+static void expire_sources(sacn_universe_t *u, uint32_t now_ms)
+{
+    for (int i = 0; i < SACN_MAX_SOURCES; ++i)
+    {
+        if (u->sources[i].used && now_ms - u->sources[i].last_seen_ms > SACN_SOURCE_TIMEOUT_MS)
+        {
+            remove_source(u, i);
+            sacn_stats.sources_timed_out++;
+        }
+    }
+}
+
+// Find the source by CID or take a free slot for it, -1 when full
+static int find_source(sacn_universe_t *u, const uint8_t *cid, bool *is_new)
+{
+    *is_new = false;
+    int free_slot = -1;
+    for (int i = 0; i < SACN_MAX_SOURCES; ++i)
+    {
+        if (!u->sources[i].used)
+        {
+            if (free_slot < 0)
+            {
+                free_slot = i;
+            }
+        }
+        else if (memcmp(u->sources[i].cid, cid, sizeof(u->sources[i].cid)) == 0)
+        {
+            return i;
+        }
+    }
+
+    if (free_slot >= 0)
+    {
+        sacn_source_t *source = &u->sources[free_slot];
+        memcpy(source->cid, cid, sizeof(source->cid));
+        source->used = true;
+        source->sequence = 0;
+        source->last_seen_ms = 0;
+        sacn_stats.active_sources++;
+        *is_new = true;
+        return free_slot;
+    }
+    return -1;
+}
+
+sacn_result_t sacn_accept(const sacn_packet_t *packet, uint32_t now_ms, int *local_universe)
+{
+    int index = (int)packet->universe - (int)base_universe;
+    if (index < 0 || index >= universe_count)
+    {
+        sacn_stats.packets_filtered++;
+        return SACN_NOT_OURS;
+    }
+
+    sacn_universe_t *u = &universes[index];
+    expire_sources(u, now_ms);
+
+    bool is_new;
+    int slot = find_source(u, packet->cid, &is_new);
+    if (slot < 0)
+    {
+        sacn_stats.sources_full++;
+        return SACN_SOURCES_FULL;
+    }
+
+    sacn_source_t *source = &u->sources[slot];
+    if (!is_new)
+    {
+        // E1.31 6.7.2: discard if the sequence went back by less than 20
+        int8_t diff = (int8_t)(packet->sequence - source->sequence);
+        if (diff <= 0 && diff > -20)
+        {
+            sacn_stats.out_of_order++;
+            return SACN_OUT_OF_ORDER;
+        }
+    }
+
+    source->sequence = packet->sequence;
+    source->priority = packet->priority;
+    source->last_seen_ms = now_ms;
+
+    if (packet->options & SACN_OPTION_TERMINATED)
+    {
+        remove_source(u, slot);
+        sacn_stats.sources_terminated++;
+        return SACN_TERMINATED;
+    }
+
+    // Highest priority wins; the current owner keeps ties so two equal
+    // sources do not flicker between each other
+    if (u->owner != slot && u->owner >= 0 && packet->priority <= u->sources[u->owner].priority)
+    {
+        sacn_stats.low_priority++;
+        return SACN_LOW_PRIORITY;
+    }
+
+    u->owner = slot;
+    sacn_stats.packets_accepted++;
+    if (local_universe)
+    {
+        *local_universe = index;
+    }
+    return SACN_OK;
+}
+
+// Server task only; a reset keeps the count of tracked sources
+void sacn_publish_stats(void)
+{
+    if (atomic_exchange(&stats_reset_requested, false))
+    {
+        uint32_t active = sacn_stats.active_sources;
+        memset(&sacn_stats, 0, sizeof(sacn_stats));
+        sacn_stats.active_sources = active;
+    }
+    stats_seqlock_publish(&sacn_stats_lock, &sacn_stats_shared, &sacn_stats, sizeof(sacn_stats));
+}
+
+sacn_stats_t sacn_get_stats(void)
+{
+    sacn_stats_t stats;
+    stats_seqlock_read(&sacn_stats_lock, &stats, &sacn_stats_shared, sizeof(stats));
+    return stats;
+}
+
+// Applied by the server task at its next publish
+void sacn_reset_stats(void)
+{
+    atomic_store(&stats_reset_requested, true);
+}
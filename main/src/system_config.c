@@ -6,6 +6,8 @@
 
 static const char *TAG = "system_config";
 static const char *NVS_NAMESPACE = "system_cfg";
+static const char *NVS_CONFIG_KEY = "config";
+static const char *NVS_VERSION_KEY = "config_ver";
 
 // Default configuration
 static system_config_t default_config = {
@@ -13,9 +15,15 @@ static system_config_t default_config = {
         .dmx_tx_pin = 17,
         .dmx_rx_pin = 16,
         .dmx_en_pin = 21,
+        .dmx_universe_count = 1,
+        .dmx2_tx_pin = 25,
+        .dmx2_rx_pin = 26,
+        .dmx2_en_pin = 27,
         .debug_led_gpio = 2},
-    .network = {.udp_port = 6454, .max_udp_buffer_size = 1024},
-    .dmx = {.universe_size = 512, .fade_interval_ms = 10},
+    .network = {.udp_port = 6454, .max_udp_buffer_size = 1024, .source_rate_pps = 200, .source_burst = 100},
+    .artnet = {.net = 0, .subnet = 0, .universe = 0},
+    .sacn = {.enabled = true, .universe = 1},
+    .dmx = {.universe_size = 512, .fade_interval_ms = 23},
     .system = {.enable_debug_logging = false, .watchdog_timeout_ms = 30000}};
 
 static system_config_t current_config;
@@ -66,18 +74,41 @@ esp_err_t system_config_load_from_nvs(void)
         return err;
     }
 
-    size_t required_size = sizeof(system_config_t);
-    err = nvs_get_blob(nvs_handle, "config", &current_config, &required_size);
+    // A blob from firmware with another config layout would be read into
+    // the wrong fields; only take one of our version and size
+    uint32_t version = 0;
+    size_t stored_size = 0;
+    err = nvs_get_u32(nvs_handle, NVS_VERSION_KEY, &version);
+    if (err == ESP_OK || err == ESP_ERR_NVS_NOT_FOUND)
+    {
+        err = nvs_get_blob(nvs_handle, NVS_CONFIG_KEY, NULL, &stored_size);
+    }
+
+    system_config_t loaded;
+    if (err == ESP_OK)
+    {
+        if (version != SYSTEM_CONFIG_VERSION || stored_size != sizeof(system_config_t))
+        {
+            ESP_LOGW(TAG, "Stored config has version %lu and %u bytes, expected %d and %u, using defaults",
+                     (unsigned long)version, (unsigned)stored_size, SYSTEM_CONFIG_VERSION,
+                     (unsigned)sizeof(system_config_t));
+            nvs_close(nvs_handle);
+            memcpy(&current_config, &default_config, sizeof(system_config_t));
+            return ESP_ERR_INVALID_VERSION;
+        }
+        err = nvs_get_blob(nvs_handle, NVS_CONFIG_KEY, &loaded, &stored_size);
+    }
     nvs_close(nvs_handle);
 
     if (err == ESP_OK)
     {
-        if (!system_config_validate(&current_config))
+        if (!system_config_validate(&loaded))
         {
             ESP_LOGW(TAG, "Loaded config is invalid, using defaults");
             memcpy(&current_config, &default_config, sizeof(system_config_t));
             return ESP_ERR_INVALID_CRC;
         }
+        memcpy(&current_config, &loaded, sizeof(system_config_t));
         ESP_LOGI(TAG, "Configuration loaded from NVS");
     }
     else
@@ -104,7 +135,11 @@ esp_err_t system_config_save_to_nvs(void)
         return err;
     }
 
-    err = nvs_set_blob(nvs_handle, "config", &current_config, sizeof(system_config_t));
+    err = nvs_set_blob(nvs_handle, NVS_CONFIG_KEY, &current_config, sizeof(system_config_t));
+    if (err == ESP_OK)
+    {
+        err = nvs_set_u32(nvs_handle, NVS_VERSION_KEY, SYSTEM_CONFIG_VERSION);
+    }
     if (err == ESP_OK)
     {
         err = nvs_commit(nvs_handle);
@@ -125,6 +160,27 @@ esp_err_t system_config_load_defaults(void)
     return ESP_OK;
 }
 
+esp_err_t system_config_set_dmx_output(int universe_size, int fade_interval_ms)
+{
+    system_config_t candidate = current_config;
+    candidate.dmx.universe_size = universe_size;
+    candidate.dmx.fade_interval_ms = fade_interval_ms;
+
+    if (!system_config_validate(&candidate))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(&current_config, &candidate, sizeof(system_config_t));
+    return system_config_save_to_nvs();
+}
+
+esp_err_t system_config_set_debug_logging(bool enabled)
+{
+    current_config.system.enable_debug_logging = enabled;
+    return system_config_save_to_nvs();
+}
+
 bool system_config_validate(const system_config_t *config)
 {
     if (!config)
@@ -142,6 +198,21 @@ bool system_config_validate(const system_config_t *config)
         return false;
     }
 
+    if (config->hardware.dmx_universe_count < 1 || config->hardware.dmx_universe_count > 2)
+    {
+        ESP_LOGW(TAG, "Invalid DMX universe count: %d", config->hardware.dmx_universe_count);
+        return false;
+    }
+
+    if (config->hardware.dmx_universe_count == 2 &&
+        (config->hardware.dmx2_tx_pin < 0 || config->hardware.dmx2_tx_pin > 39 ||
+         config->hardware.dmx2_rx_pin < 0 || config->hardware.dmx2_rx_pin > 39 ||
+         config->hardware.dmx2_en_pin < 0 || config->hardware.dmx2_en_pin > 39))
+    {
+        ESP_LOGW(TAG, "Invalid GPIO pin configuration for second universe");
+        return false;
+    }
+
     // Validate network settings
     if (config->network.udp_port == 0)
     {
@@ -155,6 +226,31 @@ bool system_config_validate(const system_config_t *config)
         return false;
     }
 
+    if (config->network.source_rate_pps > 10000 ||
+        config->network.source_burst < 2 || config->network.source_burst > 1000)
+    {
+        ESP_LOGW(TAG, "Invalid source rate limit: %d pps, burst %d",
+                 config->network.source_rate_pps, config->network.source_burst);
+        return false;
+    }
+
+    // Validate Art-Net Port-Address
+    if (config->artnet.net < 0 || config->artnet.net > 127 ||
+        config->artnet.subnet < 0 || config->artnet.subnet > 15 ||
+        config->artnet.universe < 0 || config->artnet.universe > 15)
+    {
+        ESP_LOGW(TAG, "Invalid Art-Net address: %d:%d:%d",
+                 config->artnet.net, config->artnet.subnet, config->artnet.universe);
+        return false;
+    }
+
+    // Validate sACN universe (leave room for the second universe)
+    if (config->sacn.universe < 1 || config->sacn.universe > 63998)
+    {
+        ESP_LOGW(TAG, "Invalid sACN universe: %d", config->sacn.universe);
+        return false;
+    }
+
     // Validate DMX settings
     if (config->dmx.universe_size < 1 || config->dmx.universe_size > 512)
     {
@@ -191,15 +287,39 @@ void system_config_print(const system_config_t *config)
     ESP_LOGI(TAG, "  DMX TX Pin: %d", config->hardware.dmx_tx_pin);
     ESP_LOGI(TAG, "  DMX RX Pin: %d", config->hardware.dmx_rx_pin);
     ESP_LOGI(TAG, "  DMX EN Pin: %d", config->hardware.dmx_en_pin);
+    ESP_LOGI(TAG, "  DMX Universes: %d", config->hardware.dmx_universe_count);
+    if (config->hardware.dmx_universe_count > 1)
+    {
+        ESP_LOGI(TAG, "  DMX2 TX Pin: %d", config->hardware.dmx2_tx_pin);
+        ESP_LOGI(TAG, "  DMX2 RX Pin: %d", config->hardware.dmx2_rx_pin);
+        ESP_LOGI(TAG, "  DMX2 EN Pin: %d", config->hardware.dmx2_en_pin);
+    }
     ESP_LOGI(TAG, "  Debug LED GPIO: %d", config->hardware.debug_led_gpio);
 
     ESP_LOGI(TAG, "Network:");
     ESP_LOGI(TAG, "  UDP Port: %d", config->network.udp_port);
     ESP_LOGI(TAG, "  Max UDP Buffer: %d", config->network.max_udp_buffer_size);
+    if (config->network.source_rate_pps > 0)
+    {
+        ESP_LOGI(TAG, "  Source Rate Limit: %d pps, burst %d",
+                 config->network.source_rate_pps, config->network.source_burst);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "  Source Rate Limit: off");
+    }
+
+    ESP_LOGI(TAG, "Art-Net:");
+    ESP_LOGI(TAG, "  Net/SubNet/Universe: %d:%d:%d",
+             config->artnet.net, config->artnet.subnet, config->artnet.universe);
+
+    ESP_LOGI(TAG, "sACN:");
+    ESP_LOGI(TAG, "  Enabled: %s", config->sacn.enabled ? "Yes" : "No");
+    ESP_LOGI(TAG, "  Universe: %d", config->sacn.universe);
 
     ESP_LOGI(TAG, "DMX:");
     ESP_LOGI(TAG, "  Universe Size: %d", config->dmx.universe_size);
-    ESP_LOGI(TAG, "  Fade Interval: %d ms", config->dmx.fade_interval_ms);
+    ESP_LOGI(TAG, "  Frame Interval: %d ms", config->dmx.fade_interval_ms);
 
     ESP_LOGI(TAG, "System:");
     ESP_LOGI(TAG, "  Debug Logging: %s", config->system.enable_debug_logging ? "Yes" : "No");
@@ -1,8 +1,8 @@
 #include "udp_protocol.h"
 #include "dmx_manager.h"
+#include "log_ring.h"
 
 #include <string.h>
-#include <stdlib.h>
 #include "esp_log.h"
 
 static const char *TAG = "udp_protocol";
@@ -42,182 +42,639 @@ bool udp_is_valid_command_format(const char *cmd)
             type == 'W' || type == 'L');
 }
 
-// Parse UDP command
-udp_parsed_command_t udp_parse_command(const char *cmd)
+// Scan an unsigned decimal number, rejecting values above INT32_MAX
+static udp_parse_error_t scan_number(const char **pos, const char *end, int *out, udp_parse_error_t missing)
 {
-    udp_parsed_command_t result = {0};
+    const char *p = *pos;
+    uint32_t value = 0;
 
-    if (!udp_is_valid_command_format(cmd))
+    if (p == end || *p < '0' || *p > '9')
     {
-        ESP_LOGW(TAG, "Invalid command format: %s", cmd ? cmd : "NULL");
-        return result;
+        return missing;
     }
 
-    char *copy = strdup(cmd);
-    if (!copy)
+    while (p < end && *p >= '0' && *p <= '9')
     {
-        ESP_LOGE(TAG, "Memory allocation failed");
-        return result;
+        uint32_t digit = (uint32_t)(*p - '0');
+        if (value > (INT32_MAX - digit) / 10)
+        {
+            return UDP_PARSE_ERR_OVERFLOW;
+        }
+        value = value * 10 + digit;
+        p++;
     }
 
-    char *type_str = strtok(copy + 3, "#");
-    char *value_str = strtok(NULL, "#");
-    char *speed_str = strtok(NULL, "#");
+    *out = (int)value;
+    *pos = p;
+    return UDP_PARSE_OK;
+}
 
-    if (!type_str || !value_str)
+static uint8_t clamp_level(int value)
+{
+    return (uint8_t)(value > 255 ? 255 : value);
+}
+
+// Split the ASCII value into levels and set the channel count; values are
+// never negative here
+static udp_parse_error_t decode_value(udp_parsed_command_t *out)
+{
+    int value = out->value;
+
+    switch (out->type)
     {
-        ESP_LOGW(TAG, "Missing required arguments in command: %s", cmd);
-        free(copy);
-        return result;
+    case UDP_CMD_RGB:
+        if (value > 999999999)
+        {
+            return UDP_PARSE_ERR_VALUE;
+        }
+        out->levels[0] = clamp_level(value % 1000);
+        out->levels[1] = clamp_level((value / 1000) % 1000);
+        out->levels[2] = clamp_level((value / 1000000) % 1000);
+        out->count = 3;
+        break;
+
+    case UDP_CMD_TUNABLE_WHITE:
+        out->levels[0] = clamp_level((value / 1000) % 1000);
+        out->levels[1] = clamp_level(value % 1000);
+        out->count = 2;
+        break;
+
+    case UDP_CMD_LIGHT_CT:
+    {
+        // 2BBBTTTT: brightness (0-100%) and color temperature (K)
+        if (value < 200000000 || value > 209999999)
+        {
+            return UDP_PARSE_ERR_VALUE;
+        }
+        int brightness = (value / 10000) % 1000;
+        out->brightness = (uint8_t)(brightness > 100 ? 100 : brightness);
+        out->color_temp = (uint16_t)(value % 10000);
+        out->count = 2;
+        break;
     }
 
-    result.type = (udp_command_type_t)type_str[0];
-    result.channel = atoi(type_str + 1);
-    result.value = atoi(value_str);
-    result.speed = speed_str ? atoi(speed_str) : 255;
-    result.valid = true;
+    case UDP_CMD_PERCENTAGE:
+        out->levels[0] = clamp_level((value > 100 ? 100 : value) * 255 / 100);
+        out->count = 1;
+        break;
+
+    default:
+        out->levels[0] = clamp_level(value);
+        out->count = 1;
+        break;
+    }
 
-    free(copy);
-    return result;
+    return UDP_PARSE_OK;
 }
 
-// Execute parsed command
-dmx_command_result_t udp_execute_command(const udp_parsed_command_t *cmd)
+// Parse UDP command: DMX<type>[<universe>:]<channel>#<value>[#<speed>]
+udp_parse_error_t udp_parse_command(const char *buf, size_t len, udp_parsed_command_t *out)
 {
-    if (!cmd || !cmd->valid)
+    if (!out)
     {
-        ESP_LOGW(TAG, "Invalid command structure");
-        return DMX_CMD_ERROR_INVALID_VALUE;
+        return UDP_PARSE_ERR_EMPTY;
     }
+    memset(out, 0, sizeof(*out));
 
-    int fade_ms = udp_speed_to_milliseconds(cmd->speed);
-    dmx_command_result_t result = DMX_CMD_SUCCESS;
+    if (!buf)
+    {
+        return UDP_PARSE_ERR_EMPTY;
+    }
 
-    // Validate channel ranges for multi-channel commands
-    switch (cmd->type)
+    const char *p = buf;
+    const char *end = buf + len;
+
+    // Tolerate line endings and a terminator sent along with the command
+    while (end > p && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\0'))
     {
-    case UDP_CMD_RGB:
-        if (!dmx_is_channel_valid(cmd->channel, 3))
+        end--;
+    }
+
+    if (p == end)
+    {
+        return UDP_PARSE_ERR_EMPTY;
+    }
+
+    if (end - p < 4 || p[0] != 'D' || p[1] != 'M' || p[2] != 'X')
+    {
+        return UDP_PARSE_ERR_PREFIX;
+    }
+
+    char type = p[3];
+    if (type != UDP_CMD_CHANNEL && type != UDP_CMD_PERCENTAGE && type != UDP_CMD_RGB &&
+        type != UDP_CMD_TUNABLE_WHITE && type != UDP_CMD_LIGHT_CT)
+    {
+        return UDP_PARSE_ERR_TYPE;
+    }
+    p += 4;
+
+    // Optional universe prefix: <universe>:<channel>, universes count from 1
+    int number;
+    udp_parse_error_t err = scan_number(&p, end, &number, UDP_PARSE_ERR_CHANNEL);
+    if (err != UDP_PARSE_OK)
+    {
+        return err;
+    }
+
+    if (p < end && *p == ':')
+    {
+        if (number < 1)
         {
-            ESP_LOGW(TAG, "Invalid channel for RGB command: %d", cmd->channel);
-            return DMX_CMD_ERROR_INVALID_CHANNEL;
+            return UDP_PARSE_ERR_UNIVERSE;
         }
-        break;
+        out->universe = number - 1;
+        p++;
 
-    case UDP_CMD_TUNABLE_WHITE:
-    case UDP_CMD_LIGHT_CT:
-        if (!dmx_is_channel_valid(cmd->channel, 2))
+        err = scan_number(&p, end, &number, UDP_PARSE_ERR_CHANNEL);
+        if (err != UDP_PARSE_OK)
         {
-            ESP_LOGW(TAG, "Invalid channel for %c command: %d",
-                     (char)cmd->type, cmd->channel);
-            return DMX_CMD_ERROR_INVALID_CHANNEL;
+            return err;
         }
-        break;
+    }
+    out->channel = number;
 
-    case UDP_CMD_CHANNEL:
-    case UDP_CMD_PERCENTAGE:
-        if (!dmx_is_channel_valid(cmd->channel, 1))
+    if (p == end || *p != '#')
+    {
+        return UDP_PARSE_ERR_VALUE;
+    }
+    p++;
+
+    err = scan_number(&p, end, &out->value, UDP_PARSE_ERR_VALUE);
+    if (err != UDP_PARSE_OK)
+    {
+        return err;
+    }
+
+    // Speed is optional, an empty field means "no fade" like a missing one
+    int speed = 255;
+    if (p < end && *p == '#')
+    {
+        p++;
+        if (p < end)
         {
-            ESP_LOGW(TAG, "Invalid channel for %c command: %d",
-                     (char)cmd->type, cmd->channel);
-            return DMX_CMD_ERROR_INVALID_CHANNEL;
+            err = scan_number(&p, end, &speed, UDP_PARSE_ERR_SPEED);
+            if (err != UDP_PARSE_OK)
+            {
+                return err;
+            }
         }
-        break;
     }
 
-    switch (cmd->type)
+    if (p != end)
     {
-    case UDP_CMD_RGB:
+        return UDP_PARSE_ERR_TRAILING;
+    }
+
+    out->type = (udp_command_type_t)type;
+    err = decode_value(out);
+    if (err != UDP_PARSE_OK)
+    {
+        return err;
+    }
+
+    out->fade_ms = udp_speed_to_milliseconds(speed);
+    out->valid = true;
+    return UDP_PARSE_OK;
+}
+
+bool udp_is_subscription(const char *buf, size_t len)
+{
+    return buf && ((len >= 3 && memcmp(buf, "SUB", 3) == 0) ||
+                   (len >= 5 && memcmp(buf, "UNSUB", 5) == 0));
+}
+
+// Parse SUB[<universe>:]<channel>#<count>[#<interval_ms>] or UNSUB
+udp_parse_error_t udp_parse_subscription(const char *buf, size_t len, udp_subscription_t *out)
+{
+    if (!buf || !out)
+    {
+        return UDP_PARSE_ERR_EMPTY;
+    }
+    memset(out, 0, sizeof(*out));
+
+    const char *p = buf;
+    const char *end = buf + len;
+    while (end > p && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\0'))
+    {
+        end--;
+    }
+
+    if (end - p == 5 && memcmp(p, "UNSUB", 5) == 0)
+    {
+        return UDP_PARSE_OK;
+    }
+    if (end - p < 3 || memcmp(p, "SUB", 3) != 0)
+    {
+        return UDP_PARSE_ERR_PREFIX;
+    }
+    p += 3;
+    out->subscribe = true;
+
+    int number;
+    udp_parse_error_t err = scan_number(&p, end, &number, UDP_PARSE_ERR_CHANNEL);
+    if (err != UDP_PARSE_OK)
+    {
+        return err;
+    }
+
+    if (p < end && *p == ':')
     {
-        // Validate RGB value range
-        if (cmd->value < 0 || cmd->value > 999999999)
+        if (number < 1)
         {
-            ESP_LOGW(TAG, "RGB value out of range: %d", cmd->value);
-            return DMX_CMD_ERROR_INVALID_VALUE;
+            return UDP_PARSE_ERR_UNIVERSE;
         }
+        out->universe = number - 1;
+        p++;
 
-        // Extract RGB components
-        uint8_t r = (cmd->value % 1000) > 255 ? 255 : (cmd->value % 1000);
-        uint8_t g = ((cmd->value / 1000) % 1000) > 255 ? 255 : ((cmd->value / 1000) % 1000);
-        uint8_t b = ((cmd->value / 1000000) % 1000) > 255 ? 255 : ((cmd->value / 1000000) % 1000);
+        err = scan_number(&p, end, &number, UDP_PARSE_ERR_CHANNEL);
+        if (err != UDP_PARSE_OK)
+        {
+            return err;
+        }
+    }
+    out->channel = number;
 
-        result = dmx_set_rgb(cmd->channel, r, g, b, fade_ms);
+    if (p == end || *p != '#')
+    {
+        return UDP_PARSE_ERR_VALUE;
+    }
+    p++;
+    err = scan_number(&p, end, &out->count, UDP_PARSE_ERR_VALUE);
+    if (err != UDP_PARSE_OK)
+    {
+        return err;
+    }
 
-        if (result == DMX_CMD_SUCCESS)
+    // Optional interval
+    if (p < end && *p == '#')
+    {
+        p++;
+        err = scan_number(&p, end, &out->interval_ms, UDP_PARSE_ERR_VALUE);
+        if (err != UDP_PARSE_OK)
         {
-            ESP_LOGI(TAG, "RGB %d: R=%d G=%d B=%d with fade %d ms",
-                     cmd->channel, r, g, b, fade_ms);
+            return err;
         }
-        break;
     }
 
-    case UDP_CMD_TUNABLE_WHITE:
+    if (p != end)
+    {
+        return UDP_PARSE_ERR_TRAILING;
+    }
+
+    if (out->count < 1 || !dmx_is_channel_valid(out->channel, out->count))
+    {
+        return UDP_PARSE_ERR_CHANNEL;
+    }
+    return UDP_PARSE_OK;
+}
+
+const char *udp_parse_error_name(udp_parse_error_t err)
+{
+    switch (err)
     {
-        uint8_t ww = ((cmd->value / 1000) % 1000) > 255 ? 255 : ((cmd->value / 1000) % 1000 < 0 ? 0 : (cmd->value / 1000) % 1000);
-        uint8_t cw = (cmd->value % 1000) > 255 ? 255 : (cmd->value % 1000 < 0 ? 0 : cmd->value % 1000);
+    case UDP_PARSE_OK:
+        return "ok";
+    case UDP_PARSE_ERR_EMPTY:
+        return "empty";
+    case UDP_PARSE_ERR_PREFIX:
+        return "prefix";
+    case UDP_PARSE_ERR_TYPE:
+        return "type";
+    case UDP_PARSE_ERR_UNIVERSE:
+        return "universe";
+    case UDP_PARSE_ERR_CHANNEL:
+        return "channel";
+    case UDP_PARSE_ERR_VALUE:
+        return "value";
+    case UDP_PARSE_ERR_SPEED:
+        return "speed";
+    case UDP_PARSE_ERR_OVERFLOW:
+        return "overflow";
+    case UDP_PARSE_ERR_TRAILING:
+        return "trailing";
+    case UDP_PARSE_ERR_TOO_MANY:
+        return "too_many";
+    case UDP_PARSE_ERR_VERSION:
+        return "version";
+    case UDP_PARSE_ERR_LENGTH:
+        return "length";
+    default:
+        return "unknown";
+    }
+}
 
-        result = dmx_set_tunable_white(cmd->channel, ww, cw, fade_ms);
+// Count a rejected command, remembering the first reason
+static void reject_command(udp_batch_result_t *result, udp_parse_error_t err)
+{
+    if (result->rejected == 0)
+    {
+        result->first_error = err;
+    }
+    result->rejected++;
+    result->errors[err]++;
+}
 
-        if (result == DMX_CMD_SUCCESS)
+// Parse a datagram that carries one or more commands
+udp_batch_result_t udp_parse_batch(const char *buf, size_t len, udp_parsed_command_t *out, int max_commands)
+{
+    udp_batch_result_t result = {.first_error = UDP_PARSE_OK};
+    if (!buf || !out)
+    {
+        reject_command(&result, UDP_PARSE_ERR_EMPTY);
+        return result;
+    }
+
+    const char *end = buf + len;
+    const char *segment = buf;
+
+    while (segment < end)
+    {
+        // Find the end of this command
+        const char *p = segment;
+        while (p < end && *p != '\n' && *p != ';')
+        {
+            p++;
+        }
+
+        // Skip blank segments (trailing separator, CRLF line endings)
+        const char *q = segment;
+        while (q < p && (*q == '\r' || *q == ' ' || *q == '\0'))
+        {
+            q++;
+        }
+
+        if (q < p)
         {
-            ESP_LOGI(TAG, "Tunable White %d: WW=%d CW=%d with fade %d ms",
-                     cmd->channel, ww, cw, fade_ms);
+            udp_parse_error_t err = UDP_PARSE_ERR_TOO_MANY;
+            if (result.count < max_commands)
+            {
+                err = udp_parse_command(q, (size_t)(p - q), &out[result.count]);
+            }
+
+            if (err == UDP_PARSE_OK)
+            {
+                result.count++;
+            }
+            else
+            {
+                reject_command(&result, err);
+            }
         }
+
+        segment = p + 1;
+    }
+
+    if (result.count == 0 && result.rejected == 0)
+    {
+        reject_command(&result, UDP_PARSE_ERR_EMPTY);
+    }
+
+    return result;
+}
+
+static uint16_t read_u16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+bool udp_is_binary_packet(const uint8_t *buf, size_t len)
+{
+    return buf && len > 0 && buf[0] == UDP_BINARY_MAGIC;
+}
+
+// Parse one binary record at p, returns the bytes it used or 0 on error
+static size_t parse_binary_record(const uint8_t *p, size_t avail, udp_parsed_command_t *cmd, udp_parse_error_t *err)
+{
+    memset(cmd, 0, sizeof(*cmd));
+    if (avail < UDP_BINARY_RECORD_SIZE)
+    {
+        *err = UDP_PARSE_ERR_LENGTH;
+        return 0;
+    }
+
+    cmd->universe = p[1];
+    cmd->channel = read_u16(&p[2]);
+    cmd->count = read_u16(&p[4]);
+    cmd->fade_ms = read_u16(&p[6]);
+
+    size_t payload_len;
+    switch (p[0])
+    {
+    case UDP_BIN_OP_SET:
+        cmd->type = UDP_CMD_SET_RANGE;
+        payload_len = (size_t)cmd->count;
+        break;
+    case UDP_BIN_OP_FILL:
+        cmd->type = UDP_CMD_FILL;
+        payload_len = 1;
+        break;
+    case UDP_BIN_OP_LIGHT_CT:
+        cmd->type = UDP_CMD_LIGHT_CT;
+        payload_len = 3;
         break;
+    default:
+        *err = UDP_PARSE_ERR_TYPE;
+        return 0;
     }
 
-    case UDP_CMD_LIGHT_CT:
+    if (cmd->count < 1 || cmd->count >= DMX_UNIVERSE_SIZE ||
+        (cmd->type == UDP_CMD_LIGHT_CT && cmd->count != 2) ||
+        avail - UDP_BINARY_RECORD_SIZE < payload_len)
+    {
+        *err = UDP_PARSE_ERR_LENGTH;
+        return 0;
+    }
+
+    const uint8_t *payload = p + UDP_BINARY_RECORD_SIZE;
+    if (cmd->type == UDP_CMD_SET_RANGE)
+    {
+        cmd->payload = payload;
+    }
+    else if (cmd->type == UDP_CMD_FILL)
+    {
+        cmd->levels[0] = payload[0];
+    }
+    else
+    {
+        cmd->brightness = payload[0] > 100 ? 100 : payload[0];
+        cmd->color_temp = read_u16(&payload[1]);
+    }
+
+    cmd->valid = true;
+    return UDP_BINARY_RECORD_SIZE + payload_len;
+}
+
+// Parse a binary datagram; all records or none
+udp_batch_result_t udp_parse_binary(const uint8_t *buf, size_t len, udp_parsed_command_t *out, int max_commands)
+{
+    udp_batch_result_t result = {.first_error = UDP_PARSE_OK};
+    udp_parse_error_t err = UDP_PARSE_OK;
+
+    if (!udp_is_binary_packet(buf, len) || !out || len <= UDP_BINARY_HEADER_SIZE)
+    {
+        err = UDP_PARSE_ERR_EMPTY;
+    }
+    else if (buf[1] != UDP_BINARY_VERSION)
     {
-        // Validate L command value range
-        if (cmd->value < 200000000 || cmd->value > 209999999)
+        err = UDP_PARSE_ERR_VERSION;
+    }
+
+    size_t offset = UDP_BINARY_HEADER_SIZE;
+    while (err == UDP_PARSE_OK && offset < len)
+    {
+        if (result.count >= max_commands)
+        {
+            err = UDP_PARSE_ERR_TOO_MANY;
+            break;
+        }
+
+        size_t used = parse_binary_record(buf + offset, len - offset, &out[result.count], &err);
+        if (used == 0)
         {
-            ESP_LOGW(TAG, "Invalid L command value: %d", cmd->value);
-            return DMX_CMD_ERROR_INVALID_VALUE;
+            break;
         }
+        offset += used;
+        result.count++;
+    }
 
-        // Extract brightness (0-100%) and color temperature (K)
-        int brightness = (cmd->value / 10000) % 1000;
-        int color_temp = cmd->value % 10000;
+    if (err != UDP_PARSE_OK)
+    {
+        result.count = 0;
+        reject_command(&result, err);
+    }
 
-        // Clamp brightness to valid range
-        brightness = (brightness < 0) ? 0 : (brightness > 100 ? 100 : brightness);
+    return result;
+}
 
-        result = dmx_set_light_ct(cmd->channel, brightness, color_temp, fade_ms);
-        break;
+bool udp_is_span_packet(const uint8_t *buf, size_t len)
+{
+    return buf && len > 0 && buf[0] == UDP_SPAN_MAGIC;
+}
+
+// Parse a raw span packet without copying
+udp_parse_error_t udp_parse_span(const uint8_t *buf, size_t len, udp_span_t *out)
+{
+    if (!udp_is_span_packet(buf, len) || !out)
+    {
+        return UDP_PARSE_ERR_EMPTY;
     }
 
-    case UDP_CMD_PERCENTAGE:
+    if (len <= UDP_SPAN_HEADER_SIZE || len - UDP_SPAN_HEADER_SIZE >= DMX_UNIVERSE_SIZE)
+    {
+        return UDP_PARSE_ERR_LENGTH;
+    }
+
+    out->universe = buf[1];
+    out->start = read_u16(&buf[2]);
+    out->fade_ms = read_u16(&buf[4]);
+    out->length = (int)(len - UDP_SPAN_HEADER_SIZE);
+    out->data = buf + UDP_SPAN_HEADER_SIZE;
+
+    if (!dmx_is_channel_valid(out->start, out->length))
+    {
+        return UDP_PARSE_ERR_CHANNEL;
+    }
+
+    return UDP_PARSE_OK;
+}
+
+// Fill source for UDP_CMD_FILL (render task only)
+static uint8_t fill_levels[DMX_UNIVERSE_SIZE];
+
+// Execute parsed command
+dmx_command_result_t udp_execute_command(const udp_parsed_command_t *cmd)
+{
+    if (!cmd || !cmd->valid)
+    {
+        LOG_RING_W(LOG_MODULE_UDP_PROTOCOL, "Invalid command structure");
+        return DMX_CMD_ERROR_INVALID_VALUE;
+    }
+
+    if (!dmx_is_universe_valid(cmd->universe))
+    {
+        LOG_RING_W(LOG_MODULE_UDP_PROTOCOL, "Invalid universe: %d", cmd->universe + 1);
+        return DMX_CMD_ERROR_INVALID_UNIVERSE;
+    }
+
+    // Every command covers count channels starting at channel
+    if (!dmx_is_channel_valid(cmd->channel, cmd->count))
+    {
+        LOG_RING_W(LOG_MODULE_UDP_PROTOCOL, "Invalid channel for %c command: %d",
+                   (char)cmd->type, cmd->channel);
+        return DMX_CMD_ERROR_INVALID_CHANNEL;
+    }
+
+    int fade_ms = cmd->fade_ms;
+    dmx_command_result_t result = DMX_CMD_SUCCESS;
+
+    switch (cmd->type)
     {
-        // Convert percentage to 0-255 range
-        int dmx_value = (cmd->value * 255) / 100;
-        dmx_value = (dmx_value < 0) ? 0 : (dmx_value > 255 ? 255 : dmx_value);
+    case UDP_CMD_RGB:
+        result = dmx_set_rgb(cmd->universe, cmd->channel, cmd->levels[0], cmd->levels[1], cmd->levels[2], fade_ms);
+
+        if (result == DMX_CMD_SUCCESS)
+        {
+            LOG_RING_I(LOG_MODULE_UDP_PROTOCOL, "RGB %d: R=%d G=%d B=%d with fade %d ms",
+                       cmd->channel, cmd->levels[0], cmd->levels[1], cmd->levels[2], fade_ms);
+        }
+        break;
 
-        result = dmx_set_channel(cmd->channel, dmx_value, fade_ms);
+    case UDP_CMD_TUNABLE_WHITE:
+        result = dmx_set_tunable_white(cmd->universe, cmd->channel, cmd->levels[0], cmd->levels[1], fade_ms);
 
         if (result == DMX_CMD_SUCCESS)
         {
-            ESP_LOGI(TAG, "Channel %d set to %d%% (%d/255)",
-                     cmd->channel, cmd->value, dmx_value);
+            LOG_RING_I(LOG_MODULE_UDP_PROTOCOL, "Tunable White %d: WW=%d CW=%d with fade %d ms",
+                       cmd->channel, cmd->levels[0], cmd->levels[1], fade_ms);
+        }
+        break;
+
+    case UDP_CMD_LIGHT_CT:
+        result = dmx_set_light_ct(cmd->universe, cmd->channel, cmd->brightness, cmd->color_temp, fade_ms);
+        break;
+
+    case UDP_CMD_PERCENTAGE:
+        result = dmx_set_channel(cmd->universe, cmd->channel, cmd->levels[0], fade_ms);
+
+        if (result == DMX_CMD_SUCCESS)
+        {
+            LOG_RING_I(LOG_MODULE_UDP_PROTOCOL, "Channel %d set to %d%% (%d/255)",
+                       cmd->channel, cmd->value, cmd->levels[0]);
         }
         break;
-    }
 
     case UDP_CMD_CHANNEL:
-    {
-        // Clamp value to valid DMX range
-        uint8_t dmx_value = (cmd->value < 0) ? 0 : (cmd->value > 255 ? 255 : cmd->value);
+        result = dmx_set_channel(cmd->universe, cmd->channel, cmd->levels[0], fade_ms);
+
+        if (result == DMX_CMD_SUCCESS)
+        {
+            LOG_RING_I(LOG_MODULE_UDP_PROTOCOL, "Channel %d set to %d", cmd->channel, cmd->levels[0]);
+        }
+        break;
 
-        result = dmx_set_channel(cmd->channel, dmx_value, fade_ms);
+    case UDP_CMD_SET_RANGE:
+        result = dmx_set_multi_channels(cmd->universe, cmd->channel, cmd->payload, cmd->count, fade_ms);
 
         if (result == DMX_CMD_SUCCESS)
         {
-            ESP_LOGI(TAG, "Channel %d set to %d", cmd->channel, dmx_value);
+            LOG_RING_I(LOG_MODULE_UDP_PROTOCOL, "Channels %d-%d set with fade %d ms",
+                       cmd->channel, cmd->channel + cmd->count - 1, fade_ms);
+        }
+        break;
+
+    case UDP_CMD_FILL:
+        memset(fill_levels, cmd->levels[0], (size_t)cmd->count);
+        result = dmx_set_multi_channels(cmd->universe, cmd->channel, fill_levels, cmd->count, fade_ms);
+
+        if (result == DMX_CMD_SUCCESS)
+        {
+            LOG_RING_I(LOG_MODULE_UDP_PROTOCOL, "Channels %d-%d filled with %d, fade %d ms",
+                       cmd->channel, cmd->channel + cmd->count - 1, cmd->levels[0], fade_ms);
         }
         break;
-    }
 
     default:
-        ESP_LOGW(TAG, "Unknown command type: %c", (char)cmd->type);
+        LOG_RING_W(LOG_MODULE_UDP_PROTOCOL, "Unknown command type: %c", (char)cmd->type);
         return DMX_CMD_ERROR_INVALID_VALUE;
     }
 
@@ -233,10 +690,11 @@ dmx_command_result_t udp_handle_raw_command(const char *cmd)
         return DMX_CMD_ERROR_INVALID_VALUE;
     }
 
-    udp_parsed_command_t parsed = udp_parse_command(cmd);
-    if (!parsed.valid)
+    udp_parsed_command_t parsed;
+    udp_parse_error_t err = udp_parse_command(cmd, strlen(cmd), &parsed);
+    if (err != UDP_PARSE_OK)
     {
-        ESP_LOGW(TAG, "Failed to parse command: %s", cmd);
+        ESP_LOGW(TAG, "Failed to parse command (%s): %s", udp_parse_error_name(err), cmd);
         return DMX_CMD_ERROR_INVALID_VALUE;
     }
 
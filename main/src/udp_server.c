@@ -1,11 +1,23 @@
 #include "udp_server.h"
 #include "udp_protocol.h"
+#include "artnet.h"
+#include "sacn.h"
+#include "dmx_stream.h"
+#include "feedback.h"
+#include "rate_limit.h"
+#include "log_ring.h"
 #include "dmx_manager.h"
+#include "cmd_queue.h"
+#include "task_config.h"
+#include "stats_seqlock.h"
 #include "my_led.h"
 
 #include <string.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_netif.h"
 #include "lwip/sockets.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -16,19 +28,77 @@ static const char *TAG = "udp_server";
 static bool server_initialized = false;
 static bool server_running = false;
 static int server_socket = -1;
+static int sacn_socket = -1;
 static uint16_t server_port = UDP_DEFAULT_PORT;
+static int server_rcvbuf = UDP_BUFFER_SIZE * UDP_RX_BATCH;
 static TaskHandle_t server_task_handle = NULL;
 
-// Statistics
+// Parsed commands of the current datagram (server task only)
+static udp_parsed_command_t batch[UDP_MAX_BATCH_COMMANDS];
+
+// Commands held back from sources over their rate, latest per channel
+// range wins; flushed as one batch every UDP_HOLD_FLUSH_MS (server task only)
+#define UDP_HOLD_FLUSH_MS 20
+static udp_parsed_command_t held[UDP_MAX_BATCH_COMMANDS];
+static int held_count = 0;
+static int64_t held_received_us = 0;
+static int64_t held_flushed_us = 0;
+
+// Statistics. server_stats is counted by the server task, render_stats
+// by the render task; each is published to its *_shared copy.
+typedef struct {
+    uint32_t commands_executed;
+    uint32_t command_errors;    // Execution failures
+    uint32_t commands_by_type[UDP_STATS_CMD_COUNT];
+} render_stats_t;
+
 static udp_server_stats_t server_stats = {0};
+static udp_server_stats_t server_stats_shared = {0};
+static stats_seqlock_t server_stats_lock = STATS_SEQLOCK_INIT;
+static render_stats_t render_stats = {0};
+static render_stats_t render_stats_shared = {0};
+static stats_seqlock_t render_stats_lock = STATS_SEQLOCK_INIT;
+static _Atomic bool server_reset_requested = false;
+static _Atomic bool render_reset_requested = false;
+
+static const char *const stats_cmd_names[UDP_STATS_CMD_COUNT] = {
+    [UDP_STATS_CMD_CHANNEL] = "C",
+    [UDP_STATS_CMD_PERCENTAGE] = "P",
+    [UDP_STATS_CMD_RGB] = "R",
+    [UDP_STATS_CMD_TUNABLE_WHITE] = "W",
+    [UDP_STATS_CMD_LIGHT_CT] = "L",
+    [UDP_STATS_CMD_SET_RANGE] = "S",
+    [UDP_STATS_CMD_FILL] = "F",
+    [UDP_STATS_CMD_RAW] = "raw"};
 
 // Private function declarations
 static void udp_server_task(void *arg);
-static esp_err_t handle_dmx_universe_data(const uint8_t *data, size_t len);
-static esp_err_t handle_dmx_command(const char *cmd);
+static int open_sacn_socket(void);
+static void set_receive_buffer(int sock);
+static void handle_wakeup(const fd_set *read_fds, char *rx_buffer);
+static int receive_datagrams(int sock, char *rx_buffer, size_t size, bool sacn);
+static void handle_udp_packet(char *rx_buffer, int len, const struct sockaddr *source, int64_t received_us);
+static rate_limit_class_t classify_packet(const char *data, int len);
+static void hold_commands(const char *data, int len, int64_t received_us);
+static void flush_held_commands(int64_t now_us, bool force);
+static void handle_sacn_packet(const uint8_t *data, size_t len, int64_t received_us);
+static esp_err_t handle_dmx_universe_data(int universe, const uint8_t *data, size_t len, int64_t received_us);
+static esp_err_t handle_dmx_span(const uint8_t *data, size_t len, int64_t received_us);
+static esp_err_t handle_dmx_stream(const uint8_t *data, size_t len, int64_t received_us);
+static esp_err_t handle_artnet_packet(const uint8_t *data, size_t len, const struct sockaddr *source, int64_t received_us);
+static void send_artnet_poll_replies(const struct sockaddr *source);
+static esp_err_t handle_dmx_command(const char *cmd, size_t len, int64_t received_us);
+static esp_err_t handle_binary_command(const uint8_t *data, size_t len, int64_t received_us);
+static esp_err_t handle_subscription(const char *request, size_t len, const struct sockaddr *source);
+static void enqueue_done(bool queued);
+static void count_rejected(const udp_batch_result_t *parsed);
+static void publish_server_stats(void);
+static udp_stats_cmd_t stats_cmd_type(const cmd_queue_entry_t *entry);
+static void drain_command_queue(void);
+static void execute_queue_entry(const cmd_queue_entry_t *entry, const uint8_t *payload);
 
 // Initialize UDP server
-esp_err_t udp_server_init(uint16_t port)
+esp_err_t udp_server_init(uint16_t port, int receive_buffer_size)
 {
     if (server_initialized) {
         ESP_LOGW(TAG, "UDP server already initialized");
@@ -36,7 +106,17 @@ esp_err_t udp_server_init(uint16_t port)
     }
 
     server_port = port;
+    server_rcvbuf = (receive_buffer_size > 0 ? receive_buffer_size : UDP_BUFFER_SIZE) * UDP_RX_BATCH;
     memset(&server_stats, 0, sizeof(server_stats));
+    memset(&render_stats, 0, sizeof(render_stats));
+    stats_seqlock_publish(&server_stats_lock, &server_stats_shared, &server_stats, sizeof(server_stats));
+    stats_seqlock_publish(&render_stats_lock, &render_stats_shared, &render_stats, sizeof(render_stats));
+    held_count = 0;
+
+    // Commands are parsed here and executed by the DMX render task
+    cmd_queue_reset();
+    dmx_manager_set_frame_hook(drain_command_queue);
+
     server_initialized = true;
     
     ESP_LOGI(TAG, "UDP server initialized on port %d", port);
@@ -72,14 +152,15 @@ esp_err_t udp_server_start(void)
         return ESP_OK;
     }
 
-    // Create server task
-    BaseType_t task_result = xTaskCreate(
+    // Create server task next to the Wi-Fi and lwIP tasks
+    BaseType_t task_result = xTaskCreatePinnedToCore(
         udp_server_task,
         "udp_server",
-        8192,
+        UDP_SERVER_TASK_STACK,
         NULL,
-        5,
-        &server_task_handle
+        UDP_SERVER_TASK_PRIORITY,
+        &server_task_handle,
+        TASK_CORE_NETWORK
     );
 
     if (task_result != pdPASS) {
@@ -101,11 +182,15 @@ esp_err_t udp_server_stop(void)
 
     server_running = false;
 
-    // Close socket to interrupt blocking recvfrom
+    // Close sockets to interrupt blocking select
     if (server_socket >= 0) {
         close(server_socket);
         server_socket = -1;
     }
+    if (sacn_socket >= 0) {
+        close(sacn_socket);
+        sacn_socket = -1;
+    }
 
     // Delete task
     if (server_task_handle != NULL) {
@@ -132,16 +217,48 @@ esp_err_t udp_server_restart(void)
 // Get server statistics
 udp_server_stats_t udp_server_get_stats(void)
 {
-    return server_stats;
+    udp_server_stats_t stats;
+    render_stats_t render;
+    stats_seqlock_read(&server_stats_lock, &stats, &server_stats_shared, sizeof(stats));
+    stats_seqlock_read(&render_stats_lock, &render, &render_stats_shared, sizeof(render));
+
+    stats.commands_executed = render.commands_executed;
+    stats.command_errors += render.command_errors;
+    memcpy(stats.commands_by_type, render.commands_by_type, sizeof(stats.commands_by_type));
+    stats.queue_depth = cmd_queue_depth();
+    return stats;
 }
 
-// Reset server statistics
+// Reset server statistics; the counting tasks own the counters, so they
+// clear them themselves
 void udp_server_reset_stats(void)
 {
-    memset(&server_stats, 0, sizeof(server_stats));
+    atomic_store(&server_reset_requested, true);
+    atomic_store(&render_reset_requested, true);
     ESP_LOGI(TAG, "Server statistics reset");
 }
 
+const char *udp_stats_cmd_name(udp_stats_cmd_t type)
+{
+    return (type < UDP_STATS_CMD_COUNT) ? stats_cmd_names[type] : "unknown";
+}
+
+// Server task only. The protocol modules count on this task too and
+// publish first, so a reader that sees a datagram in rx_datagrams also
+// sees what the modules counted for it.
+static void publish_server_stats(void)
+{
+    artnet_publish_stats();
+    sacn_publish_stats();
+    dmx_stream_publish_stats();
+    rate_limit_publish_stats();
+
+    if (atomic_exchange(&server_reset_requested, false)) {
+        memset(&server_stats, 0, sizeof(server_stats));
+    }
+    stats_seqlock_publish(&server_stats_lock, &server_stats_shared, &server_stats, sizeof(server_stats));
+}
+
 // Private functions
 
 // Main server task
@@ -173,107 +290,726 @@ static void udp_server_task(void *arg)
         vTaskDelete(NULL);
         return;
     }
+    set_receive_buffer(server_socket);
+
+    // sACN runs on its own port; failing to open it is not fatal
+    sacn_socket = open_sacn_socket();
 
     char rx_buffer[UDP_BUFFER_SIZE];
-    struct sockaddr_in6 source_addr;
-    socklen_t socklen = sizeof(source_addr);
+    struct timeval hold_timeout;
 
     ESP_LOGI(TAG, "UDP server listening on port %d", server_port);
 
     while (server_running) {
-        int len = recvfrom(server_socket, rx_buffer, sizeof(rx_buffer) - 1, 0,
-                          (struct sockaddr *)&source_addr, &socklen);
-
-        server_stats.packets_received++;
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(server_socket, &read_fds);
+        int max_fd = server_socket;
+        if (sacn_socket >= 0) {
+            FD_SET(sacn_socket, &read_fds);
+            max_fd = sacn_socket > max_fd ? sacn_socket : max_fd;
+        }
 
-        if (len < 0) {
+        // Wake up for held commands even when the flood stops
+        hold_timeout.tv_sec = 0;
+        hold_timeout.tv_usec = UDP_HOLD_FLUSH_MS * 1000;
+        int ready = select(max_fd + 1, &read_fds, NULL, NULL, held_count > 0 ? &hold_timeout : NULL);
+        if (ready < 0) {
             if (server_running) { // Only log if we're supposed to be running
-                ESP_LOGW(TAG, "UDP recvfrom failed: errno %d", errno);
+                ESP_LOGW(TAG, "UDP select failed: errno %d", errno);
             }
             continue;
         }
 
-        ESP_LOGD(TAG, "UDP packet received, length = %d", len);
+        handle_wakeup(ready > 0 ? &read_fds : NULL, rx_buffer);
+    }
+
+    // Cleanup
+    if (sacn_socket >= 0) {
+        close(sacn_socket);
+        sacn_socket = -1;
+    }
+    if (server_socket >= 0) {
+        close(server_socket);
+        server_socket = -1;
+    }
+
+    ESP_LOGI(TAG, "UDP server task ended");
+    vTaskDelete(NULL);
+}
+
+// One select() wakeup: held commands that are due and every datagram
+// waiting on the ready sockets (none on a hold timeout) are queued, and
+// reach the render task in one publish so a burst is applied in the same
+// frame
+static void handle_wakeup(const fd_set *read_fds, char *rx_buffer)
+{
+    cmd_queue_batch_begin();
+    flush_held_commands(esp_timer_get_time(), false);
 
-        if (len == DMX_UNIVERSE_SIZE) {
-            // Full DMX universe data
-            esp_err_t err = handle_dmx_universe_data((uint8_t*)rx_buffer, len);
-            if (err == ESP_OK) {
-                server_stats.packets_processed++;
-            } else {
-                server_stats.packets_invalid++;
+    if (read_fds != NULL) {
+        int count = 0;
+        if (sacn_socket >= 0 && FD_ISSET(sacn_socket, read_fds)) {
+            count += receive_datagrams(sacn_socket, rx_buffer, UDP_BUFFER_SIZE, true);
+        }
+        if (server_socket >= 0 && FD_ISSET(server_socket, read_fds)) {
+            count += receive_datagrams(server_socket, rx_buffer, UDP_BUFFER_SIZE - 1, false);
+        }
+
+        if (count > 0) {
+            server_stats.rx_datagrams += count;
+            server_stats.rx_wakeups++;
+            if ((uint32_t)count > server_stats.rx_batch_max) {
+                server_stats.rx_batch_max = count;
             }
         }
-        else if (len > 4 && len < UDP_BUFFER_SIZE && strncmp(rx_buffer, "DMX", 3) == 0) {
-            // DMX command
-            rx_buffer[len] = '\0';
-            ESP_LOGI(TAG, "DMX command received: \"%s\"", rx_buffer);
-            
-            // Visual feedback
-            my_led_blink(1, 20);
-            
-            esp_err_t err = handle_dmx_command(rx_buffer);
-            if (err == ESP_OK) {
-                server_stats.packets_processed++;
-                server_stats.commands_executed++;
-            } else {
-                server_stats.packets_invalid++;
-                server_stats.command_errors++;
+    }
+
+    uint32_t depth = cmd_queue_batch_end();
+    if (depth > 0) {
+        dmx_manager_request_frame(); // Restarts the frame clock if it stopped
+    }
+    if (depth > server_stats.queue_high_water) {
+        server_stats.queue_high_water = depth;
+    }
+    publish_server_stats();
+}
+
+// Read and handle every datagram waiting on the socket, up to
+// UDP_RX_BATCH so the other socket and held commands are not starved.
+// Returns the number of datagrams read.
+static int receive_datagrams(int sock, char *rx_buffer, size_t size, bool sacn)
+{
+    struct sockaddr_in6 source_addr;
+    int count = 0;
+
+    while (count < UDP_RX_BATCH) {
+        socklen_t socklen = sizeof(source_addr);
+        int len = recvfrom(sock, rx_buffer, size, MSG_DONTWAIT,
+                           (struct sockaddr *)&source_addr, &socklen);
+        if (len < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && server_running) {
+                server_stats.rx_errors++;
+                LOG_RING_W(LOG_MODULE_UDP_SERVER, "UDP recvfrom failed: errno %d", errno);
             }
+            return count;
         }
-        else {
-            ESP_LOGW(TAG, "Invalid UDP packet received, length: %d", len);
+
+        int64_t received_us = esp_timer_get_time();
+        count++;
+        server_stats.bytes_received += len;
+
+        if (sacn) {
+            const struct sockaddr_in *source = (const struct sockaddr_in *)&source_addr;
+            if (rate_limit_check(source->sin_addr.s_addr, RATE_LIMIT_FRAME,
+                                 (uint32_t)(received_us / 1000)) == RATE_LIMIT_PASS) {
+                handle_sacn_packet((uint8_t*)rx_buffer, len, received_us);
+            }
+        } else {
+            server_stats.packets_received++;
+            handle_udp_packet(rx_buffer, len, (struct sockaddr *)&source_addr, received_us);
+        }
+    }
+
+    // More may be waiting; select() reports it again right away
+    server_stats.rx_batch_limited++;
+    return count;
+}
+
+// Dispatch a datagram received on the main port
+static void handle_udp_packet(char *rx_buffer, int len, const struct sockaddr *source, int64_t received_us)
+{
+    // Flood protection before any parsing or logging: frames over the
+    // source's rate are shed, commands are held and coalesced
+    uint32_t addr = (source->sa_family == AF_INET) ? ((const struct sockaddr_in *)source)->sin_addr.s_addr : 0;
+    rate_limit_class_t cls = classify_packet(rx_buffer, len);
+    rate_limit_verdict_t verdict = rate_limit_check(addr, cls, (uint32_t)(received_us / 1000));
+    if (verdict == RATE_LIMIT_DROP) {
+        server_stats.packets_shed++;
+        return;
+    }
+    if (verdict == RATE_LIMIT_HOLD) {
+        hold_commands(rx_buffer, len, received_us);
+        return;
+    }
+    if (cls == RATE_LIMIT_COMMAND) {
+        // Held commands are older than this one
+        flush_held_commands(received_us, true);
+    }
+
+    LOG_RING_D(LOG_MODULE_UDP_SERVER, "UDP packet received, length = %d", len);
+
+    if (artnet_is_packet((uint8_t*)rx_buffer, len)) {
+        // Art-Net (checked first, an ArtDmx can be 512 bytes long)
+        esp_err_t err = handle_artnet_packet((uint8_t*)rx_buffer, len, source, received_us);
+        if (err == ESP_OK) {
+            server_stats.packets_processed++;
+        } else if (err == ESP_ERR_INVALID_ARG) {
             server_stats.packets_invalid++;
         }
     }
+    else if (dmx_stream_is_packet((uint8_t*)rx_buffer, len)) {
+        // Compressed universe stream. A keyframe can be 512 bytes long;
+        // 512 bytes that do not decode are raw universe data whose first
+        // slots happen to match the stream header.
+        esp_err_t err = handle_dmx_stream((uint8_t*)rx_buffer, len, received_us);
+        if ((err == ESP_ERR_NOT_FOUND || err == ESP_ERR_INVALID_ARG) && len == DMX_UNIVERSE_SIZE) {
+            err = handle_dmx_universe_data(0, (uint8_t*)rx_buffer, len, received_us);
+        }
+        if (err == ESP_OK) {
+            server_stats.packets_processed++;
+        } else if (err == ESP_ERR_INVALID_ARG) {
+            server_stats.packets_invalid++;
+        }
+    }
+    else if (udp_is_binary_packet((uint8_t*)rx_buffer, len)) {
+        // Binary commands; 512 bytes that do not parse as binary are raw
+        // universe data whose first slot happens to match the magic byte
+        esp_err_t err = handle_binary_command((uint8_t*)rx_buffer, len, received_us);
+        if (err == ESP_ERR_NOT_FOUND) {
+            err = handle_dmx_universe_data(0, (uint8_t*)rx_buffer, len, received_us);
+        }
+        if (err == ESP_OK) {
+            server_stats.packets_processed++;
+        } else if (err != ESP_ERR_NO_MEM) {
+            server_stats.packets_invalid++;
+        }
+    }
+    else if (udp_is_span_packet((uint8_t*)rx_buffer, len) && len != DMX_UNIVERSE_SIZE) {
+        // Partial universe update; 512 bytes are always a full universe
+        esp_err_t err = handle_dmx_span((uint8_t*)rx_buffer, len, received_us);
+        if (err == ESP_OK) {
+            server_stats.packets_processed++;
+        } else if (err != ESP_ERR_NO_MEM) {
+            server_stats.packets_invalid++;
+        }
+    }
+    else if (len == DMX_UNIVERSE_SIZE) {
+        // Full DMX universe data
+        esp_err_t err = handle_dmx_universe_data(0, (uint8_t*)rx_buffer, len, received_us);
+        if (err == ESP_OK) {
+            server_stats.packets_processed++;
+        } else if (err != ESP_ERR_NO_MEM) {
+            server_stats.packets_invalid++;
+        }
+    }
+    else if (len > 4 && len < UDP_BUFFER_SIZE && memcmp(rx_buffer, "DMX", 3) == 0) {
+        // One or more DMX commands, parsed in place
+        LOG_RING_I(LOG_MODULE_UDP_SERVER, "DMX command received, %d bytes", len);
+        
+        // Visual feedback
+        my_led_blink(1, 20);
+        
+        esp_err_t err = handle_dmx_command(rx_buffer, len, received_us);
+        if (err == ESP_OK) {
+            server_stats.packets_processed++;
+        } else if (err != ESP_ERR_NO_MEM) {
+            server_stats.packets_invalid++;
+        }
+    }
+    else if (len < UDP_BUFFER_SIZE && udp_is_subscription(rx_buffer, len)) {
+        // State feedback subscription
+        if (handle_subscription(rx_buffer, len, source) == ESP_OK) {
+            server_stats.packets_processed++;
+        } else {
+            server_stats.packets_invalid++;
+        }
+    }
+    else {
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Invalid UDP packet received, length: %d", len);
+        server_stats.packets_invalid++;
+    }
+}
 
-    // Cleanup
-    if (server_socket >= 0) {
-        close(server_socket);
-        server_socket = -1;
+// Rate limiter class of a main-port datagram, mirrors the dispatch in
+// handle_udp_packet. A raw universe that starts like a binary datagram
+// counts as commands; held, it fails to parse and is shed.
+static rate_limit_class_t classify_packet(const char *data, int len)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    if (artnet_is_packet(bytes, len) || dmx_stream_is_packet(bytes, len)) {
+        return RATE_LIMIT_FRAME;
+    }
+    if (udp_is_binary_packet(bytes, len)) {
+        return RATE_LIMIT_COMMAND;
+    }
+    if (len == DMX_UNIVERSE_SIZE || udp_is_span_packet(bytes, len)) {
+        return RATE_LIMIT_FRAME;
     }
+    if (len > 4 && len < UDP_BUFFER_SIZE &&
+        (memcmp(data, "DMX", 3) == 0 || udp_is_subscription(data, len))) {
+        return RATE_LIMIT_COMMAND;
+    }
+    return RATE_LIMIT_FRAME; // Garbage is shed like a frame
+}
 
-    ESP_LOGI(TAG, "UDP server task ended");
-    vTaskDelete(NULL);
+// Parse commands of a source over its rate without logging and merge them
+// into the held set. A command for the same universe and channel range
+// replaces the held one and moves to the end, so the order of overlapping
+// ranges is kept. Range levels point into the receive buffer and cannot be
+// held; they are shed like frames, as are subscriptions.
+static void hold_commands(const char *data, int len, int64_t received_us)
+{
+    udp_batch_result_t parsed = {0};
+    if (udp_is_binary_packet((const uint8_t *)data, len)) {
+        parsed = udp_parse_binary((const uint8_t *)data, len, batch, UDP_MAX_BATCH_COMMANDS);
+    } else if (memcmp(data, "DMX", 3) == 0) {
+        parsed = udp_parse_batch(data, len, batch, UDP_MAX_BATCH_COMMANDS);
+    }
+    if (parsed.count == 0 && (parsed.rejected == 0 || len == DMX_UNIVERSE_SIZE)) {
+        server_stats.packets_shed++;
+        return;
+    }
+
+    server_stats.commands_received += parsed.count + parsed.rejected;
+    count_rejected(&parsed);
+
+    for (int i = 0; i < parsed.count; ++i) {
+        const udp_parsed_command_t *cmd = &batch[i];
+        if (cmd->payload) {
+            server_stats.commands_shed++;
+            continue;
+        }
+
+        int slot = 0;
+        while (slot < held_count && !(held[slot].universe == cmd->universe &&
+                                      held[slot].channel == cmd->channel && held[slot].count == cmd->count)) {
+            ++slot;
+        }
+        if (slot < held_count) {
+            server_stats.commands_superseded++;
+        } else if (held_count == UDP_MAX_BATCH_COMMANDS) {
+            slot = 0; // Full: the oldest held command goes
+            server_stats.commands_shed++;
+        } else {
+            held_count++;
+        }
+
+        memmove(&held[slot], &held[slot + 1], (held_count - 1 - slot) * sizeof(held[0]));
+        held[held_count - 1] = *cmd;
+        server_stats.commands_held++;
+    }
+
+    if (held_count > 0) {
+        held_received_us = received_us;
+    }
 }
 
-// Handle full DMX universe data
-static esp_err_t handle_dmx_universe_data(const uint8_t *data, size_t len)
+// Queue the held commands as one batch, at most every UDP_HOLD_FLUSH_MS
+// unless forced. If the queue is full they stay held and keep coalescing.
+static void flush_held_commands(int64_t now_us, bool force)
 {
-    if (!data || len != DMX_UNIVERSE_SIZE) {
-        ESP_LOGW(TAG, "Invalid DMX universe data");
+    if (held_count == 0 || (!force && now_us - held_flushed_us < UDP_HOLD_FLUSH_MS * 1000)) {
+        return;
+    }
+
+    held_flushed_us = now_us;
+    if (cmd_queue_push_commands(held, held_count, held_received_us)) {
+        held_count = 0;
+        enqueue_done(true);
+    }
+}
+
+// Add, renew or drop state feedback subscriptions of the sender
+static esp_err_t handle_subscription(const char *request, size_t len, const struct sockaddr *source)
+{
+    udp_subscription_t sub;
+    udp_parse_error_t err = udp_parse_subscription(request, len, &sub);
+    if (err != UDP_PARSE_OK) {
+        server_stats.parse_errors[err]++;
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Invalid subscription (%s), length: %d",
+                   (uintptr_t)udp_parse_error_name(err), len);
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Stop all current fades and update all channels
-    dmx_stop_all_fades();
-    
-    dmx_command_result_t result = dmx_set_multi_channels(1, data, DMX_UNIVERSE_SIZE, 0);
-    
-    if (result == DMX_CMD_SUCCESS) {
-        ESP_LOGD(TAG, "DMX universe updated successfully");
+    // Notifications are IPv4 only; the caller counts it as an invalid packet
+    if (source->sa_family != AF_INET) {
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Subscription from a non-IPv4 source, family: %d",
+                   source->sa_family);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    struct sockaddr_in addr = *(const struct sockaddr_in *)source;
+    if (!sub.subscribe) {
+        feedback_unsubscribe(&addr);
+        ESP_LOGI(TAG, "Feedback unsubscribed: %s", inet_ntoa(addr.sin_addr));
         return ESP_OK;
+    }
+
+    esp_err_t result = feedback_subscribe(&addr, sub.universe, sub.channel, sub.count, sub.interval_ms);
+    if (result == ESP_OK) {
+        ESP_LOGI(TAG, "Feedback subscribed: %s:%d, universe %d channels %d-%d",
+                 inet_ntoa(addr.sin_addr), ntohs(addr.sin_port), sub.universe + 1,
+                 sub.channel, sub.channel + sub.count - 1);
+    }
+    return result;
+}
+
+// Queue DMX universe data (slot 1 onwards) for the render task. Only a
+// full-length frame takes over the universe; a shorter Art-Net or sACN
+// frame is written like a span and leaves fades past its end running.
+static esp_err_t handle_dmx_universe_data(int universe, const uint8_t *data, size_t len, int64_t received_us)
+{
+    if (!data || len == 0 || len > DMX_UNIVERSE_SIZE) {
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Invalid DMX universe data");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool queued;
+    if (len < DMX_UNIVERSE_SIZE) {
+        queued = cmd_queue_push_span(universe, 1, data, len, 0, received_us);
     } else {
-        ESP_LOGW(TAG, "Failed to update DMX universe: %d", result);
-        return ESP_FAIL;
+        queued = cmd_queue_push_universe(universe, data, len, received_us);
+    }
+    enqueue_done(queued);
+    return queued ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// Queue a raw span; only its channels are written and only their fades
+// are replaced
+static esp_err_t handle_dmx_span(const uint8_t *data, size_t len, int64_t received_us)
+{
+    udp_span_t span;
+    udp_parse_error_t err = udp_parse_span(data, len, &span);
+    if (err != UDP_PARSE_OK) {
+        server_stats.parse_errors[err]++;
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Invalid DMX span (%s), length: %u",
+                   (uintptr_t)udp_parse_error_name(err), len);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool queued = cmd_queue_push_span(span.universe, span.start, span.data, span.length,
+                                      span.fade_ms, received_us);
+    enqueue_done(queued);
+    return queued ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// Decode a stream frame and queue what it changed: a keyframe takes over
+// the universe, a delta only writes its span. Returns ESP_ERR_NOT_FOUND
+// for frames dropped by the sequence check or while waiting for a keyframe.
+// A frame that cannot be queued desyncs the universe, since later deltas
+// would build on output that was never written.
+static esp_err_t handle_dmx_stream(const uint8_t *data, size_t len, int64_t received_us)
+{
+    dmx_stream_frame_t frame;
+    dmx_stream_result_t result = dmx_stream_decode(data, len, &frame);
+    if (result == DMX_STREAM_NOT_OURS || result == DMX_STREAM_OUT_OF_ORDER ||
+        result == DMX_STREAM_NEED_KEYFRAME) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (result != DMX_STREAM_OK) {
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Invalid DMX stream frame (%d), length: %u", result, len);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+    if (frame.keyframe) {
+        err = handle_dmx_universe_data(frame.universe, frame.levels, DMX_UNIVERSE_SIZE, received_us);
+    } else {
+        // Slot n + 1 is channel n + 1; slot 512 cannot be addressed
+        int count = frame.count;
+        if (frame.first + count > DMX_UNIVERSE_SIZE - 1) {
+            count = DMX_UNIVERSE_SIZE - 1 - frame.first;
+        }
+        if (count > 0) {
+            bool queued = cmd_queue_push_span(frame.universe, frame.first + 1, frame.levels + frame.first,
+                                              (size_t)count, 0, received_us);
+            enqueue_done(queued);
+            err = queued ? ESP_OK : ESP_ERR_NO_MEM;
+        }
     }
+
+    if (err == ESP_ERR_NO_MEM) {
+        dmx_stream_invalidate(frame.universe);
+    }
+    return err;
 }
 
-// Handle DMX command
-static esp_err_t handle_dmx_command(const char *cmd)
+// Handle ArtDmx and ArtPoll; other OpCodes are ignored. Returns
+// ESP_ERR_INVALID_ARG for malformed packets and ESP_ERR_NOT_FOUND for
+// frames that are filtered or dropped by the sequence check.
+static esp_err_t handle_artnet_packet(const uint8_t *data, size_t len, const struct sockaddr *source, int64_t received_us)
+{
+    switch (artnet_get_opcode(data)) {
+    case ARTNET_OP_DMX: {
+        artnet_dmx_t dmx;
+        artnet_result_t result = artnet_parse_dmx(data, len, &dmx);
+        if (result != ARTNET_OK) {
+            LOG_RING_D(LOG_MODULE_UDP_SERVER, "Invalid ArtDmx (%d)", result);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        int universe;
+        if (artnet_accept_dmx(&dmx, &universe) != ARTNET_OK) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        return handle_dmx_universe_data(universe, dmx.data, dmx.length, received_us);
+    }
+
+    case ARTNET_OP_POLL:
+        if (artnet_parse_poll(data, len) != ARTNET_OK) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        send_artnet_poll_replies(source);
+        return ESP_OK;
+
+    default:
+        LOG_RING_D(LOG_MODULE_UDP_SERVER, "Ignoring Art-Net OpCode 0x%04x", artnet_get_opcode(data));
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+}
+
+// Answer ArtPoll with one ArtPollReply per universe, unicast to the
+// controller on the Art-Net port (Art-Net 4)
+static void send_artnet_poll_replies(const struct sockaddr *source)
+{
+    static uint8_t reply[ARTNET_POLL_REPLY_SIZE]; // Server task only
+    artnet_node_info_t info = {
+        .short_name = "udp2dmx",
+        .long_name = "udp2dmx ESP32 DMX gateway"
+    };
+
+    esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+    if (netif) {
+        esp_netif_ip_info_t ip_info;
+        if (esp_netif_get_ip_info(netif, &ip_info) == ESP_OK) {
+            memcpy(info.ip, &ip_info.ip.addr, sizeof(info.ip)); // Network byte order
+        }
+        esp_netif_get_mac(netif, info.mac);
+
+        const char *hostname = NULL;
+        if (esp_netif_get_hostname(netif, &hostname) == ESP_OK && hostname) {
+            info.short_name = hostname;
+        }
+    }
+
+    struct sockaddr_in dest;
+    memcpy(&dest, source, sizeof(dest));
+    dest.sin_port = htons(ARTNET_PORT);
+
+    for (int universe = 0; universe < dmx_manager_get_universe_count(); ++universe) {
+        size_t size = artnet_build_poll_reply(reply, &info, universe);
+        if (sendto(server_socket, reply, size, 0, (struct sockaddr *)&dest, sizeof(dest)) < 0) {
+            ESP_LOGW(TAG, "ArtPollReply failed: errno %d", errno);
+        }
+    }
+}
+
+// Let lwIP queue a burst instead of dropping it while the task is busy
+static void set_receive_buffer(int sock)
+{
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &server_rcvbuf, sizeof(server_rcvbuf)) < 0) {
+        ESP_LOGW(TAG, "SO_RCVBUF %d failed: errno %d (CONFIG_LWIP_SO_RCVBUF disabled?)", server_rcvbuf, errno);
+    }
+}
+
+// Bind the sACN port and join the multicast group of every universe,
+// returns -1 when sACN is disabled or the socket cannot be opened
+static int open_sacn_socket(void)
+{
+    if (sacn_get_universe_count() == 0) {
+        return -1;
+    }
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "sACN socket creation failed: errno %d", errno);
+        return -1;
+    }
+
+    struct sockaddr_in bind_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(SACN_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY)
+    };
+
+    if (bind(sock, (struct sockaddr *)&bind_addr, sizeof(bind_addr)) < 0) {
+        ESP_LOGE(TAG, "sACN socket bind failed: errno %d", errno);
+        close(sock);
+        return -1;
+    }
+    set_receive_buffer(sock);
+
+    for (int i = 0; i < sacn_get_universe_count(); ++i) {
+        uint16_t universe = sacn_get_universe(i);
+        struct ip_mreq mreq = {
+            .imr_multiaddr.s_addr = htonl(sacn_multicast_address(universe)),
+            .imr_interface.s_addr = htonl(INADDR_ANY)
+        };
+
+        if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            ESP_LOGW(TAG, "sACN multicast join for universe %d failed: errno %d", universe, errno);
+        } else {
+            ESP_LOGI(TAG, "sACN universe %d -> DMX universe %d", universe, i + 1);
+        }
+    }
+
+    return sock;
+}
+
+// Parse an E1.31 packet in place and queue its slots for the render task
+static void handle_sacn_packet(const uint8_t *data, size_t len, int64_t received_us)
+{
+    sacn_packet_t packet;
+    sacn_result_t result = sacn_parse(data, len, &packet);
+    if (result != SACN_OK) {
+        if (result != SACN_IGNORED) {
+            LOG_RING_D(LOG_MODULE_UDP_SERVER, "Invalid sACN packet (%d)", result);
+        }
+        return;
+    }
+
+    int universe;
+    result = sacn_accept(&packet, (uint32_t)(received_us / 1000), &universe);
+    if (result != SACN_OK || packet.length == 0) {
+        return;
+    }
+
+    handle_dmx_universe_data(universe, packet.data, packet.length, received_us);
+}
+
+// Parse all DMX commands of a datagram and queue them for the render
+// task as one batch, so they are applied in the same frame
+static esp_err_t handle_dmx_command(const char *cmd, size_t len, int64_t received_us)
 {
     if (!cmd) {
         ESP_LOGW(TAG, "NULL command string");
         return ESP_ERR_INVALID_ARG;
     }
 
-    dmx_command_result_t result = udp_handle_raw_command(cmd);
-    
+    udp_batch_result_t parsed = udp_parse_batch(cmd, len, batch, UDP_MAX_BATCH_COMMANDS);
+    server_stats.commands_received += parsed.count + parsed.rejected;
+
+    if (parsed.rejected > 0) {
+        count_rejected(&parsed);
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "%d of %d commands rejected (first: %s), length: %d",
+                   parsed.rejected, parsed.count + parsed.rejected,
+                   (uintptr_t)udp_parse_error_name(parsed.first_error), len);
+    }
+
+    if (parsed.count == 0) {
+        return ESP_FAIL;
+    }
+
+    bool queued = cmd_queue_push_commands(batch, parsed.count, received_us);
+    enqueue_done(queued);
+    return queued ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// Parse a binary datagram and queue its records as one batch. Returns
+// ESP_ERR_NOT_FOUND without counting anything for a 512 byte datagram
+// that is not valid binary, so the caller can treat it as universe data.
+static esp_err_t handle_binary_command(const uint8_t *data, size_t len, int64_t received_us)
+{
+    udp_batch_result_t parsed = udp_parse_binary(data, len, batch, UDP_MAX_BATCH_COMMANDS);
+    if (parsed.count == 0 && len == DMX_UNIVERSE_SIZE) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    server_stats.commands_received += parsed.count + parsed.rejected;
+
+    if (parsed.rejected > 0) {
+        count_rejected(&parsed);
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Binary datagram rejected (%s), length: %u",
+                   (uintptr_t)udp_parse_error_name(parsed.first_error), len);
+        return ESP_FAIL;
+    }
+
+    bool queued = cmd_queue_push_commands(batch, parsed.count, received_us);
+    enqueue_done(queued);
+    return queued ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+// Count the rejected commands of a datagram by reason
+static void count_rejected(const udp_batch_result_t *parsed)
+{
+    server_stats.commands_invalid += parsed->rejected;
+    server_stats.command_errors += parsed->rejected;
+    for (int e = 0; e < UDP_PARSE_ERR_COUNT; ++e) {
+        server_stats.parse_errors[e] += parsed->errors[e];
+    }
+}
+
+// Update queue statistics; the high-water mark is taken when the
+// wakeup's batch is published
+static void enqueue_done(bool queued)
+{
+    if (!queued) {
+        server_stats.queue_overflows++;
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Command queue full, packet dropped");
+    }
+}
+
+// Frame hook - runs in the DMX render task
+static void drain_command_queue(void)
+{
+    bool reset = atomic_exchange(&render_reset_requested, false);
+    if (reset) {
+        memset(&render_stats, 0, sizeof(render_stats));
+    }
+
+    if (cmd_queue_drain(execute_queue_entry) > 0 || reset) {
+        stats_seqlock_publish(&render_stats_lock, &render_stats_shared, &render_stats, sizeof(render_stats));
+    }
+}
+
+// Counter slot of a queue entry
+static udp_stats_cmd_t stats_cmd_type(const cmd_queue_entry_t *entry)
+{
+    if (entry->kind != CMD_QUEUE_COMMAND) {
+        return UDP_STATS_CMD_RAW;
+    }
+
+    switch (entry->cmd.type) {
+    case UDP_CMD_CHANNEL:
+        return UDP_STATS_CMD_CHANNEL;
+    case UDP_CMD_PERCENTAGE:
+        return UDP_STATS_CMD_PERCENTAGE;
+    case UDP_CMD_RGB:
+        return UDP_STATS_CMD_RGB;
+    case UDP_CMD_TUNABLE_WHITE:
+        return UDP_STATS_CMD_TUNABLE_WHITE;
+    case UDP_CMD_LIGHT_CT:
+        return UDP_STATS_CMD_LIGHT_CT;
+    case UDP_CMD_SET_RANGE:
+        return UDP_STATS_CMD_SET_RANGE;
+    default:
+        return UDP_STATS_CMD_FILL;
+    }
+}
+
+static void execute_queue_entry(const cmd_queue_entry_t *entry, const uint8_t *payload)
+{
+    dmx_command_result_t result;
+
+    dmx_manager_track_command(entry->kind == CMD_QUEUE_COMMAND ? entry->cmd.universe : entry->universe,
+                              entry->received_us, entry->queued_us);
+
+    if (entry->kind == CMD_QUEUE_UNIVERSE) {
+        // Take over the universe: stop all fades and write the payload
+        // from channel 1. The index space ends at 511, so a full
+        // 512-slot payload loses its last slot.
+        int count = entry->length < DMX_UNIVERSE_SIZE - 1 ? entry->length : DMX_UNIVERSE_SIZE - 1;
+        dmx_stop_all_fades(entry->universe);
+        result = dmx_set_multi_channels(entry->universe, 1, payload, count, 0);
+    } else if (entry->kind == CMD_QUEUE_SPAN) {
+        result = dmx_set_multi_channels(entry->universe, entry->start, payload, entry->length,
+                                        entry->fade_ms);
+    } else if (payload) {
+        // Range levels were copied into the queue
+        udp_parsed_command_t cmd = entry->cmd;
+        cmd.payload = payload;
+        result = udp_execute_command(&cmd);
+    } else {
+        result = udp_execute_command(&entry->cmd);
+    }
+
+    render_stats.commands_by_type[stats_cmd_type(entry)]++;
     if (result == DMX_CMD_SUCCESS) {
-        ESP_LOGD(TAG, "Command executed successfully: %s", cmd);
-        return ESP_OK;
+        render_stats.commands_executed++;
     } else {
-        ESP_LOGW(TAG, "Command execution failed: %s (result: %d)", cmd, result);
-        return ESP_FAIL;
+        LOG_RING_W(LOG_MODULE_UDP_SERVER, "Queued command failed (result: %d)", result);
+        render_stats.command_errors++;
     }
 }
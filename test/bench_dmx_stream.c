@@ -0,0 +1,153 @@
+// Stream bytes per frame against 512-byte raw universes, and decoder cost
+// per frame. Takes a recording of concatenated 512-byte universes
+// (tools/dmx_stream.py record); without one it generates a show: an RGBW
+// wash chase, moving heads on slow pan/tilt curves and static dimmers.
+//
+//   bench_dmx_stream [capture.dmx [keyframe_interval]]
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dmx_stream_encoder.h"
+#include "test_util.h"
+
+#define SHOW_FRAMES 2400 // One minute at 40 fps
+#define SHOW_WASH_FIXTURES 24
+#define SHOW_HEADS 12
+#define SHOW_HEAD_BASE 200
+#define SHOW_DIMMER_BASE 400
+
+static uint8_t *generate_show(size_t *count)
+{
+    uint8_t *frames = calloc(SHOW_FRAMES, DMX_UNIVERSE_SIZE);
+    CHECK(frames != NULL);
+    for (int f = 0; f < SHOW_FRAMES; ++f)
+    {
+        uint8_t *frame = &frames[(size_t)f * DMX_UNIVERSE_SIZE];
+        double t = f / 40.0;
+
+        // RGBW wash: a colour chase across the fixtures, white held
+        for (int i = 0; i < SHOW_WASH_FIXTURES; ++i)
+        {
+            double phase = t * 0.5 + i / (double)SHOW_WASH_FIXTURES;
+            frame[i * 4 + 0] = (uint8_t)(127.5 + 127.5 * sin(2 * M_PI * phase));
+            frame[i * 4 + 1] = (uint8_t)(127.5 + 127.5 * sin(2 * M_PI * (phase + 1.0 / 3)));
+            frame[i * 4 + 2] = (uint8_t)(127.5 + 127.5 * sin(2 * M_PI * (phase + 2.0 / 3)));
+            frame[i * 4 + 3] = 40;
+        }
+
+        // Moving heads: 16-bit pan/tilt on slow curves, the rest static
+        for (int i = 0; i < SHOW_HEADS; ++i)
+        {
+            uint8_t *head = &frame[SHOW_HEAD_BASE + i * 16];
+            unsigned pan = (unsigned)(32767.5 + 32767.5 * sin(t * 0.2 + i * 0.3));
+            unsigned tilt = (unsigned)(32767.5 + 32767.5 * cos(t * 0.15 + i * 0.2));
+            head[0] = (uint8_t)(pan >> 8);
+            head[1] = (uint8_t)pan;
+            head[2] = (uint8_t)(tilt >> 8);
+            head[3] = (uint8_t)tilt;
+            head[4] = 255; // Dimmer
+            head[5] = 8;   // Colour wheel
+            head[6] = (f / 400) % 2 ? 30 : 0; // Gobo change now and then
+        }
+
+        // Dimmer pack: a scene change every ten seconds
+        for (int i = 0; i < 48; ++i)
+        {
+            frame[SHOW_DIMMER_BASE + i] = (uint8_t)(((f / 400) * 37 + i * 5) & 0xFF);
+        }
+    }
+
+    *count = SHOW_FRAMES;
+    return frames;
+}
+
+static uint8_t *read_recording(const char *path, size_t *count)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        perror(path);
+        exit(1);
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    *count = (size_t)size / DMX_UNIVERSE_SIZE;
+    CHECK(*count > 0);
+    uint8_t *frames = malloc(*count * DMX_UNIVERSE_SIZE);
+    CHECK(frames != NULL);
+    CHECK(fread(frames, DMX_UNIVERSE_SIZE, *count, file) == *count);
+    fclose(file);
+    return frames;
+}
+
+static int compare_size(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+int main(int argc, char **argv)
+{
+    size_t count;
+    uint8_t *frames = (argc > 1) ? read_recording(argv[1], &count) : generate_show(&count);
+    int interval = (argc > 2) ? atoi(argv[2]) : 30;
+    CHECK(interval > 0);
+
+    // Encode once and check every frame decodes back to its input
+    uint8_t *packets = malloc(count * ENC_MAX_PACKET);
+    uint16_t *sizes = malloc(count * sizeof(uint16_t));
+    CHECK(packets != NULL && sizes != NULL);
+    stream_encoder_t enc;
+    stream_encoder_init(&enc, 0, interval);
+    dmx_stream_init(1);
+    size_t total = 0;
+    int keyframes = 0;
+    for (size_t f = 0; f < count; ++f)
+    {
+        uint8_t *packet = &packets[f * ENC_MAX_PACKET];
+        sizes[f] = (uint16_t)stream_encoder_encode(&enc, &frames[f * DMX_UNIVERSE_SIZE], packet);
+        total += sizes[f];
+        keyframes += (packet[2] == DMX_STREAM_KEYFRAME);
+
+        dmx_stream_frame_t out;
+        CHECK_EQ(dmx_stream_decode(packet, sizes[f], &out), DMX_STREAM_OK);
+        CHECK(memcmp(out.levels, &frames[f * DMX_UNIVERSE_SIZE], DMX_UNIVERSE_SIZE) == 0);
+    }
+
+    long rounds = bench_iterations(20);
+    uint64_t sum = 0;
+    uint64_t t0 = bench_now_ns();
+    for (long r = 0; r < rounds; ++r)
+    {
+        dmx_stream_init(1);
+        for (size_t f = 0; f < count; ++f)
+        {
+            dmx_stream_frame_t out;
+            dmx_stream_decode(&packets[f * ENC_MAX_PACKET], sizes[f], &out);
+            sum += (uint64_t)out.count;
+        }
+    }
+    uint64_t t1 = bench_now_ns();
+    bench_use(sum);
+
+    uint16_t *sorted = malloc(count * sizeof(uint16_t));
+    CHECK(sorted != NULL);
+    memcpy(sorted, sizes, count * sizeof(uint16_t));
+    qsort(sorted, count, sizeof(uint16_t), compare_size);
+
+    printf("input:           %s\n", (argc > 1) ? argv[1] : "generated show");
+    printf("frames:          %zu (%d keyframes, interval %d)\n", count, keyframes, interval);
+    printf("raw bytes/frame: %d\n", DMX_UNIVERSE_SIZE);
+    printf("bytes/frame:     avg %.1f  p50 %u  p95 %u  max %u\n", (double)total / count,
+           sorted[count / 2], sorted[count * 95 / 100], sorted[count - 1]);
+    printf("compression:     %.1fx\n", (double)DMX_UNIVERSE_SIZE * count / total);
+    printf("decode:          %.1f ns/frame\n", (double)(t1 - t0) / ((double)rounds * count));
+
+    free(sorted);
+    free(sizes);
+    free(packets);
+    free(frames);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Per-tick cost of the render pass with 0, 3, 64 and all channels fading.
+// render_frame visits only the active fade index and includes the publish
+// of the changed slots; the legacy column is the former scan over all 512
+// fade states alone, without any publish work.
+#include "dmx_manager.c"
+
+#include "host.h"
+#include "test_util.h"
+
+static const int fade_counts[] = {0, 3, 64, DMX_UNIVERSE_SIZE - 1};
+
+// The pre-index fade_task loop: visit every slot, interpolate active ones
+// with the float expression it used
+static uint32_t legacy_scan(dmx_universe_t *u, uint32_t now_ms)
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i)
+    {
+        fade_state_t *fade = &u->fades[i];
+        if (!fade->active)
+        {
+            continue;
+        }
+        uint32_t elapsed = now_ms - fade->start_ms;
+        sum += (elapsed < (uint32_t)fade->duration_ms) ? fade_kernel_float(fade->start_value, fade->target_value, fade->duration_ms, elapsed) : fade->target_value;
+    }
+    return sum;
+}
+
+int main(void)
+{
+    const dmx_port_pins_t pins = {.tx_pin = 17, .rx_pin = 16, .en_pin = 21};
+    CHECK_EQ(dmx_manager_init(&pins, 1), ESP_OK);
+    dmx_universe_t *u = &universes[0];
+    long ticks = bench_iterations(20000);
+
+    printf("%-8s %15s %15s\n", "fades", "render ns/tick", "legacy ns/tick");
+    for (size_t c = 0; c < sizeof(fade_counts) / sizeof(fade_counts[0]); ++c)
+    {
+        int count = fade_counts[c];
+        dmx_stop_all_fades(0);
+        for (int ch = 1; ch <= count; ++ch)
+        {
+            CHECK_EQ(dmx_set_channel(0, ch, 255, DMX_MAX_FADE_MS), DMX_CMD_SUCCESS);
+        }
+        CHECK_EQ(dmx_get_active_fade_count(), count);
+
+        // Fades never finish within the run, every tick moves all of them
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        uint64_t start = bench_now_ns();
+        for (long t = 0; t < ticks; ++t)
+        {
+            bench_use(render_frame(u, now_ms + (uint32_t)t * DMX_FRAME_INTERVAL_MS));
+        }
+        uint64_t index_ns = bench_now_ns() - start;
+
+        start = bench_now_ns();
+        for (long t = 0; t < ticks; ++t)
+        {
+            bench_use(legacy_scan(u, now_ms + (uint32_t)t * DMX_FRAME_INTERVAL_MS));
+        }
+        uint64_t legacy_ns = bench_now_ns() - start;
+
+        CHECK_EQ(dmx_get_active_fade_count(), count);
+        printf("%-8d %15.1f %15.1f\n", count, (double)index_ns / ticks, (double)legacy_ns / ticks);
+    }
+
+    dmx_manager_deinit();
+    return 0;
+}
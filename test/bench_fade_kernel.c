@@ -0,0 +1,70 @@
+// Cycles per fade step: the original float interpolation against the
+// fixed-point kernel, on the same random fades
+#include "fade_kernel.h"
+#include "dmx_manager.h"
+
+#include "test_util.h"
+
+#define STEPS 4096
+
+typedef struct
+{
+    fade_kernel_t kernel;
+    uint8_t start;
+    uint8_t target;
+    uint32_t duration;
+    uint32_t elapsed;
+} step_t;
+
+static step_t steps[STEPS];
+
+static uint8_t float_step(const step_t *s)
+{
+    float t = (float)(int)s->elapsed / (float)(int)s->duration;
+    float interpolated = s->start + (s->target - s->start) * t;
+    return (uint8_t)roundf(interpolated);
+}
+
+int main(void)
+{
+    uint64_t seed = 0x2545F4914F6CDD1Dull;
+    for (int i = 0; i < STEPS; ++i)
+    {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        step_t *s = &steps[i];
+        s->duration = 30 + (uint32_t)(seed >> 40) % 10000;
+        s->elapsed = (uint32_t)(seed >> 20) % s->duration;
+        s->start = (uint8_t)(seed >> 8);
+        s->target = (uint8_t)(seed >> 16);
+        s->kernel = fade_kernel_prepare(s->duration);
+    }
+
+    long rounds = bench_iterations(200);
+    uint64_t sum = 0;
+
+    uint64_t start = bench_cycles();
+    for (long r = 0; r < rounds; ++r)
+    {
+        for (int i = 0; i < STEPS; ++i)
+        {
+            sum += float_step(&steps[i]);
+        }
+    }
+    uint64_t float_cycles = bench_cycles() - start;
+
+    start = bench_cycles();
+    for (long r = 0; r < rounds; ++r)
+    {
+        for (int i = 0; i < STEPS; ++i)
+        {
+            const step_t *s = &steps[i];
+            sum -= fade_kernel_value(&s->kernel, s->start, s->target, s->duration, s->elapsed);
+        }
+    }
+    uint64_t kernel_cycles = bench_cycles() - start;
+
+    CHECK_EQ(sum, 0); // Same results
+    double count = (double)rounds * STEPS;
+    printf("float  %.2f cycles/step\nkernel %.2f cycles/step\n", float_cycles / count, kernel_cycles / count);
+    return 0;
+}
@@ -0,0 +1,67 @@
+// ASCII parser cost per command, single-pass parser against the old
+// strdup/strtok/atoi one, on a mix of typical Loxone commands
+#include <stdio.h>
+#include <string.h>
+
+#include "udp_protocol.h"
+#include "legacy_udp_parser.h"
+#include "test_util.h"
+
+static const char *const commands[] = {
+    "DMXC1#255",
+    "DMXC12#0#255",
+    "DMXP5#50#10",
+    "DMXP120#100#202",
+    "DMXR17#255128064",
+    "DMXR40#000255000#5",
+    "DMXW3#100200#102",
+    "DMXL7#200506500#20",
+    "DMXC2:301#128",
+    "DMXP1#0",
+};
+#define COMMAND_COUNT (sizeof(commands) / sizeof(commands[0]))
+
+int main(void)
+{
+    size_t lengths[COMMAND_COUNT];
+    for (size_t i = 0; i < COMMAND_COUNT; ++i)
+    {
+        lengths[i] = strlen(commands[i]);
+    }
+
+    long rounds = bench_iterations(100000);
+    uint64_t sum = 0;
+
+    uint64_t t0 = bench_now_ns();
+    for (long r = 0; r < rounds; ++r)
+    {
+        for (size_t i = 0; i < COMMAND_COUNT; ++i)
+        {
+            legacy_udp_command_t cmd = legacy_udp_parse_command(commands[i]);
+            sum += (uint64_t)cmd.channel + (uint64_t)cmd.value + (uint64_t)udp_speed_to_milliseconds(cmd.speed);
+        }
+    }
+    uint64_t t1 = bench_now_ns();
+    bench_use(sum);
+
+    sum = 0;
+    uint64_t t2 = bench_now_ns();
+    for (long r = 0; r < rounds; ++r)
+    {
+        for (size_t i = 0; i < COMMAND_COUNT; ++i)
+        {
+            udp_parsed_command_t cmd;
+            udp_parse_command(commands[i], lengths[i], &cmd);
+            sum += (uint64_t)cmd.channel + (uint64_t)cmd.value + (uint64_t)cmd.fade_ms;
+        }
+    }
+    uint64_t t3 = bench_now_ns();
+    bench_use(sum);
+
+    double n = (double)rounds * COMMAND_COUNT;
+    double legacy_ns = (double)(t1 - t0) / n;
+    double parser_ns = (double)(t3 - t2) / n;
+    printf("legacy strdup/strtok: %6.1f ns/command\n", legacy_ns);
+    printf("single pass:          %6.1f ns/command (%.1fx)\n", parser_ns, legacy_ns / parser_ns);
+    return 0;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+// C port of the encoder in tools/dmx_stream.py, for the stream tests and
+// the bytes-per-frame benchmark
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "dmx_stream.h"
+#include "dmx_manager.h"
+
+#define ENC_MAX_SKIP 64
+#define ENC_MAX_LITERAL 64
+#define ENC_MAX_REPEAT 128
+#define ENC_MIN_REPEAT 3 // Shorter runs are cheaper as literals
+#define ENC_MAX_PACKET (DMX_STREAM_HEADER_SIZE + 2 * DMX_UNIVERSE_SIZE) // Generous bound
+
+typedef struct
+{
+    uint8_t universe;
+    int keyframe_interval;
+    uint8_t sequence;
+    bool have_previous;
+    int since_keyframe;
+    uint8_t previous[DMX_UNIVERSE_SIZE];
+} stream_encoder_t;
+
+static inline bool enc_unchanged(const uint8_t *frame, const uint8_t *ref, int j, int n, int end)
+{
+    for (int k = 0; k < n; ++k)
+    {
+        if (j + k >= end || frame[j + k] != ref[j + k])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static inline bool enc_repeats(const uint8_t *frame, int j, int n, int end)
+{
+    for (int k = 0; k < n; ++k)
+    {
+        if (j + k >= end || frame[j + k] != frame[j])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// RLE tokens that turn ref into frame, returns their size
+static inline size_t enc_tokens(const uint8_t *frame, const uint8_t *ref, uint8_t *out)
+{
+    size_t n = 0;
+    int end = DMX_UNIVERSE_SIZE;
+    while (end > 0 && frame[end - 1] == ref[end - 1])
+    {
+        end--;
+    }
+
+    int i = 0;
+    while (i < end)
+    {
+        int run = 1;
+        if (frame[i] == ref[i])
+        {
+            while (i + run < end && frame[i + run] == ref[i + run] && run < ENC_MAX_SKIP)
+            {
+                run++;
+            }
+            out[n++] = (uint8_t)(DMX_STREAM_TOKEN_SKIP | (run - 1));
+            i += run;
+            continue;
+        }
+
+        while (i + run < end && frame[i + run] == frame[i] && run < ENC_MAX_REPEAT)
+        {
+            run++;
+        }
+        if (run >= ENC_MIN_REPEAT)
+        {
+            out[n++] = (uint8_t)(DMX_STREAM_TOKEN_REPEAT | (run - 1));
+            out[n++] = frame[i];
+            i += run;
+            continue;
+        }
+
+        // Literal run; short unchanged gaps are cheaper to send than a skip
+        int j = i + 1;
+        while (j < end && j - i < ENC_MAX_LITERAL && !enc_unchanged(frame, ref, j, 2, end) &&
+               !enc_repeats(frame, j, ENC_MIN_REPEAT, end))
+        {
+            j++;
+        }
+        out[n++] = (uint8_t)(DMX_STREAM_TOKEN_LITERAL | (j - i - 1));
+        memcpy(&out[n], &frame[i], (size_t)(j - i));
+        n += (size_t)(j - i);
+        i = j;
+    }
+
+    return n;
+}
+
+static inline void stream_encoder_init(stream_encoder_t *enc, uint8_t universe, int keyframe_interval)
+{
+    memset(enc, 0, sizeof(*enc));
+    enc->universe = universe;
+    enc->keyframe_interval = keyframe_interval;
+}
+
+// Next packet for frame (512 levels, slot 1 first), returns its size
+static inline size_t stream_encoder_encode(stream_encoder_t *enc, const uint8_t *frame, uint8_t *out)
+{
+    static const uint8_t zero[DMX_UNIVERSE_SIZE];
+    uint8_t base = enc->sequence;
+    enc->sequence++;
+
+    uint8_t *body = out + DMX_STREAM_HEADER_SIZE;
+    bool keyframe = !enc->have_previous || enc->since_keyframe + 1 >= enc->keyframe_interval;
+    size_t len = enc_tokens(frame, keyframe ? zero : enc->previous, body);
+    if (!keyframe)
+    {
+        // Big changes can be cheaper as a keyframe
+        uint8_t key_body[ENC_MAX_PACKET];
+        size_t key_len = enc_tokens(frame, zero, key_body);
+        if (key_len <= len)
+        {
+            keyframe = true;
+            memcpy(body, key_body, key_len);
+            len = key_len;
+        }
+    }
+
+    enc->since_keyframe = keyframe ? 0 : enc->since_keyframe + 1;
+    enc->have_previous = true;
+    memcpy(enc->previous, frame, DMX_UNIVERSE_SIZE);
+
+    out[0] = DMX_STREAM_MAGIC;
+    out[1] = DMX_STREAM_VERSION;
+    out[2] = keyframe ? DMX_STREAM_KEYFRAME : DMX_STREAM_DELTA;
+    out[3] = enc->universe;
+    out[4] = enc->sequence;
+    out[5] = keyframe ? 0 : base;
+    return DMX_STREAM_HEADER_SIZE + len;
+}
@@ -0,0 +1,207 @@
+// Fuzz target for every datagram parser. Built as a libFuzzer target with
+// clang (-DGATEWAY_FUZZ=ON); otherwise a standalone driver runs it over
+// seeds, random mutations of them and any files given on the command line.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "udp_protocol.h"
+#include "test_util.h"
+
+static void check_command(const udp_parsed_command_t *cmd)
+{
+    CHECK(cmd->valid);
+    CHECK(cmd->universe >= 0);
+    CHECK(cmd->channel >= 0);
+    CHECK(cmd->count >= 1 && cmd->count < DMX_UNIVERSE_SIZE);
+    CHECK(cmd->fade_ms >= 0);
+    CHECK(cmd->brightness <= 100);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    // Parsers must stay inside data[0..size); copy into an exact-size
+    // allocation so ASan catches any overread
+    uint8_t *buf = malloc(size ? size : 1);
+    CHECK(buf);
+    memcpy(buf, data, size);
+    const char *text = (const char *)buf;
+
+    udp_parsed_command_t cmd;
+    if (udp_parse_command(text, size, &cmd) == UDP_PARSE_OK)
+    {
+        check_command(&cmd);
+    }
+
+    udp_parsed_command_t cmds[UDP_MAX_BATCH_COMMANDS];
+    udp_batch_result_t result = udp_parse_batch(text, size, cmds, UDP_MAX_BATCH_COMMANDS);
+    CHECK(result.count >= 0 && result.count <= UDP_MAX_BATCH_COMMANDS);
+    for (int i = 0; i < result.count; ++i)
+    {
+        check_command(&cmds[i]);
+    }
+
+    result = udp_parse_binary(buf, size, cmds, UDP_MAX_BATCH_COMMANDS);
+    CHECK(result.count >= 0 && result.count <= UDP_MAX_BATCH_COMMANDS);
+    for (int i = 0; i < result.count; ++i)
+    {
+        check_command(&cmds[i]);
+        if (cmds[i].payload)
+        {
+            CHECK(cmds[i].payload >= buf && cmds[i].payload + cmds[i].count <= buf + size);
+        }
+    }
+
+    udp_span_t span;
+    if (udp_parse_span(buf, size, &span) == UDP_PARSE_OK)
+    {
+        CHECK(span.data >= buf && span.data + span.length <= buf + size);
+        CHECK(dmx_is_channel_valid(span.start, span.length));
+    }
+
+    udp_subscription_t sub;
+    if (udp_is_subscription(text, size) && udp_parse_subscription(text, size, &sub) == UDP_PARSE_OK && sub.subscribe)
+    {
+        CHECK(sub.count >= 1 && dmx_is_channel_valid(sub.channel, sub.count));
+    }
+
+    free(buf);
+    return 0;
+}
+
+#ifndef GATEWAY_LIBFUZZER
+static const uint8_t binary_seed[] = {
+    UDP_BINARY_MAGIC, UDP_BINARY_VERSION,
+    UDP_BIN_OP_SET, 0, 0, 1, 0, 3, 0, 0, 10, 20, 30,
+    UDP_BIN_OP_FILL, 0, 0, 10, 0, 5, 1, 0, 255,
+    UDP_BIN_OP_LIGHT_CT, 0, 0, 20, 0, 2, 0, 0, 50, 0x19, 0x64,
+};
+static const uint8_t span_seed[] = {UDP_SPAN_MAGIC, 0, 0, 1, 0, 0, 1, 2, 3, 4};
+static const char *const text_seeds[] = {
+    "DMXC1#255",
+    "DMXP5#50#10",
+    "DMXR17#255128064#202",
+    "DMXW3#100200",
+    "DMXL7#200506500#20",
+    "DMXC2:301#128\r\n",
+    "DMXC1#1;DMXC2#2\nDMXC3#3",
+    "SUB1#4#100",
+    "SUB2:10#3",
+    "UNSUB",
+};
+
+static uint32_t rng_state = 0x9e3779b9;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static const char dictionary[] = "DMXCPRWLSUBN0123456789#:;\r\n\0 -";
+
+static size_t mutate(uint8_t *buf, size_t len, size_t max)
+{
+    int edits = 1 + (int)(rng() % 4);
+    for (int e = 0; e < edits; ++e)
+    {
+        uint32_t op = rng() % 5;
+        size_t pos = len ? rng() % len : 0;
+        if (op == 0 && len)
+        {
+            buf[pos] = (uint8_t)rng();
+        }
+        else if (op == 1 && len)
+        {
+            buf[pos] = (uint8_t)dictionary[rng() % (sizeof(dictionary) - 1)];
+        }
+        else if (op == 2 && len < max)
+        {
+            memmove(buf + pos + 1, buf + pos, len - pos);
+            buf[pos] = (uint8_t)dictionary[rng() % (sizeof(dictionary) - 1)];
+            len++;
+        }
+        else if (op == 3 && len)
+        {
+            memmove(buf + pos, buf + pos + 1, len - pos - 1);
+            len--;
+        }
+        else if (len)
+        {
+            len = rng() % (len + 1);
+        }
+    }
+    return len;
+}
+
+static void run_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    CHECK(f);
+    static uint8_t buf[1 << 16];
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    LLVMFuzzerTestOneInput(buf, len);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            run_file(argv[i]);
+        }
+        printf("%d inputs: ok\n", argc - 1);
+        return 0;
+    }
+
+    const struct {
+        const uint8_t *data;
+        size_t len;
+    } seeds[] = {
+        {binary_seed, sizeof(binary_seed)},
+        {span_seed, sizeof(span_seed)},
+    };
+    const size_t seed_count = sizeof(seeds) / sizeof(seeds[0]) + sizeof(text_seeds) / sizeof(text_seeds[0]);
+
+    long runs = bench_iterations(200000);
+    uint8_t buf[MAX_UDP_BUFFER_SIZE];
+    for (long r = 0; r < runs; ++r)
+    {
+        size_t which = r % seed_count;
+        size_t len;
+        if (which < 2)
+        {
+            len = seeds[which].len;
+            memcpy(buf, seeds[which].data, len);
+        }
+        else
+        {
+            const char *seed = text_seeds[which - 2];
+            len = strlen(seed);
+            memcpy(buf, seed, len);
+        }
+
+        if (r % 16 == 15)
+        {
+            // Pure noise now and then
+            len = rng() % 64;
+            for (size_t i = 0; i < len; ++i)
+            {
+                buf[i] = (uint8_t)rng();
+            }
+        }
+        else
+        {
+            len = mutate(buf, len, sizeof(buf));
+        }
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+
+    printf("%ld mutated inputs: ok\n", runs);
+    return 0;
+}
+#endif
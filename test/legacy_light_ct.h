@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// DMXL as dmx_set_light_ct computed it before the CT pairs were resolved
+// at load: get_ct_sorted's fallback and ordering per command, then long
+// division. Kept for the agreement test only. Writes the levels of
+// channels ch and ch + 1.
+static inline void legacy_light_ct(const int *ct_config, int max_channels, int default_min, int default_max,
+                                   int ch, int brightness_percent, int color_temp_k,
+                                   uint8_t *val_ch, uint8_t *val_next)
+{
+    int ct1 = (ch >= 0 && ch < max_channels) ? ct_config[ch] : 0;
+    int ct2 = (ch + 1 >= 0 && ch + 1 < max_channels) ? ct_config[ch + 1] : 0;
+    int ch1 = ch;
+    int ch2 = ch + 1;
+
+    if (ct1 == 0 && ct2 == 0)
+    {
+        ct1 = default_min;
+        ct2 = default_max;
+    }
+    else if (ct1 == 0)
+    {
+        ct1 = default_min;
+    }
+    else if (ct2 == 0)
+    {
+        ct2 = default_max;
+    }
+
+    int ct_ww, ct_cw, ch_ww, ch_cw;
+    if (ct1 <= ct2)
+    {
+        ct_ww = ct1;
+        ch_ww = ch1;
+        ct_cw = ct2;
+        ch_cw = ch2;
+    }
+    else
+    {
+        ct_ww = ct2;
+        ch_ww = ch2;
+        ct_cw = ct1;
+        ch_cw = ch1;
+    }
+
+    brightness_percent = (brightness_percent < 0) ? 0 : (brightness_percent > 100) ? 100 : brightness_percent;
+    if (color_temp_k < ct_ww)
+        color_temp_k = ct_ww;
+    if (color_temp_k > ct_cw)
+        color_temp_k = ct_cw;
+
+    uint8_t val_ww = 0, val_cw = 0;
+    int brightness_255 = (brightness_percent * 255) / 100;
+
+    if (color_temp_k <= ct_ww + 100)
+    {
+        val_ww = brightness_255;
+        val_cw = 0;
+    }
+    else if (color_temp_k >= ct_cw - 100)
+    {
+        val_ww = 0;
+        val_cw = brightness_255;
+    }
+    else
+    {
+        int range = ct_cw - ct_ww;
+        long num_cw = (long)brightness_percent * (color_temp_k - ct_ww) * 255;
+        long num_ww = (long)brightness_percent * (ct_cw - color_temp_k) * 255;
+        long den = (long)range * 100;
+
+        val_cw = (uint8_t)((num_cw + den / 2) / den);
+        val_ww = (uint8_t)((num_ww + den / 2) / den);
+
+        if (val_cw * 100 / 255 < 2)
+            val_cw = 0;
+        if (val_ww * 100 / 255 < 2)
+            val_ww = 0;
+    }
+
+    int start_ch = (ch_ww < ch_cw) ? ch_ww : ch_cw;
+    uint8_t values[2] = {0, 0};
+    values[ch_ww - start_ch] = val_ww;
+    values[ch_cw - start_ch] = val_cw;
+    *val_ch = values[0];
+    *val_next = values[1];
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "udp_protocol.h"
+
+// The ASCII parser as it was before the single-pass rewrite: validate the
+// prefix, copy the command and split it with strtok/atoi. Kept for the
+// agreement test and the parser benchmark only.
+typedef struct {
+    char type;
+    int channel;
+    int value;
+    int speed;
+    bool valid;
+} legacy_udp_command_t;
+
+static inline legacy_udp_command_t legacy_udp_parse_command(const char *cmd)
+{
+    legacy_udp_command_t result = {0};
+
+    if (!udp_is_valid_command_format(cmd))
+    {
+        return result;
+    }
+
+    char *copy = strdup(cmd);
+    if (!copy)
+    {
+        return result;
+    }
+
+    char *type_str = strtok(copy + 3, "#");
+    char *value_str = strtok(NULL, "#");
+    char *speed_str = strtok(NULL, "#");
+
+    if (!type_str || !value_str)
+    {
+        free(copy);
+        return result;
+    }
+
+    result.type = type_str[0];
+    result.channel = atoi(type_str + 1);
+    result.value = atoi(value_str);
+    result.speed = speed_str ? atoi(speed_str) : 255;
+    result.valid = true;
+
+    free(copy);
+    return result;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+// Render task and frame clock of dmx_manager on the host layer, shared by
+// the tests that look at what goes on the wire
+#include "dmx_manager.h"
+#include "host.h"
+#include "test_util.h"
+
+static const dmx_port_pins_t test_pins[DMX_MAX_UNIVERSES] = {
+    {.tx_pin = 17, .rx_pin = 16, .en_pin = 21},
+    {.tx_pin = 25, .rx_pin = 26, .en_pin = 27}};
+
+static TaskHandle_t render;
+static esp_timer_handle_t frame_timer;
+
+static inline void start(int universes)
+{
+    CHECK_EQ(dmx_manager_init(test_pins, universes), ESP_OK);
+    render = host_task_find("dmx_render");
+    frame_timer = host_timer_find("dmx_frame");
+    CHECK(render != NULL && frame_timer != NULL);
+    host_task_wait_blocked(render, 1);
+}
+
+static inline void stop(void)
+{
+    dmx_manager_deinit();
+    CHECK(host_timer_find("dmx_frame") == NULL);
+}
+
+// Wait until the render task has finished the pass it was woken for
+static inline void wait_pass(uint32_t waits)
+{
+    host_task_wait_blocked(render, waits + 1);
+}
+
+// One frame clock tick
+static inline void tick(void)
+{
+    uint32_t waits = host_task_waits(render);
+    host_advance_us(host_timer_period_us(frame_timer));
+    host_timer_fire(frame_timer);
+    wait_pass(waits);
+}
+
+static inline void tick_until_idle(void)
+{
+    for (int i = 0; i < 1000 && host_timer_running(frame_timer); ++i)
+    {
+        tick();
+    }
+    CHECK(!host_timer_running(frame_timer));
+}
+
+// Slot of the last packet sent on a universe's port
+static inline uint8_t wire(int universe, int slot)
+{
+    return host_dmx_port(universe == 0 ? DMX_NUM_1 : DMX_NUM_2)->wire[slot];
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+// udp_server's datagram dispatch without its socket task: the test hands
+// datagrams to handle_udp_packet() the way one server wakeup does, and
+// the render task of render_harness.h applies them
+#include "udp_server.c"
+#include "render_harness.h"
+
+#define TEST_SOURCE_ADDR 0x0A01A8C0 // 192.168.1.10, network byte order
+
+static inline void server_start(int universes)
+{
+    start(universes);
+    artnet_init(0, universes);
+    dmx_stream_init(universes);
+    rate_limit_init(0, 0); // Tests that check the limiter set their own
+    CHECK_EQ(udp_server_init(UDP_DEFAULT_PORT, 0), ESP_OK);
+}
+
+static inline void server_stop(void)
+{
+    udp_server_deinit();
+    stop();
+}
+
+// One server wakeup that reads a single datagram from addr (network byte
+// order). Returns once the render task has run the pass it was woken for,
+// if the frame clock was stopped; with the clock running, the next tick()
+// applies what was queued.
+static inline void deliver_from(uint32_t addr, const void *data, size_t len)
+{
+    static char rx_buffer[UDP_BUFFER_SIZE];
+    CHECK(len <= sizeof(rx_buffer));
+    memcpy(rx_buffer, data, len);
+
+    struct sockaddr_in source = {
+        .sin_family = AF_INET,
+        .sin_port = htons(6454),
+        .sin_addr.s_addr = addr};
+
+    uint32_t waits = host_task_waits(render);
+    bool idle = !host_timer_running(frame_timer);
+    cmd_queue_batch_begin();
+    flush_held_commands(esp_timer_get_time(), false);
+    server_stats.bytes_received += len;
+    server_stats.packets_received++;
+    handle_udp_packet(rx_buffer, (int)len, (struct sockaddr *)&source, esp_timer_get_time());
+    uint32_t depth = cmd_queue_batch_end();
+    if (depth > 0)
+    {
+        dmx_manager_request_frame();
+        if (idle)
+        {
+            wait_pass(waits);
+        }
+    }
+    publish_server_stats();
+}
+
+static inline void deliver(const void *data, size_t len)
+{
+    deliver_from(TEST_SOURCE_ADDR, data, len);
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Host builds have no IRAM; placement attributes are dropped
+#define IRAM_ATTR
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+// Host esp_dmx backend: every port keeps its driver buffer and a copy of
+// the last packet sent, see host_dmx_port() in host.h
+#define DMX_PACKET_SIZE 513
+#define DMX_NUM_0 0
+#define DMX_NUM_1 1
+#define DMX_NUM_2 2
+#define DMX_NUM_MAX 3
+
+typedef int dmx_port_t;
+
+typedef struct {
+    int interrupt_flags;
+} dmx_config_t;
+
+#define DMX_CONFIG_DEFAULT {0}
+
+bool dmx_driver_install(dmx_port_t port, dmx_config_t *config, void *personalities, int personality_count);
+bool dmx_driver_delete(dmx_port_t port);
+bool dmx_set_pin(dmx_port_t port, int tx_pin, int rx_pin, int rts_pin);
+size_t dmx_write(dmx_port_t port, const void *source, size_t size);
+size_t dmx_write_offset(dmx_port_t port, size_t offset, const void *source, size_t size);
+bool dmx_wait_sent(dmx_port_t port, TickType_t wait_ticks);
+size_t dmx_send_num(dmx_port_t port, size_t size);
+size_t dmx_send(dmx_port_t port);
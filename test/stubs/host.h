@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_dmx.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Test control of the host ESP-IDF/FreeRTOS layer.
+//
+// Time is virtual: esp_timer_get_time() starts at HOST_START_US and only
+// moves with host_advance_us(), which also expires timed waits. Timers
+// never fire on their own, a test fires them with host_timer_fire().
+#define HOST_START_US 1000000
+
+void host_advance_us(int64_t us);
+
+// esp_timer
+esp_timer_handle_t host_timer_find(const char *name);
+bool host_timer_running(esp_timer_handle_t timer);
+uint64_t host_timer_period_us(esp_timer_handle_t timer);
+esp_timer_dispatch_t host_timer_dispatch(esp_timer_handle_t timer);
+void host_timer_fire(esp_timer_handle_t timer); // Runs the callback on the calling thread
+void host_fail_timer_create(bool fail);         // Next esp_timer_create calls fail
+
+// Tasks. Every ulTaskNotifyTake of a task counts as a wait; a test that
+// notified a task waits for the next one to know it has run its pass.
+uint32_t host_task_waits(TaskHandle_t task);
+void host_task_wait_blocked(TaskHandle_t task, uint32_t waits);
+bool host_task_alive(TaskHandle_t task);
+TaskHandle_t host_task_find(const char *name);
+
+// esp_dmx backend state of one port
+typedef struct {
+    bool installed;
+    int tx_pin;
+    int rx_pin;
+    int en_pin;
+    uint8_t buffer[DMX_PACKET_SIZE]; // Driver buffer, slot 0 is the start code
+    uint8_t wire[DMX_PACKET_SIZE];   // Last packet sent
+    size_t wire_size;                // Slots of the last packet
+    uint32_t writes;                 // dmx_write and dmx_write_offset calls
+    uint32_t bytes_written;
+    uint32_t sends;
+} host_dmx_port_t;
+
+const host_dmx_port_t *host_dmx_port(dmx_port_t port);
+void host_dmx_fail_install(dmx_port_t port, bool fail);
+
+// NVS: drop every namespace and key
+void host_nvs_erase(void);
+
+// Log lines up to level go to stderr (default: warnings); the last line
+// written at any level is kept for inspection
+void host_log_level(esp_log_level_t level);
+const char *host_log_last(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,961 @@
+#include "host.h"
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "nvs_flash.h"
+#include "esp_netif.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+// All shared state of the host layer is guarded by one lock; every change
+// that a waiter could be blocked on is broadcast on state_changed
+static pthread_mutex_t host_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t state_changed = PTHREAD_COND_INITIALIZER;
+static int64_t now_us = HOST_START_US;
+
+#define HOST_MAX_TASKS 16
+#define HOST_MAX_TIMERS 8
+
+struct host_task
+{
+    pthread_t thread;
+    char name[16];
+    TaskFunction_t function;
+    void *arg;
+    uint32_t notifications;
+    uint32_t waits;
+    bool waiting;
+    bool deleted;
+    bool exited;
+};
+
+struct host_timer
+{
+    bool used;
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch;
+    const char *name;
+    uint64_t period_us;
+    bool running;
+};
+
+struct host_semaphore
+{
+    uint32_t count;
+};
+
+static struct host_task tasks[HOST_MAX_TASKS];
+static int task_count = 0;
+static __thread struct host_task *current_task = NULL;
+
+static struct host_timer timers[HOST_MAX_TIMERS];
+static bool fail_timer_create = false;
+
+static host_dmx_port_t dmx_ports[DMX_NUM_MAX];
+static bool dmx_fail_install[DMX_NUM_MAX];
+
+static esp_log_level_t log_level = ESP_LOG_WARN;
+static char log_last[256];
+
+// Deadline of a wait in virtual time, -1 for portMAX_DELAY
+static int64_t deadline_us(TickType_t ticks)
+{
+    return (ticks == portMAX_DELAY) ? -1 : now_us + (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+static bool expired(int64_t deadline)
+{
+    return deadline >= 0 && now_us >= deadline;
+}
+
+// Caller holds host_lock
+static struct host_task *self(void)
+{
+    if (current_task == NULL)
+    {
+        // A thread not created through xTaskCreate (the test's main thread)
+        current_task = &tasks[task_count++];
+        snprintf(current_task->name, sizeof(current_task->name), "main");
+        current_task->thread = pthread_self();
+    }
+    return current_task;
+}
+
+// Caller holds host_lock; never returns for a task deleted by another one
+static void exit_if_deleted(struct host_task *task)
+{
+    if (task->deleted)
+    {
+        task->exited = true;
+        pthread_cond_broadcast(&state_changed);
+        pthread_mutex_unlock(&host_lock);
+        pthread_exit(NULL);
+    }
+}
+
+void host_advance_us(int64_t us)
+{
+    pthread_mutex_lock(&host_lock);
+    now_us += us;
+    pthread_cond_broadcast(&state_changed);
+    pthread_mutex_unlock(&host_lock);
+}
+
+// esp_err / esp_log
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code)
+    {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_FAIL:
+        return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+        return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    default:
+        return "ESP_ERR";
+    }
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    char line[sizeof(log_last)];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    pthread_mutex_lock(&host_lock);
+    memcpy(log_last, line, sizeof(log_last));
+    esp_log_level_t shown = log_level;
+    pthread_mutex_unlock(&host_lock);
+
+    if (level <= shown)
+    {
+        fprintf(stderr, "%c (%s) %s\n", "NEWIDV"[level], tag, line);
+    }
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    (void)level;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void host_log_level(esp_log_level_t level)
+{
+    pthread_mutex_lock(&host_lock);
+    log_level = level;
+    pthread_mutex_unlock(&host_lock);
+}
+
+const char *host_log_last(void)
+{
+    static char copy[sizeof(log_last)];
+    pthread_mutex_lock(&host_lock);
+    memcpy(copy, log_last, sizeof(copy));
+    pthread_mutex_unlock(&host_lock);
+    return copy;
+}
+
+// esp_timer
+
+int64_t esp_timer_get_time(void)
+{
+    pthread_mutex_lock(&host_lock);
+    int64_t now = now_us;
+    pthread_mutex_unlock(&host_lock);
+    return now;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    pthread_mutex_lock(&host_lock);
+    esp_err_t err = ESP_ERR_NO_MEM;
+    for (int i = 0; i < HOST_MAX_TIMERS && !fail_timer_create; ++i)
+    {
+        if (!timers[i].used)
+        {
+            memset(&timers[i], 0, sizeof(timers[i]));
+            timers[i].used = true;
+            timers[i].callback = args->callback;
+            timers[i].arg = args->arg;
+            timers[i].dispatch = args->dispatch_method;
+            timers[i].name = args->name;
+            *out = &timers[i];
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&host_lock);
+    return err;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t period_us)
+{
+    pthread_mutex_lock(&host_lock);
+    esp_err_t err = timer->running ? ESP_ERR_INVALID_STATE : ESP_OK;
+    if (err == ESP_OK)
+    {
+        timer->running = true;
+        timer->period_us = period_us;
+    }
+    pthread_mutex_unlock(&host_lock);
+    return err;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us)
+{
+    return timer_start(timer, period_us);
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_start(timer, timeout_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&host_lock);
+    esp_err_t err = timer->running ? ESP_OK : ESP_ERR_INVALID_STATE;
+    timer->running = false;
+    pthread_mutex_unlock(&host_lock);
+    return err;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&host_lock);
+    esp_err_t err = timer->running ? ESP_ERR_INVALID_STATE : ESP_OK;
+    if (err == ESP_OK)
+    {
+        timer->used = false;
+    }
+    pthread_mutex_unlock(&host_lock);
+    return err;
+}
+
+void esp_timer_isr_dispatch_need_yield(void)
+{
+}
+
+esp_timer_handle_t host_timer_find(const char *name)
+{
+    pthread_mutex_lock(&host_lock);
+    esp_timer_handle_t found = NULL;
+    for (int i = 0; i < HOST_MAX_TIMERS && !found; ++i)
+    {
+        if (timers[i].used && strcmp(timers[i].name, name) == 0)
+        {
+            found = &timers[i];
+        }
+    }
+    pthread_mutex_unlock(&host_lock);
+    return found;
+}
+
+bool host_timer_running(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&host_lock);
+    bool running = timer && timer->used && timer->running;
+    pthread_mutex_unlock(&host_lock);
+    return running;
+}
+
+esp_timer_dispatch_t host_timer_dispatch(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&host_lock);
+    esp_timer_dispatch_t dispatch = timer ? timer->dispatch : ESP_TIMER_TASK;
+    pthread_mutex_unlock(&host_lock);
+    return dispatch;
+}
+
+uint64_t host_timer_period_us(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&host_lock);
+    uint64_t period = timer ? timer->period_us : 0;
+    pthread_mutex_unlock(&host_lock);
+    return period;
+}
+
+void host_timer_fire(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&host_lock);
+    esp_timer_cb_t callback = timer->callback;
+    void *arg = timer->arg;
+    pthread_mutex_unlock(&host_lock);
+    callback(arg);
+}
+
+void host_fail_timer_create(bool fail)
+{
+    pthread_mutex_lock(&host_lock);
+    fail_timer_create = fail;
+    pthread_mutex_unlock(&host_lock);
+}
+
+// Tasks
+
+static void *task_main(void *arg)
+{
+    struct host_task *task = arg;
+    current_task = task;
+    task->function(task->arg);
+
+    pthread_mutex_lock(&host_lock);
+    task->exited = true;
+    pthread_cond_broadcast(&state_changed);
+    pthread_mutex_unlock(&host_lock);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core)
+{
+    (void)stack_depth;
+    (void)priority;
+    (void)core;
+
+    pthread_mutex_lock(&host_lock);
+    self(); // The creating thread gets its slot first
+    if (task_count == HOST_MAX_TASKS)
+    {
+        pthread_mutex_unlock(&host_lock);
+        return pdFAIL;
+    }
+    struct host_task *task = &tasks[task_count++];
+    memset(task, 0, sizeof(*task));
+    snprintf(task->name, sizeof(task->name), "%s", name);
+    task->function = function;
+    task->arg = arg;
+    if (created)
+    {
+        *created = task;
+    }
+    pthread_mutex_unlock(&host_lock);
+
+    if (pthread_create(&task->thread, NULL, task_main, task) != 0)
+    {
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *created)
+{
+    return xTaskCreatePinnedToCore(function, name, stack_depth, arg, priority, created, tskNO_AFFINITY);
+}
+
+// Another task is deleted at its next wait; a task deleting itself exits
+void vTaskDelete(TaskHandle_t task)
+{
+    pthread_mutex_lock(&host_lock);
+    struct host_task *me = self();
+    if (task == NULL || task == me)
+    {
+        me->deleted = true;
+        exit_if_deleted(me);
+    }
+    task->deleted = true;
+    pthread_cond_broadcast(&state_changed);
+    pthread_mutex_unlock(&host_lock);
+}
+
+// Real time: only used to let drivers settle and to poll
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec delay = {.tv_sec = ticks / 1000, .tv_nsec = (long)(ticks % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake, TickType_t period)
+{
+    *previous_wake += period;
+    vTaskDelay(period);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / (portTICK_PERIOD_MS * 1000));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    pthread_mutex_lock(&host_lock);
+    TaskHandle_t task = self();
+    pthread_mutex_unlock(&host_lock);
+    return task;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    pthread_mutex_lock(&host_lock);
+    struct host_task *task = self();
+    int64_t deadline = deadline_us(ticks_to_wait);
+
+    task->waits++;
+    task->waiting = true;
+    pthread_cond_broadcast(&state_changed);
+    while (task->notifications == 0 && !expired(deadline))
+    {
+        exit_if_deleted(task);
+        pthread_cond_wait(&state_changed, &host_lock);
+    }
+    task->waiting = false;
+    exit_if_deleted(task);
+
+    uint32_t value = task->notifications;
+    if (value > 0)
+    {
+        task->notifications = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&host_lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&host_lock);
+    task->notifications++;
+    pthread_cond_broadcast(&state_changed);
+    pthread_mutex_unlock(&host_lock);
+    return pdPASS;
+}
+
+// No interrupts on the host: a notification is a notification
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higher_priority_woken)
+{
+    xTaskNotifyGive(task);
+    if (higher_priority_woken)
+    {
+        *higher_priority_woken = pdTRUE;
+    }
+}
+
+int xPortGetCoreID(void)
+{
+    return 0;
+}
+
+uint32_t host_task_waits(TaskHandle_t task)
+{
+    pthread_mutex_lock(&host_lock);
+    uint32_t waits = task->waits;
+    pthread_mutex_unlock(&host_lock);
+    return waits;
+}
+
+void host_task_wait_blocked(TaskHandle_t task, uint32_t waits)
+{
+    pthread_mutex_lock(&host_lock);
+    while (!task->exited && !(task->waiting && task->waits >= waits && task->notifications == 0))
+    {
+        pthread_cond_wait(&state_changed, &host_lock);
+    }
+    pthread_mutex_unlock(&host_lock);
+}
+
+bool host_task_alive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&host_lock);
+    bool alive = task && !task->deleted && !task->exited;
+    pthread_mutex_unlock(&host_lock);
+    return alive;
+}
+
+TaskHandle_t host_task_find(const char *name)
+{
+    pthread_mutex_lock(&host_lock);
+    TaskHandle_t found = NULL;
+    for (int i = task_count - 1; i >= 0 && !found; --i)
+    {
+        if (strcmp(tasks[i].name, name) == 0)
+        {
+            found = &tasks[i];
+        }
+    }
+    pthread_mutex_unlock(&host_lock);
+    return found;
+}
+
+// Semaphores: a binary semaphore starts empty, a mutex starts given
+
+static SemaphoreHandle_t semaphore_create(uint32_t count)
+{
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (sem)
+    {
+        sem->count = count;
+    }
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+    pthread_mutex_lock(&host_lock);
+    int64_t deadline = deadline_us(ticks_to_wait);
+    while (sem->count == 0 && !expired(deadline))
+    {
+        pthread_cond_wait(&state_changed, &host_lock);
+    }
+    BaseType_t taken = (sem->count > 0) ? pdTRUE : pdFALSE;
+    if (taken)
+    {
+        sem->count--;
+    }
+    pthread_mutex_unlock(&host_lock);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&host_lock);
+    BaseType_t given = (sem->count == 0) ? pdTRUE : pdFALSE;
+    sem->count = 1;
+    pthread_cond_broadcast(&state_changed);
+    pthread_mutex_unlock(&host_lock);
+    return given;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    free(sem);
+}
+
+// esp_dmx
+
+static host_dmx_port_t *dmx_port(dmx_port_t port)
+{
+    return (port >= 0 && port < DMX_NUM_MAX) ? &dmx_ports[port] : NULL;
+}
+
+bool dmx_driver_install(dmx_port_t port, dmx_config_t *config, void *personalities, int personality_count)
+{
+    (void)config;
+    (void)personalities;
+    (void)personality_count;
+
+    host_dmx_port_t *p = dmx_port(port);
+    pthread_mutex_lock(&host_lock);
+    bool ok = p && !p->installed && !dmx_fail_install[port];
+    if (ok)
+    {
+        memset(p, 0, sizeof(*p));
+        p->installed = true;
+    }
+    pthread_mutex_unlock(&host_lock);
+    return ok;
+}
+
+bool dmx_driver_delete(dmx_port_t port)
+{
+    host_dmx_port_t *p = dmx_port(port);
+    pthread_mutex_lock(&host_lock);
+    bool ok = p && p->installed;
+    if (ok)
+    {
+        p->installed = false;
+    }
+    pthread_mutex_unlock(&host_lock);
+    return ok;
+}
+
+bool dmx_set_pin(dmx_port_t port, int tx_pin, int rx_pin, int rts_pin)
+{
+    host_dmx_port_t *p = dmx_port(port);
+    pthread_mutex_lock(&host_lock);
+    bool ok = p && p->installed;
+    if (ok)
+    {
+        p->tx_pin = tx_pin;
+        p->rx_pin = rx_pin;
+        p->en_pin = rts_pin;
+    }
+    pthread_mutex_unlock(&host_lock);
+    return ok;
+}
+
+size_t dmx_write_offset(dmx_port_t port, size_t offset, const void *source, size_t size)
+{
+    host_dmx_port_t *p = dmx_port(port);
+    pthread_mutex_lock(&host_lock);
+    if (!p || !p->installed || offset >= DMX_PACKET_SIZE)
+    {
+        pthread_mutex_unlock(&host_lock);
+        return 0;
+    }
+    if (size > DMX_PACKET_SIZE - offset)
+    {
+        size = DMX_PACKET_SIZE - offset;
+    }
+    memcpy(p->buffer + offset, source, size);
+    p->writes++;
+    p->bytes_written += (uint32_t)size;
+    pthread_mutex_unlock(&host_lock);
+    return size;
+}
+
+size_t dmx_write(dmx_port_t port, const void *source, size_t size)
+{
+    return dmx_write_offset(port, 0, source, size);
+}
+
+bool dmx_wait_sent(dmx_port_t port, TickType_t wait_ticks)
+{
+    (void)wait_ticks;
+    host_dmx_port_t *p = dmx_port(port);
+    return p && p->installed;
+}
+
+size_t dmx_send_num(dmx_port_t port, size_t size)
+{
+    host_dmx_port_t *p = dmx_port(port);
+    pthread_mutex_lock(&host_lock);
+    if (!p || !p->installed)
+    {
+        pthread_mutex_unlock(&host_lock);
+        return 0;
+    }
+    if (size > DMX_PACKET_SIZE)
+    {
+        size = DMX_PACKET_SIZE;
+    }
+    memcpy(p->wire, p->buffer, size);
+    p->wire_size = size;
+    p->sends++;
+    pthread_mutex_unlock(&host_lock);
+    return size;
+}
+
+size_t dmx_send(dmx_port_t port)
+{
+    return dmx_send_num(port, DMX_PACKET_SIZE);
+}
+
+const host_dmx_port_t *host_dmx_port(dmx_port_t port)
+{
+    static host_dmx_port_t copy;
+    host_dmx_port_t *p = dmx_port(port);
+    pthread_mutex_lock(&host_lock);
+    copy = p ? *p : (host_dmx_port_t){0};
+    pthread_mutex_unlock(&host_lock);
+    return &copy;
+}
+
+void host_dmx_fail_install(dmx_port_t port, bool fail)
+{
+    pthread_mutex_lock(&host_lock);
+    if (port >= 0 && port < DMX_NUM_MAX)
+    {
+        dmx_fail_install[port] = fail;
+    }
+    pthread_mutex_unlock(&host_lock);
+}
+
+// GPIO
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    (void)config;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(int gpio_num, uint32_t level)
+{
+    (void)gpio_num;
+    (void)level;
+    return ESP_OK;
+}
+
+// esp_netif: no interfaces
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key)
+{
+    (void)if_key;
+    return NULL;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *netif, esp_netif_ip_info_t *ip_info)
+{
+    (void)netif;
+    (void)ip_info;
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_netif_get_mac(esp_netif_t *netif, uint8_t mac[])
+{
+    (void)netif;
+    (void)mac;
+    return ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_netif_get_hostname(esp_netif_t *netif, const char **hostname)
+{
+    (void)netif;
+    (void)hostname;
+    return ESP_ERR_INVALID_STATE;
+}
+
+// NVS: one flat table of namespace/key entries
+
+#define HOST_NVS_ENTRIES 32
+#define HOST_NVS_NAME_MAX 16
+#define HOST_NVS_HANDLES 8
+
+typedef enum
+{
+    NVS_TYPE_BLOB,
+    NVS_TYPE_U32,
+    NVS_TYPE_U8
+} nvs_type_t;
+
+typedef struct
+{
+    bool used;
+    char space[HOST_NVS_NAME_MAX];
+    char key[HOST_NVS_NAME_MAX];
+    nvs_type_t type;
+    size_t length;
+    uint8_t *data;
+} nvs_entry_t;
+
+typedef struct
+{
+    bool open;
+    bool writable;
+    char space[HOST_NVS_NAME_MAX];
+} nvs_open_t;
+
+static nvs_entry_t nvs_entries[HOST_NVS_ENTRIES];
+static nvs_open_t nvs_handles[HOST_NVS_HANDLES];
+
+esp_err_t nvs_flash_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    host_nvs_erase();
+    return ESP_OK;
+}
+
+void host_nvs_erase(void)
+{
+    pthread_mutex_lock(&host_lock);
+    for (int i = 0; i < HOST_NVS_ENTRIES; ++i)
+    {
+        free(nvs_entries[i].data);
+        memset(&nvs_entries[i], 0, sizeof(nvs_entries[i]));
+    }
+    pthread_mutex_unlock(&host_lock);
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t mode, nvs_handle_t *out_handle)
+{
+    if (strlen(name) >= HOST_NVS_NAME_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&host_lock);
+    esp_err_t err = ESP_ERR_NO_MEM;
+    for (int i = 0; i < HOST_NVS_HANDLES; ++i)
+    {
+        if (!nvs_handles[i].open)
+        {
+            nvs_handles[i].open = true;
+            nvs_handles[i].writable = (mode == NVS_READWRITE);
+            snprintf(nvs_handles[i].space, sizeof(nvs_handles[i].space), "%s", name);
+            *out_handle = (nvs_handle_t)i + 1;
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&host_lock);
+    return err;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    pthread_mutex_lock(&host_lock);
+    if (handle >= 1 && handle <= HOST_NVS_HANDLES)
+    {
+        nvs_handles[handle - 1].open = false;
+    }
+    pthread_mutex_unlock(&host_lock);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return (handle >= 1 && handle <= HOST_NVS_HANDLES) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+// Caller holds host_lock
+static nvs_open_t *nvs_handle_get(nvs_handle_t handle)
+{
+    if (handle < 1 || handle > HOST_NVS_HANDLES || !nvs_handles[handle - 1].open)
+    {
+        return NULL;
+    }
+    return &nvs_handles[handle - 1];
+}
+
+// Caller holds host_lock
+static nvs_entry_t *nvs_find(const nvs_open_t *h, const char *key)
+{
+    for (int i = 0; i < HOST_NVS_ENTRIES; ++i)
+    {
+        if (nvs_entries[i].used && strcmp(nvs_entries[i].space, h->space) == 0 &&
+            strcmp(nvs_entries[i].key, key) == 0)
+        {
+            return &nvs_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t nvs_get(nvs_handle_t handle, const char *key, nvs_type_t type, void *out, size_t *length)
+{
+    pthread_mutex_lock(&host_lock);
+    nvs_open_t *h = nvs_handle_get(handle);
+    nvs_entry_t *e = h ? nvs_find(h, key) : NULL;
+    esp_err_t err = ESP_OK;
+    if (!h)
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+    else if (!e)
+    {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    }
+    else if (e->type != type)
+    {
+        err = ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    else if (out == NULL)
+    {
+        *length = e->length; // Size query
+    }
+    else if (*length < e->length)
+    {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    else
+    {
+        memcpy(out, e->data, e->length);
+        *length = e->length;
+    }
+    pthread_mutex_unlock(&host_lock);
+    return err;
+}
+
+static esp_err_t nvs_set(nvs_handle_t handle, const char *key, nvs_type_t type, const void *value, size_t length)
+{
+    if (strlen(key) >= HOST_NVS_NAME_MAX)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&host_lock);
+    nvs_open_t *h = nvs_handle_get(handle);
+    esp_err_t err = ESP_OK;
+    if (!h)
+    {
+        err = ESP_ERR_INVALID_ARG;
+    }
+    else if (!h->writable)
+    {
+        err = ESP_ERR_NVS_READ_ONLY;
+    }
+    else
+    {
+        nvs_entry_t *e = nvs_find(h, key);
+        for (int i = 0; i < HOST_NVS_ENTRIES && !e; ++i)
+        {
+            if (!nvs_entries[i].used)
+            {
+                e = &nvs_entries[i];
+                e->used = true;
+                snprintf(e->space, sizeof(e->space), "%s", h->space);
+                snprintf(e->key, sizeof(e->key), "%s", key);
+            }
+        }
+        if (!e)
+        {
+            err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+        }
+        else
+        {
+            free(e->data);
+            e->data = malloc(length ? length : 1);
+            memcpy(e->data, value, length);
+            e->length = length;
+            e->type = type;
+        }
+    }
+    pthread_mutex_unlock(&host_lock);
+    return err;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    return nvs_get(handle, key, NVS_TYPE_BLOB, out_value, length);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    return nvs_set(handle, key, NVS_TYPE_BLOB, value, length);
+}
+
+esp_err_t nvs_get_u32(nvs_handle_t handle, const char *key, uint32_t *out_value)
+{
+    size_t length = sizeof(*out_value);
+    return nvs_get(handle, key, NVS_TYPE_U32, out_value, &length);
+}
+
+esp_err_t nvs_set_u32(nvs_handle_t handle, const char *key, uint32_t value)
+{
+    return nvs_set(handle, key, NVS_TYPE_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u8(nvs_handle_t handle, const char *key, uint8_t *out_value)
+{
+    size_t length = sizeof(*out_value);
+    return nvs_get(handle, key, NVS_TYPE_U8, out_value, &length);
+}
+
+esp_err_t nvs_set_u8(nvs_handle_t handle, const char *key, uint8_t value)
+{
+    return nvs_set(handle, key, NVS_TYPE_U8, &value, sizeof(value));
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// lwIP's BSD socket API is the host's
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
@@ -0,0 +1,28 @@
+#include "my_led.h"
+
+// Host stand-in for the my_led component: the host has no status LED
+void my_led_init(int gpio)
+{
+    (void)gpio;
+}
+
+void my_led_blink(int times, int delay_ms)
+{
+    (void)times;
+    (void)delay_ms;
+}
+
+void my_led_set(bool on)
+{
+    (void)on;
+}
+
+void my_led_set_wifi_status(bool connected)
+{
+    (void)connected;
+}
+
+void my_led_set_dmx_error(bool error)
+{
+    (void)error;
+}
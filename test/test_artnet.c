@@ -0,0 +1,251 @@
+// Art-Net receiver: ArtDmx/ArtPoll parsing on wire-format packets, the
+// Port-Address filter and sequence check, ArtPollReply, and what frames of
+// different lengths do to running fades
+#include <string.h>
+
+#include "server_harness.h"
+
+// ArtDmx, Port-Address 0:0:0, sequence 1, two slots
+static const uint8_t artdmx_two_slots[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00, // ID
+    0x00, 0x50,                               // OpDmx, little endian
+    0x00, 0x0e,                               // ProtVer 14
+    0x01,                                     // Sequence
+    0x00,                                     // Physical
+    0x00, 0x00,                               // SubUni, Net
+    0x00, 0x02,                               // Length, big endian
+    0xff, 0x80};
+
+// ArtPoll, ProtVer 14, Flags 0x06, DiagPriority 0
+static const uint8_t artpoll[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x20,
+    0x00, 0x0e,
+    0x06, 0x00};
+
+// ArtDmx header for sequence, Port-Address and length; slots are appended
+static size_t artdmx(uint8_t *buf, uint8_t sequence, uint16_t port_address, const uint8_t *slots, uint16_t length)
+{
+    memcpy(buf, artdmx_two_slots, ARTNET_DMX_HEADER_SIZE);
+    buf[12] = sequence;
+    buf[14] = (uint8_t)(port_address & 0xFF);
+    buf[15] = (uint8_t)(port_address >> 8);
+    buf[16] = (uint8_t)(length >> 8);
+    buf[17] = (uint8_t)(length & 0xFF);
+    memcpy(buf + ARTNET_DMX_HEADER_SIZE, slots, length);
+    return ARTNET_DMX_HEADER_SIZE + length;
+}
+
+static void test_parse(void)
+{
+    artnet_init(artnet_port_address(0, 0, 0), 2);
+    artnet_reset_stats();
+    artnet_publish_stats();
+
+    CHECK(artnet_is_packet(artdmx_two_slots, sizeof(artdmx_two_slots)));
+    CHECK_EQ(artnet_get_opcode(artdmx_two_slots), ARTNET_OP_DMX);
+    artnet_dmx_t dmx;
+    CHECK_EQ(artnet_parse_dmx(artdmx_two_slots, sizeof(artdmx_two_slots), &dmx), ARTNET_OK);
+    CHECK_EQ(dmx.sequence, 1);
+    CHECK_EQ(dmx.port_address, 0);
+    CHECK_EQ(dmx.length, 2);
+    CHECK(dmx.data == artdmx_two_slots + ARTNET_DMX_HEADER_SIZE);
+    CHECK_EQ(dmx.data[0], 0xff);
+    CHECK_EQ(dmx.data[1], 0x80);
+
+    CHECK(artnet_is_packet(artpoll, sizeof(artpoll)));
+    CHECK_EQ(artnet_get_opcode(artpoll), ARTNET_OP_POLL);
+    CHECK_EQ(artnet_parse_poll(artpoll, sizeof(artpoll)), ARTNET_OK);
+    CHECK_EQ(artnet_parse_dmx(artpoll, sizeof(artpoll), &dmx), ARTNET_ERR_HEADER);
+
+    // Malformed ArtDmx
+    uint8_t buf[ARTNET_DMX_HEADER_SIZE + DMX_UNIVERSE_SIZE + 2];
+    memcpy(buf, artdmx_two_slots, sizeof(artdmx_two_slots));
+    CHECK(!artnet_is_packet(buf, ARTNET_HEADER_SIZE - 1));
+    CHECK_EQ(artnet_parse_dmx(buf, ARTNET_DMX_HEADER_SIZE - 1, &dmx), ARTNET_ERR_HEADER);
+    CHECK_EQ(artnet_parse_dmx(buf, sizeof(artdmx_two_slots) - 1, &dmx), ARTNET_ERR_LENGTH); // Truncated
+    buf[11] = 13;
+    CHECK_EQ(artnet_parse_dmx(buf, sizeof(artdmx_two_slots), &dmx), ARTNET_ERR_VERSION);
+    buf[11] = 14;
+    buf[17] = 0;
+    CHECK_EQ(artnet_parse_dmx(buf, sizeof(artdmx_two_slots), &dmx), ARTNET_ERR_LENGTH);
+    buf[16] = 0x02;
+    buf[17] = 0x02; // 514
+    CHECK_EQ(artnet_parse_dmx(buf, sizeof(buf), &dmx), ARTNET_ERR_LENGTH);
+    buf[0] = 'a';
+    CHECK(!artnet_is_packet(buf, sizeof(buf)));
+
+    // 15-bit Port-Address: Net 0x12, SubNet 3, Universe 4
+    uint8_t slot = 7;
+    size_t len = artdmx(buf, 0, artnet_port_address(0x12, 3, 4), &slot, 1);
+    CHECK_EQ(artnet_parse_dmx(buf, len, &dmx), ARTNET_OK);
+    CHECK_EQ(dmx.port_address, 0x1234);
+    CHECK_EQ(dmx.length, 1); // Odd lengths are tolerated
+
+    artnet_publish_stats();
+    artnet_stats_t stats = artnet_get_stats();
+    CHECK_EQ(stats.dmx_received, 2);
+    CHECK_EQ(stats.polls_received, 1);
+    CHECK_EQ(stats.packets_invalid, 6);
+    TEST_PASS("parse");
+}
+
+static void test_accept(void)
+{
+    // Universe 1 listens on 1:2:3, universe 2 on the next Port-Address
+    uint16_t base = artnet_port_address(1, 2, 3);
+    artnet_init(base, 2);
+    artnet_reset_stats();
+    artnet_publish_stats();
+
+    artnet_dmx_t dmx = {.sequence = 0, .port_address = base, .length = 2};
+    int universe = -1;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OK);
+    CHECK_EQ(universe, 0);
+    dmx.port_address = base + 1;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OK);
+    CHECK_EQ(universe, 1);
+    dmx.port_address = base + 2;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_NOT_OURS);
+    dmx.port_address = base - 1;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_NOT_OURS);
+
+    // Sequence: newer frames pass, older ones are dropped, across the wrap
+    dmx.port_address = base;
+    dmx.sequence = 250;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OK);
+    dmx.sequence = 249;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OUT_OF_ORDER);
+    dmx.sequence = 250;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OUT_OF_ORDER);
+    dmx.sequence = 3;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OK);
+    dmx.sequence = 0; // Sequencing off
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OK);
+
+    // A restarted sender is taken over after ARTNET_SEQUENCE_RESYNC drops
+    dmx.sequence = 200;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OK);
+    dmx.sequence = 150;
+    for (int i = 0; i < ARTNET_SEQUENCE_RESYNC; ++i)
+    {
+        CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OUT_OF_ORDER);
+    }
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OK);
+    dmx.sequence = 151;
+    CHECK_EQ(artnet_accept_dmx(&dmx, &universe), ARTNET_OK);
+
+    artnet_publish_stats();
+    artnet_stats_t stats = artnet_get_stats();
+    CHECK_EQ(stats.dmx_accepted, 8);
+    CHECK_EQ(stats.dmx_filtered, 2);
+    CHECK_EQ(stats.dmx_out_of_order, 2 + ARTNET_SEQUENCE_RESYNC);
+    TEST_PASS("accept");
+}
+
+static void test_poll_reply(void)
+{
+    uint16_t base = artnet_port_address(0x12, 3, 4);
+    artnet_init(base, 2);
+    artnet_node_info_t info = {
+        .ip = {192, 168, 1, 50},
+        .mac = {0x24, 0x0a, 0xc4, 0x01, 0x02, 0x03},
+        .short_name = "udp2dmx",
+        .long_name = "udp2dmx ESP32 DMX gateway"};
+
+    uint8_t reply[ARTNET_POLL_REPLY_SIZE];
+    CHECK_EQ(artnet_build_poll_reply(reply, &info, 1), ARTNET_POLL_REPLY_SIZE);
+    CHECK(artnet_is_packet(reply, sizeof(reply)));
+    CHECK_EQ(artnet_get_opcode(reply), ARTNET_OP_POLL_REPLY);
+    CHECK(memcmp(&reply[10], info.ip, 4) == 0);
+    CHECK_EQ(reply[14] | (reply[15] << 8), ARTNET_PORT);
+    CHECK_EQ(reply[18], 0x12);                   // NetSwitch
+    CHECK_EQ(reply[19], 3);                      // SubSwitch
+    CHECK_EQ(reply[190], 5);                     // SwOut of base + 1
+    CHECK_EQ(reply[211], 2);                     // BindIndex
+    CHECK_EQ(reply[182], 0x00);                  // No output yet
+    CHECK(strcmp((const char *)&reply[26], "udp2dmx") == 0);
+    CHECK(strcmp((const char *)&reply[44], info.long_name) == 0);
+    CHECK(memcmp(&reply[201], info.mac, 6) == 0);
+    CHECK(memcmp(&reply[207], info.ip, 4) == 0);
+
+    // GoodOutput follows accepted frames
+    artnet_dmx_t dmx = {.port_address = base + 1, .length = 2};
+    CHECK_EQ(artnet_accept_dmx(&dmx, NULL), ARTNET_OK);
+    artnet_build_poll_reply(reply, &info, 1);
+    CHECK_EQ(reply[182], 0x80);
+    artnet_build_poll_reply(reply, &info, 0);
+    CHECK_EQ(reply[182], 0x00);
+    TEST_PASS("poll_reply");
+}
+
+// Only a full 512-slot frame takes over the universe
+static void test_short_frame_keeps_fades(void)
+{
+    server_start(1);
+    udp_server_stats_t before = udp_server_get_stats();
+
+    CHECK_EQ(dmx_set_channel(0, 100, 255, 2000), DMX_CMD_SUCCESS);
+    CHECK_EQ(dmx_set_channel(0, 2, 255, 2000), DMX_CMD_SUCCESS);
+    tick();
+    CHECK(dmx_is_channel_fading(0, 100));
+
+    // Two slots: channels 1 and 2 are written, the fade on 2 is replaced
+    deliver(artdmx_two_slots, sizeof(artdmx_two_slots));
+    tick();
+    CHECK_EQ(wire(0, 1), 0xff);
+    CHECK_EQ(wire(0, 2), 0x80);
+    CHECK(!dmx_is_channel_fading(0, 2));
+    CHECK(dmx_is_channel_fading(0, 100));
+    tick();
+    CHECK_EQ(wire(0, 2), 0x80);
+
+    // A frame that ends at channel 100 replaces that fade too
+    uint8_t slots[DMX_UNIVERSE_SIZE];
+    uint8_t packet[ARTNET_DMX_HEADER_SIZE + DMX_UNIVERSE_SIZE];
+    memset(slots, 9, sizeof(slots));
+    CHECK_EQ(dmx_set_channel(0, 300, 255, 2000), DMX_CMD_SUCCESS);
+    deliver(packet, artdmx(packet, 2, 0, slots, 100));
+    tick();
+    CHECK(!dmx_is_channel_fading(0, 100));
+    CHECK_EQ(wire(0, 100), 9);
+    CHECK(dmx_is_channel_fading(0, 300));
+
+    // A full frame stops every fade; slot 512 has no channel
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i)
+    {
+        slots[i] = (uint8_t)i;
+    }
+    deliver(packet, artdmx(packet, 3, 0, slots, DMX_UNIVERSE_SIZE));
+    tick();
+    CHECK_EQ(dmx_get_active_fade_count(), 0);
+    CHECK_EQ(wire(0, 300), (uint8_t)299);
+    CHECK_EQ(wire(0, 511), (uint8_t)510);
+
+    // Filtered, out-of-order and malformed frames change nothing
+    slots[0] = 77;
+    deliver(packet, artdmx(packet, 4, 1, slots, 2));  // Port-Address not ours
+    deliver(packet, artdmx(packet, 2, 0, slots, 2));  // Older sequence
+    size_t len = artdmx(packet, 5, 0, slots, 2);
+    packet[17] = 0;                                   // Length 0
+    deliver(packet, len);
+    deliver(artpoll, sizeof(artpoll));                // No interface, no reply
+    tick();
+    CHECK_EQ(wire(0, 1), 0);
+
+    udp_server_stats_t stats = udp_server_get_stats();
+    CHECK_EQ(stats.packets_received - before.packets_received, 7);
+    CHECK_EQ(stats.packets_processed - before.packets_processed, 4);
+    CHECK_EQ(stats.packets_invalid - before.packets_invalid, 1);
+    server_stop();
+    TEST_PASS("short_frame_keeps_fades");
+}
+
+int main(void)
+{
+    test_parse();
+    test_accept();
+    test_poll_reply();
+    test_short_frame_keeps_fades();
+    return 0;
+}
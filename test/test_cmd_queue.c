@@ -0,0 +1,185 @@
+// Two-thread stress test of the SPSC command queue: a producer thread
+// pushes commands, universes and spans of varying payload sizes, alone
+// and in batches, while a consumer thread drains. Every entry must arrive
+// once, in order, with its payload intact.
+#include "cmd_queue.h"
+#include "dmx_manager.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "test_util.h"
+
+#define ENTRIES 400000
+
+static uint32_t expected_seq = 0; // Consumer only
+static uint32_t max_depth = 0;
+
+static uint8_t pattern(uint32_t seq, int i)
+{
+    return (uint8_t)(seq * 31u + (uint32_t)i);
+}
+
+static size_t payload_length(uint32_t seq)
+{
+    switch (seq % 4)
+    {
+    case 0:
+        return DMX_UNIVERSE_SIZE; // Universe
+    case 1:
+        return 1 + seq % 300; // Span
+    case 2:
+        return 1 + seq % 64; // Command with levels
+    default:
+        return 0; // Command without payload
+    }
+}
+
+static void check_entry(const cmd_queue_entry_t *entry, const uint8_t *payload)
+{
+    uint32_t seq = (entry->kind == CMD_QUEUE_COMMAND) ? (uint32_t)entry->cmd.value : (uint32_t)entry->received_us;
+    if (seq != expected_seq)
+    {
+        fprintf(stderr, "entry %u arrived, expected %u\n", seq, expected_seq);
+        exit(1);
+    }
+
+    static const cmd_queue_kind_t kinds[4] = {CMD_QUEUE_UNIVERSE, CMD_QUEUE_SPAN, CMD_QUEUE_COMMAND, CMD_QUEUE_COMMAND};
+    size_t len = payload_length(seq);
+    CHECK_EQ(entry->kind, kinds[seq % 4]);
+    CHECK_EQ(entry->length, len);
+    CHECK((len == 0) == (payload == NULL));
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (payload[i] != pattern(seq, (int)i))
+        {
+            fprintf(stderr, "entry %u: payload byte %zu corrupted\n", seq, i);
+            exit(1);
+        }
+    }
+    if (entry->kind == CMD_QUEUE_SPAN)
+    {
+        CHECK_EQ(entry->start, 1 + seq % 200);
+    }
+    expected_seq++;
+}
+
+static bool push(uint32_t seq)
+{
+    uint8_t data[DMX_UNIVERSE_SIZE];
+    size_t len = payload_length(seq);
+    for (size_t i = 0; i < len; ++i)
+    {
+        data[i] = pattern(seq, (int)i);
+    }
+
+    switch (seq % 4)
+    {
+    case 0:
+        return cmd_queue_push_universe(0, data, len, seq);
+    case 1:
+        return cmd_queue_push_span(0, 1 + seq % 200, data, len, 0, seq);
+    default:
+    {
+        udp_parsed_command_t cmd = {.type = UDP_CMD_SET_RANGE, .count = (int)len, .value = (int)seq};
+        cmd.payload = len ? data : NULL;
+        return cmd_queue_push_command(&cmd, seq);
+    }
+    }
+}
+
+static void *producer(void *arg)
+{
+    uint32_t seq = 0;
+    while (seq < ENTRIES)
+    {
+        // Every few entries a batch of up to 8, published as one
+        int batch = (seq % 7 == 0) ? 1 + (int)(seq / 7 % 8) : 0;
+        if (batch > 0)
+        {
+            cmd_queue_batch_begin();
+            int pushed = 0;
+            while (pushed < batch && seq < ENTRIES && push(seq))
+            {
+                seq++;
+                pushed++;
+            }
+            uint32_t depth = cmd_queue_batch_end();
+            if (depth > max_depth)
+            {
+                max_depth = depth;
+            }
+            if (pushed < batch)
+            {
+                sched_yield(); // Full: let the consumer catch up
+            }
+            continue;
+        }
+
+        while (!push(seq))
+        {
+            sched_yield();
+        }
+        seq++;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    while (expected_seq < ENTRIES)
+    {
+        if (cmd_queue_drain(check_entry) == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Two pushes into a batch stay invisible to the consumer until it ends;
+// a batch that does not fit leaves what was already staged intact
+static void test_batch_visibility(void)
+{
+    cmd_queue_reset();
+    udp_parsed_command_t cmd = {.type = UDP_CMD_CHANNEL, .value = 0};
+    cmd_queue_batch_begin();
+    CHECK(cmd_queue_push_command(&cmd, 0));
+    CHECK(cmd_queue_push_command(&cmd, 0));
+    CHECK_EQ(cmd_queue_depth(), 0);
+    CHECK_EQ(cmd_queue_drain(NULL), 0);
+    CHECK_EQ(cmd_queue_batch_end(), 2);
+
+    int pushed = 0;
+    cmd_queue_batch_begin();
+    for (int i = 0; i < CMD_QUEUE_LENGTH + 6; ++i)
+    {
+        pushed += cmd_queue_push_command(&cmd, 0);
+    }
+    CHECK_EQ(pushed, CMD_QUEUE_LENGTH - 2);
+    CHECK_EQ(cmd_queue_batch_end(), CMD_QUEUE_LENGTH);
+    CHECK_EQ(cmd_queue_drain(NULL), CMD_QUEUE_LENGTH);
+    TEST_PASS("batch_visibility");
+}
+
+static void test_stress(void)
+{
+    cmd_queue_reset();
+    pthread_t threads[2];
+    CHECK(pthread_create(&threads[0], NULL, consumer, NULL) == 0);
+    CHECK(pthread_create(&threads[1], NULL, producer, NULL) == 0);
+    pthread_join(threads[1], NULL);
+    pthread_join(threads[0], NULL);
+
+    CHECK_EQ(expected_seq, ENTRIES);
+    CHECK_EQ(cmd_queue_depth(), 0);
+    printf("%d entries, max depth after a batch %u\n", ENTRIES, max_depth);
+    TEST_PASS("stress");
+}
+
+int main(void)
+{
+    test_batch_visibility();
+    test_stress();
+    return 0;
+}
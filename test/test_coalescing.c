@@ -0,0 +1,247 @@
+// Per-frame write coalescing: commands run from the frame hook must leave
+// exactly the output that applying them one by one would, with the
+// superseded writes and fades counted
+#include <string.h>
+
+#include "fade_kernel.h"
+#include "render_harness.h"
+
+#define MODEL_CHANNELS 24
+#define MAX_FRAME_COMMANDS 16
+
+typedef enum
+{
+    OP_SET,
+    OP_FADE,
+    OP_MULTI,
+    OP_STOP_ALL
+} op_t;
+
+typedef struct
+{
+    op_t op;
+    int channel;
+    uint8_t values[3];
+    int fade_ms;
+} command_t;
+
+// Commands the frame hook runs on the next pass
+static command_t frame_commands[MAX_FRAME_COMMANDS];
+static int frame_command_count;
+
+static void run_frame_commands(void)
+{
+    for (int i = 0; i < frame_command_count; ++i)
+    {
+        const command_t *c = &frame_commands[i];
+        switch (c->op)
+        {
+        case OP_SET:
+        case OP_FADE:
+            dmx_set_channel(0, c->channel, c->values[0], c->fade_ms);
+            break;
+        case OP_MULTI:
+            dmx_set_multi_channels(0, c->channel, c->values, 3, c->fade_ms);
+            break;
+        case OP_STOP_ALL:
+            dmx_stop_all_fades(0);
+            break;
+        }
+    }
+    frame_command_count = 0;
+}
+
+// Reference: every command applied in order, as outside the frame hook
+typedef struct
+{
+    uint8_t data;
+    bool fading;
+    uint8_t start;
+    uint8_t target;
+    int duration_ms;
+    uint32_t start_ms;
+} model_slot_t;
+
+static model_slot_t model[MODEL_CHANNELS + 3];
+
+static void model_write(int ch, uint8_t value, int fade_ms, uint32_t now_ms)
+{
+    model_slot_t *m = &model[ch];
+    if (fade_ms > 0)
+    {
+        m->fading = true;
+        m->start = m->data;
+        m->target = value;
+        m->duration_ms = fade_ms;
+        m->start_ms = now_ms;
+    }
+    else
+    {
+        m->fading = false;
+        m->data = value;
+    }
+}
+
+static void model_apply(const command_t *c, uint32_t now_ms)
+{
+    switch (c->op)
+    {
+    case OP_SET:
+    case OP_FADE:
+        model_write(c->channel, c->values[0], c->fade_ms, now_ms);
+        break;
+    case OP_MULTI:
+        for (int i = 0; i < 3; ++i)
+        {
+            model_write(c->channel + i, c->values[i], c->fade_ms, now_ms);
+        }
+        break;
+    case OP_STOP_ALL:
+        for (int ch = 0; ch < MODEL_CHANNELS + 3; ++ch)
+        {
+            model[ch].fading = false;
+        }
+        break;
+    }
+}
+
+static void model_render(uint32_t now_ms)
+{
+    for (int ch = 0; ch < MODEL_CHANNELS + 3; ++ch)
+    {
+        model_slot_t *m = &model[ch];
+        if (!m->fading)
+        {
+            continue;
+        }
+        uint32_t elapsed = now_ms - m->start_ms;
+        if (elapsed >= (uint32_t)m->duration_ms)
+        {
+            m->data = m->target;
+            m->fading = false;
+        }
+        else
+        {
+            fade_kernel_t kernel = fade_kernel_prepare((uint32_t)m->duration_ms);
+            m->data = fade_kernel_value(&kernel, m->start, m->target, (uint32_t)m->duration_ms, elapsed);
+        }
+    }
+}
+
+static uint32_t rng_state = 0x2545F491;
+
+static uint32_t rng(uint32_t n)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % n;
+}
+
+static command_t random_command(void)
+{
+    command_t c = {0};
+    uint32_t kind = rng(20);
+    c.op = (kind < 8) ? OP_SET : (kind < 16) ? OP_FADE : (kind < 19) ? OP_MULTI : OP_STOP_ALL;
+    c.channel = 1 + (int)rng(MODEL_CHANNELS);
+    for (int i = 0; i < 3; ++i)
+    {
+        c.values[i] = (uint8_t)rng(256);
+    }
+    if (c.op == OP_FADE || (c.op == OP_MULTI && rng(2)))
+    {
+        c.fade_ms = 1 + (int)rng(400);
+    }
+    return c;
+}
+
+// Three writes to a channel in one frame: one is applied, two are counted
+static void test_superseded_writes(void)
+{
+    start(1);
+    dmx_manager_set_frame_hook(run_frame_commands);
+    dmx_manager_stats_t before = dmx_manager_get_stats();
+
+    frame_commands[0] = (command_t){.op = OP_SET, .channel = 5, .values = {10}};
+    frame_commands[1] = (command_t){.op = OP_SET, .channel = 5, .values = {20}};
+    frame_commands[2] = (command_t){.op = OP_FADE, .channel = 5, .values = {220}, .fade_ms = 100};
+    frame_commands[3] = (command_t){.op = OP_FADE, .channel = 5, .values = {120}, .fade_ms = 100};
+    frame_command_count = 4;
+    tick();
+
+    // The surviving fade starts from the last value written before it
+    CHECK_EQ(wire(0, 5), 20);
+    CHECK(dmx_is_channel_fading(0, 5));
+    dmx_manager_stats_t stats = dmx_manager_get_stats();
+    CHECK_EQ(stats.commands_coalesced - before.commands_coalesced, 2);
+    CHECK_EQ(stats.fades_started - before.fades_started, 1);
+    while (dmx_is_channel_fading(0, 5))
+    {
+        tick();
+    }
+    CHECK_EQ(wire(0, 5), 120);
+
+    // Stopping all fades drops the fades queued earlier in the frame
+    frame_commands[0] = (command_t){.op = OP_FADE, .channel = 6, .values = {255}, .fade_ms = 1000};
+    frame_commands[1] = (command_t){.op = OP_STOP_ALL};
+    frame_commands[2] = (command_t){.op = OP_FADE, .channel = 7, .values = {255}, .fade_ms = 1000};
+    frame_command_count = 3;
+    tick();
+    CHECK(!dmx_is_channel_fading(0, 6));
+    CHECK(dmx_is_channel_fading(0, 7));
+
+    dmx_manager_set_frame_hook(NULL);
+    stop();
+    TEST_PASS("superseded_writes");
+}
+
+// Random command mixes on a few channels, so most frames supersede
+// something; the wire must match the in-order model every frame
+static void test_matches_in_order(void)
+{
+    start(1);
+    dmx_manager_set_frame_hook(run_frame_commands);
+    memset(model, 0, sizeof(model));
+    dmx_manager_stats_t before = dmx_manager_get_stats();
+    int frames = 5000;
+
+    for (int f = 0; f < frames; ++f)
+    {
+        host_advance_us(host_timer_period_us(frame_timer));
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+        frame_command_count = (int)rng(MAX_FRAME_COMMANDS + 1);
+        for (int i = 0; i < frame_command_count; ++i)
+        {
+            frame_commands[i] = random_command();
+            model_apply(&frame_commands[i], now_ms);
+        }
+        model_render(now_ms);
+
+        uint32_t waits = host_task_waits(render);
+        host_timer_fire(frame_timer);
+        wait_pass(waits);
+
+        for (int ch = 1; ch < MODEL_CHANNELS + 3; ++ch)
+        {
+            if (wire(0, ch) != model[ch].data)
+            {
+                fprintf(stderr, "frame %d, channel %d: %d, expected %d\n", f, ch, wire(0, ch), model[ch].data);
+                exit(1);
+            }
+            CHECK_EQ(dmx_is_channel_fading(0, ch), model[ch].fading);
+        }
+    }
+
+    CHECK(dmx_manager_get_stats().commands_coalesced - before.commands_coalesced > (uint32_t)frames);
+    dmx_manager_set_frame_hook(NULL);
+    stop();
+    TEST_PASS("matches_in_order");
+}
+
+int main(void)
+{
+    test_superseded_writes();
+    test_matches_in_order();
+    return 0;
+}
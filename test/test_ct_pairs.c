@@ -0,0 +1,138 @@
+// CT pair table: fallbacks and ordering at resolve time, and pair reads on
+// other threads while the table is reloaded back to back. Also built with
+// ThreadSanitizer, which reports a rebuild that overlaps a read.
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "my_config.h"
+#include "test_util.h"
+
+static int ct_config[CT_CHANNELS];
+
+static void test_resolve(void)
+{
+    // Nothing resolved yet: the all-zero pair
+    ct_pair_t pair = get_ct_pair(10);
+    CHECK_EQ(pair.ct_ww, 0);
+    CHECK_EQ(pair.ct_cw, 0);
+    CHECK_EQ(pair.recip, 0);
+
+    ct_config[10] = 6500;
+    ct_config[11] = 2700;
+    ct_config[20] = 3000;
+    ct_config[511] = 25000;
+    ct_pairs_resolve(ct_config, 3500, 6700);
+
+    pair = get_ct_pair(10); // Reversed: warm on the second channel
+    CHECK_EQ(pair.ct_ww, 2700);
+    CHECK_EQ(pair.ct_cw, 6500);
+    CHECK_EQ(pair.ww_offset, 1);
+    CHECK_EQ(pair.recip, (uint32_t)(((1ULL << pair.shift) + 380000 - 1) / 380000));
+    CHECK(380000u <= (1u << (pair.shift - 8) / 2));
+
+    pair = get_ct_pair(11); // 2700 and nothing: default max on top
+    CHECK_EQ(pair.ct_ww, 2700);
+    CHECK_EQ(pair.ct_cw, 6700);
+    CHECK_EQ(pair.ww_offset, 0);
+
+    pair = get_ct_pair(19); // Nothing and 3000: default min below
+    CHECK_EQ(pair.ct_ww, 3000);
+    CHECK_EQ(pair.ct_cw, 3500);
+    CHECK_EQ(pair.ww_offset, 1);
+
+    pair = get_ct_pair(30); // Neither: the defaults
+    CHECK_EQ(pair.ct_ww, 3500);
+    CHECK_EQ(pair.ct_cw, 6700);
+
+    pair = get_ct_pair(511); // Clamped, paired with the default max
+    CHECK_EQ(pair.ct_ww, 6700);
+    CHECK_EQ(pair.ct_cw, CT_MAX_K);
+
+    pair = get_ct_pair(-1);
+    CHECK_EQ(pair.ct_ww, 3500);
+    pair = get_ct_pair(CT_CHANNELS);
+    CHECK_EQ(pair.ct_cw, 6700);
+
+    // A reload replaces everything
+    memset(ct_config, 0, sizeof(ct_config));
+    ct_pairs_resolve(ct_config, 2000, 9000);
+    pair = get_ct_pair(10);
+    CHECK_EQ(pair.ct_ww, 2000);
+    CHECK_EQ(pair.ct_cw, 9000);
+    CHECK_EQ(pair.ww_offset, 0);
+    TEST_PASS("resolve");
+}
+
+// Readers copy pairs while a writer reloads between two configurations;
+// every pair must be whole and from one of them
+static atomic_bool stop_readers;
+static ct_pair_t pair_a;
+static ct_pair_t pair_b;
+static atomic_long torn;
+static atomic_long reads;
+
+static void *pair_reader(void *arg)
+{
+    (void)arg;
+    long n = 0;
+    while (!atomic_load(&stop_readers))
+    {
+        for (int ch = 1; ch < CT_CHANNELS - 1; ++ch)
+        {
+            ct_pair_t pair = get_ct_pair(ch);
+            if (memcmp(&pair, &pair_a, sizeof(pair)) != 0 && memcmp(&pair, &pair_b, sizeof(pair)) != 0)
+            {
+                atomic_fetch_add(&torn, 1);
+            }
+        }
+        n += CT_CHANNELS - 2;
+        atomic_store(&reads, n); // Any reader's progress will do
+    }
+    return NULL;
+}
+
+static void test_reload_while_reading(void)
+{
+    // Every channel resolves to the same pair within one configuration
+    static int config_a[CT_CHANNELS];
+    static int config_b[CT_CHANNELS];
+    for (int ch = 1; ch < CT_CHANNELS; ++ch)
+    {
+        config_a[ch] = 2700;
+        config_b[ch] = 3100;
+    }
+    ct_pairs_resolve(config_a, 3500, 6700);
+    pair_a = get_ct_pair(1);
+    ct_pairs_resolve(config_b, 3500, 6700);
+    pair_b = get_ct_pair(1);
+    CHECK(memcmp(&pair_a, &pair_b, sizeof(pair_a)) != 0);
+
+    pthread_t readers[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        CHECK_EQ(pthread_create(&readers[i], NULL, pair_reader, NULL), 0);
+    }
+
+    // Reload until the readers have been through the table many times
+    for (long i = 0; i < 200 || atomic_load(&reads) < 200L * CT_CHANNELS; ++i)
+    {
+        ct_pairs_resolve((i & 1) ? config_b : config_a, 3500, 6700);
+    }
+    atomic_store(&stop_readers, true);
+    for (int i = 0; i < 3; ++i)
+    {
+        pthread_join(readers[i], NULL);
+    }
+
+    CHECK_EQ(atomic_load(&torn), 0);
+    TEST_PASS("reload_while_reading");
+}
+
+int main(void)
+{
+    test_resolve();
+    test_reload_while_reading();
+    return 0;
+}
@@ -0,0 +1,199 @@
+// Render task against the mocked esp_dmx backend, driven by the virtual
+// frame clock of the host layer
+#include "dmx_manager.h"
+#include "udp_protocol.h"
+
+#include <string.h>
+#include "freertos/task.h"
+#include "render_harness.h"
+
+static void test_idle_stops_clock(void)
+{
+    start(1); // First test: the counters start at zero
+    CHECK(host_timer_running(frame_timer));
+    CHECK_EQ(host_timer_dispatch(frame_timer), ESP_TIMER_ISR); // Not held back by the esp_timer task
+
+    // Nothing changes: the clock stops after DMX_IDLE_HOLD_FRAMES ticks
+    for (int i = 0; i < DMX_IDLE_HOLD_FRAMES - 1; ++i)
+    {
+        tick();
+        CHECK(host_timer_running(frame_timer));
+    }
+    tick();
+    CHECK(!host_timer_running(frame_timer));
+    dmx_manager_stats_t stats = dmx_manager_get_stats();
+    CHECK_EQ(stats.idle_sleeps, 1);
+    CHECK_EQ(stats.render_wakeups, DMX_IDLE_HOLD_FRAMES);
+
+    // Idle: no pass before the keep-alive is due, one resend when it is
+    uint32_t sends = host_dmx_port(DMX_NUM_1)->sends;
+    uint32_t waits = host_task_waits(render);
+    host_advance_us((DMX_IDLE_REFRESH_MS - 1) * 1000);
+    vTaskDelay(20);
+    CHECK_EQ(host_task_waits(render), waits);
+    host_advance_us(1000);
+    wait_pass(waits);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->sends, sends + 1);
+    CHECK(!host_timer_running(frame_timer));
+
+    stats = dmx_manager_get_stats();
+    CHECK_EQ(stats.render_wakeups, DMX_IDLE_HOLD_FRAMES + 1);
+    CHECK_EQ(stats.idle_sleeps, 1);
+    stop();
+    TEST_PASS("idle_stops_clock");
+}
+
+static void test_write_restarts_clock(void)
+{
+    start(1);
+    tick_until_idle();
+    dmx_manager_stats_t before = dmx_manager_get_stats();
+
+    // A write from another task renders right away and restarts the clock
+    uint32_t waits = host_task_waits(render);
+    CHECK_EQ(dmx_set_channel(0, 5, 200, 0), DMX_CMD_SUCCESS);
+    wait_pass(waits);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[5], 200);
+    CHECK(host_timer_running(frame_timer));
+    CHECK_EQ(dmx_manager_get_stats().jitter_samples, before.jitter_samples); // Not a tick
+
+    // A fade keeps it running until the fade is done
+    CHECK_EQ(dmx_set_channel(0, 6, 255, 300), DMX_CMD_SUCCESS);
+    int ticks = 0;
+    while (dmx_is_channel_fading(0, 6))
+    {
+        CHECK(host_timer_running(frame_timer));
+        tick();
+        ticks++;
+    }
+    CHECK(ticks >= 300 / DMX_FRAME_INTERVAL_MS);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[6], 255);
+    tick_until_idle();
+    CHECK_EQ(dmx_manager_get_stats().idle_sleeps, before.idle_sleeps + 1);
+
+    // A frame request from the command path does the same
+    waits = host_task_waits(render);
+    dmx_manager_request_frame();
+    wait_pass(waits);
+    CHECK(host_timer_running(frame_timer));
+    stop();
+    TEST_PASS("write_restarts_clock");
+}
+
+static void test_period_change_while_idle(void)
+{
+    start(1);
+    tick_until_idle();
+
+    // The keep-alive pass takes the new period without starting the clock
+    CHECK_EQ(dmx_manager_set_output(DMX_UNIVERSE_SIZE, 50), ESP_OK);
+    uint32_t waits = host_task_waits(render);
+    host_advance_us(DMX_IDLE_REFRESH_MS * 1000);
+    wait_pass(waits);
+    CHECK(!host_timer_running(frame_timer));
+    CHECK_EQ(dmx_manager_get_output_info().frame_period_us, 50000);
+
+    waits = host_task_waits(render);
+    dmx_manager_request_frame();
+    wait_pass(waits);
+    CHECK(host_timer_running(frame_timer));
+    CHECK_EQ(host_timer_period_us(frame_timer), 50000);
+
+    CHECK_EQ(dmx_manager_set_output(DMX_UNIVERSE_SIZE, DMX_FRAME_INTERVAL_MS), ESP_OK);
+    stop();
+    TEST_PASS("period_change_while_idle");
+}
+
+// Each universe has its own port, pins, buffer, fades and frame length
+static void test_two_universes(void)
+{
+    start(2);
+    const host_dmx_port_t *port1 = host_dmx_port(DMX_NUM_1);
+    CHECK_EQ(port1->tx_pin, 17);
+    CHECK_EQ(port1->en_pin, 21);
+    CHECK_EQ(host_dmx_port(DMX_NUM_2)->tx_pin, 25);
+    CHECK_EQ(host_dmx_port(DMX_NUM_2)->en_pin, 27);
+
+    CHECK_EQ(dmx_set_channel(0, 10, 100, 0), DMX_CMD_SUCCESS);
+    CHECK_EQ(dmx_set_channel(1, 10, 200, 0), DMX_CMD_SUCCESS);
+    CHECK_EQ(dmx_set_channel(1, 300, 7, 0), DMX_CMD_SUCCESS);
+    CHECK_EQ(dmx_set_channel(2, 10, 1, 0), DMX_CMD_ERROR_INVALID_UNIVERSE);
+    tick();
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[10], 100);
+    CHECK_EQ(host_dmx_port(DMX_NUM_2)->wire[10], 200);
+    CHECK_EQ(host_dmx_port(DMX_NUM_2)->wire[300], 7);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[300], 0);
+    CHECK_EQ(dmx_get_channel_value(0, 10), 100);
+    CHECK_EQ(dmx_get_channel_value(1, 10), 200);
+
+    // Frames are cut after the highest slot in use, per port
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire_size, DMX_MIN_FRAME_SLOTS);
+    CHECK_EQ(host_dmx_port(DMX_NUM_2)->wire_size, 301);
+
+    // A fade on one universe leaves the other one alone, and a universe
+    // without changes costs no driver writes
+    CHECK_EQ(dmx_set_channel(1, 10, 0, 100), DMX_CMD_SUCCESS);
+    uint32_t writes = host_dmx_port(DMX_NUM_1)->writes;
+    uint32_t sends = host_dmx_port(DMX_NUM_1)->sends;
+    for (int i = 0; i < 100 / DMX_FRAME_INTERVAL_MS + 1; ++i)
+    {
+        tick();
+    }
+    CHECK(!dmx_is_channel_fading(1, 10));
+    CHECK_EQ(host_dmx_port(DMX_NUM_2)->wire[10], 0);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[10], 100);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->writes, writes);
+    CHECK(host_dmx_port(DMX_NUM_1)->sends > sends); // Still refreshed
+
+    // Universe-qualified ASCII commands: DMXC2 addresses the second one
+    udp_parsed_command_t cmd;
+    const char *text = "DMXC2:20#55";
+    CHECK_EQ(udp_parse_command(text, strlen(text), &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.universe, 1);
+    CHECK_EQ(udp_execute_command(&cmd), DMX_CMD_SUCCESS);
+    text = "DMXC20#66";
+    CHECK_EQ(udp_parse_command(text, strlen(text), &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.universe, 0);
+    CHECK_EQ(udp_execute_command(&cmd), DMX_CMD_SUCCESS);
+    text = "DMXC3:20#55";
+    CHECK_EQ(udp_parse_command(text, strlen(text), &cmd), UDP_PARSE_OK);
+    CHECK_EQ(udp_execute_command(&cmd), DMX_CMD_ERROR_INVALID_UNIVERSE);
+    tick();
+    CHECK_EQ(host_dmx_port(DMX_NUM_2)->wire[20], 55);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[20], 66);
+    stop();
+    TEST_PASS("two_universes");
+}
+
+// Without a frame clock the manager must not keep the task or the drivers
+static void test_timer_failure_teardown(void)
+{
+    host_fail_timer_create(true);
+    CHECK_EQ(dmx_manager_init(test_pins, 2), ESP_ERR_NO_MEM);
+    host_fail_timer_create(false);
+
+    CHECK(!dmx_manager_is_initialized());
+    CHECK_EQ(dmx_manager_get_universe_count(), 0);
+    CHECK(!host_task_alive(host_task_find("dmx_render")));
+    CHECK(!host_dmx_port(DMX_NUM_1)->installed);
+    CHECK(!host_dmx_port(DMX_NUM_2)->installed);
+
+    // A second attempt installs everything again
+    start(2);
+    CHECK(host_dmx_port(DMX_NUM_1)->installed);
+    CHECK(host_dmx_port(DMX_NUM_2)->installed);
+    stop();
+    CHECK(!host_dmx_port(DMX_NUM_1)->installed);
+    TEST_PASS("timer_failure_teardown");
+}
+
+int main(void)
+{
+    test_idle_stops_clock();
+    test_write_restarts_clock();
+    test_period_change_while_idle();
+    test_two_universes();
+    host_log_level(ESP_LOG_NONE);
+    test_timer_failure_teardown();
+    return 0;
+}
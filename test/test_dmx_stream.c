@@ -0,0 +1,275 @@
+// Compressed universe stream: decoder round trips against the encoder,
+// loss and keyframe recovery, corrupt input, and the server paths around
+// it (512-byte raw universes that look like a stream header, frames the
+// command queue could not take)
+#include <stdlib.h>
+#include <string.h>
+
+#include "server_harness.h"
+#include "dmx_stream_encoder.h"
+
+static uint32_t rng_state = 0x1234567;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Next frame of a changing show: a few channels move every frame, a
+// block is rewritten now and then
+static void next_frame(uint8_t *frame, int f)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        frame[rng() % DMX_UNIVERSE_SIZE] = (uint8_t)rng();
+    }
+    if (f % 37 == 0)
+    {
+        int start = (int)(rng() % 400);
+        memset(&frame[start], (int)(rng() & 0xFF), 1 + rng() % 100);
+    }
+}
+
+static void test_round_trip(void)
+{
+    dmx_stream_init(2);
+    dmx_stream_reset_stats();
+    dmx_stream_publish_stats();
+    stream_encoder_t enc;
+    stream_encoder_init(&enc, 1, 30);
+    uint8_t frame[DMX_UNIVERSE_SIZE] = {0};
+    uint8_t packet[ENC_MAX_PACKET];
+
+    for (int f = 0; f < 5000; ++f)
+    {
+        next_frame(frame, f);
+        size_t len = stream_encoder_encode(&enc, frame, packet);
+        CHECK(dmx_stream_is_packet(packet, len));
+
+        dmx_stream_frame_t out;
+        CHECK_EQ(dmx_stream_decode(packet, len, &out), DMX_STREAM_OK);
+        CHECK_EQ(out.universe, 1);
+        CHECK(memcmp(out.levels, frame, DMX_UNIVERSE_SIZE) == 0);
+        if (!out.keyframe && out.count > 0)
+        {
+            CHECK(out.first >= 0 && out.first + out.count <= DMX_UNIVERSE_SIZE);
+        }
+    }
+
+    dmx_stream_publish_stats();
+    dmx_stream_stats_t stats = dmx_stream_get_stats();
+    CHECK_EQ(stats.keyframes + stats.deltas, 5000);
+    CHECK(stats.keyframes >= 5000 / 30);
+    CHECK_EQ(stats.packets_invalid, 0);
+    TEST_PASS("round_trip");
+}
+
+static void test_loss(void)
+{
+    dmx_stream_init(1);
+    dmx_stream_reset_stats();
+    dmx_stream_publish_stats();
+    stream_encoder_t enc;
+    stream_encoder_init(&enc, 0, 10);
+    uint8_t frame[DMX_UNIVERSE_SIZE];
+    memset(frame, 100, sizeof(frame)); // Keyframes cost more than small deltas
+    uint8_t packets[13][ENC_MAX_PACKET];
+    size_t lens[13];
+    uint8_t frames[13][DMX_UNIVERSE_SIZE];
+    for (int f = 0; f < 13; ++f)
+    {
+        frame[f] = (uint8_t)(f + 1);
+        lens[f] = stream_encoder_encode(&enc, frame, packets[f]);
+        memcpy(frames[f], frame, sizeof(frame));
+    }
+    CHECK_EQ(packets[0][2], DMX_STREAM_KEYFRAME);
+    CHECK_EQ(packets[1][2], DMX_STREAM_DELTA);
+    CHECK_EQ(packets[10][2], DMX_STREAM_KEYFRAME);
+
+    dmx_stream_frame_t out;
+    // Deltas before any keyframe are dropped
+    CHECK_EQ(dmx_stream_decode(packets[1], lens[1], &out), DMX_STREAM_NEED_KEYFRAME);
+    CHECK_EQ(dmx_stream_decode(packets[0], lens[0], &out), DMX_STREAM_OK);
+    CHECK_EQ(dmx_stream_decode(packets[1], lens[1], &out), DMX_STREAM_OK);
+    CHECK_EQ(out.first, 1);
+    CHECK_EQ(out.count, 1);
+
+    // A late duplicate is harmless, a gap needs the next keyframe
+    CHECK_EQ(dmx_stream_decode(packets[1], lens[1], &out), DMX_STREAM_OUT_OF_ORDER);
+    CHECK_EQ(dmx_stream_decode(packets[3], lens[3], &out), DMX_STREAM_NEED_KEYFRAME);
+    CHECK_EQ(dmx_stream_decode(packets[4], lens[4], &out), DMX_STREAM_NEED_KEYFRAME);
+    CHECK_EQ(dmx_stream_decode(packets[10], lens[10], &out), DMX_STREAM_OK);
+    CHECK(memcmp(out.levels, frames[10], DMX_UNIVERSE_SIZE) == 0);
+    CHECK_EQ(dmx_stream_decode(packets[11], lens[11], &out), DMX_STREAM_OK);
+    CHECK(memcmp(out.levels, frames[11], DMX_UNIVERSE_SIZE) == 0);
+
+    // Late keyframes are dropped like late deltas, the universe keeps its
+    // levels and the next delta still applies
+    CHECK_EQ(dmx_stream_decode(packets[0], lens[0], &out), DMX_STREAM_OUT_OF_ORDER);
+    CHECK_EQ(dmx_stream_decode(packets[10], lens[10], &out), DMX_STREAM_OUT_OF_ORDER);
+    CHECK_EQ(dmx_stream_decode(packets[12], lens[12], &out), DMX_STREAM_OK);
+    CHECK(!out.keyframe);
+    CHECK(memcmp(out.levels, frames[12], DMX_UNIVERSE_SIZE) == 0);
+
+    // A frame the caller could not apply: same recovery
+    dmx_stream_invalidate(0);
+    CHECK_EQ(dmx_stream_decode(packets[11], lens[11], &out), DMX_STREAM_NEED_KEYFRAME);
+    dmx_stream_invalidate(5); // Not configured: ignored
+
+    dmx_stream_publish_stats();
+    dmx_stream_stats_t stats = dmx_stream_get_stats();
+    CHECK_EQ(stats.resyncs, 2);
+    CHECK_EQ(stats.out_of_order, 3);
+    CHECK_EQ(stats.deltas_dropped, 4);
+    TEST_PASS("loss");
+}
+
+static void test_corrupt(void)
+{
+    dmx_stream_init(1);
+    dmx_stream_reset_stats();
+    dmx_stream_publish_stats();
+    dmx_stream_frame_t out;
+
+    static const uint8_t key[] = {DMX_STREAM_MAGIC, DMX_STREAM_VERSION, DMX_STREAM_KEYFRAME, 0, 1, 0,
+                                  0x82, 7,           // Repeat 7 three times
+                                  0x01,              // Skip 2
+                                  0x41, 8, 9};       // Literal 8 9
+    CHECK_EQ(dmx_stream_decode(key, sizeof(key), &out), DMX_STREAM_OK);
+    CHECK_EQ(out.levels[2], 7);
+    CHECK_EQ(out.levels[4], 0);
+    CHECK_EQ(out.levels[6], 9);
+
+    uint8_t bad[sizeof(key)];
+    memcpy(bad, key, sizeof(key));
+    bad[4] = 2; // Newer than key, or it would be dropped as late
+    CHECK_EQ(dmx_stream_decode(bad, sizeof(bad) - 1, &out), DMX_STREAM_ERR_CORRUPT); // Literal cut short
+    memcpy(bad, key, sizeof(key));
+    CHECK_EQ(dmx_stream_decode(bad, 7, &out), DMX_STREAM_ERR_CORRUPT);               // Repeat without level
+    bad[1] = 2;
+    CHECK_EQ(dmx_stream_decode(bad, sizeof(bad), &out), DMX_STREAM_ERR_VERSION);
+    bad[1] = DMX_STREAM_VERSION;
+    bad[2] = 2;
+    CHECK(!dmx_stream_is_packet(bad, sizeof(bad)));
+    CHECK_EQ(dmx_stream_decode(bad, sizeof(bad), &out), DMX_STREAM_ERR_HEADER);
+    bad[2] = DMX_STREAM_KEYFRAME;
+    bad[3] = 1;
+    CHECK_EQ(dmx_stream_decode(bad, sizeof(bad), &out), DMX_STREAM_NOT_OURS);
+
+    // Runs past slot 512
+    uint8_t past[DMX_STREAM_HEADER_SIZE + 6] = {DMX_STREAM_MAGIC, DMX_STREAM_VERSION, DMX_STREAM_KEYFRAME, 0, 2, 0};
+    for (int i = 0; i < 5; ++i)
+    {
+        past[DMX_STREAM_HEADER_SIZE + i] = 0x3f; // Skip 64
+    }
+    past[DMX_STREAM_HEADER_SIZE + 5] = 0xff; // Repeat 128 needs a level
+    CHECK_EQ(dmx_stream_decode(past, sizeof(past), &out), DMX_STREAM_ERR_CORRUPT);
+    for (int i = 0; i < 6; ++i)
+    {
+        past[DMX_STREAM_HEADER_SIZE + i] = 0x3f;
+    }
+    CHECK_EQ(dmx_stream_decode(past, sizeof(past), &out), DMX_STREAM_OK); // 384 slots
+    uint8_t far[DMX_STREAM_HEADER_SIZE + 9] = {DMX_STREAM_MAGIC, DMX_STREAM_VERSION, DMX_STREAM_KEYFRAME, 0, 3, 0};
+    memset(&far[DMX_STREAM_HEADER_SIZE], 0x3f, 9);
+    CHECK_EQ(dmx_stream_decode(far, sizeof(far), &out), DMX_STREAM_ERR_CORRUPT); // 576 slots
+
+    dmx_stream_publish_stats();
+    CHECK_EQ(dmx_stream_get_stats().packets_invalid, 6);
+    TEST_PASS("corrupt");
+}
+
+// A raw universe that starts like a stream frame header is not lost
+static void test_raw_lookalike(void)
+{
+    server_start(1);
+    udp_server_stats_t before = udp_server_get_stats();
+
+    uint8_t raw[DMX_UNIVERSE_SIZE];
+    memset(raw, 50, sizeof(raw));
+    raw[0] = DMX_STREAM_MAGIC;
+    raw[1] = DMX_STREAM_VERSION;
+    raw[2] = DMX_STREAM_DELTA; // No keyframe yet: would be dropped silently
+    raw[3] = 0;
+    deliver(raw, sizeof(raw));
+    tick();
+    CHECK_EQ(wire(0, 1), DMX_STREAM_MAGIC);
+    CHECK_EQ(wire(0, 3), DMX_STREAM_DELTA);
+    CHECK_EQ(wire(0, 4), 0);
+    CHECK_EQ(wire(0, 100), 50);
+
+    raw[2] = DMX_STREAM_KEYFRAME; // Tokens run past the universe: corrupt
+    raw[99] = 60;
+    deliver(raw, sizeof(raw));
+    tick();
+    CHECK_EQ(wire(0, 3), DMX_STREAM_KEYFRAME);
+    CHECK_EQ(wire(0, 100), 60);
+
+    // Shorter datagrams are still stream frames
+    deliver(raw, 100);
+    udp_server_stats_t stats = udp_server_get_stats();
+    CHECK_EQ(stats.packets_processed - before.packets_processed, 2);
+    CHECK_EQ(stats.packets_invalid - before.packets_invalid, 1);
+    server_stop();
+    TEST_PASS("raw_lookalike");
+}
+
+// The decoder must not stay synced to a frame that never reached the output
+static void test_queue_full_desyncs(void)
+{
+    server_start(1);
+    dmx_stream_reset_stats();
+    CHECK_EQ(dmx_set_channel(0, 400, 255, DMX_MAX_FADE_MS), DMX_CMD_SUCCESS); // Keeps the clock running
+    tick();
+
+    stream_encoder_t enc;
+    stream_encoder_init(&enc, 0, 1000);
+    uint8_t frame[DMX_UNIVERSE_SIZE] = {0};
+    uint8_t packet[ENC_MAX_PACKET];
+    frame[0] = 1;
+    deliver(packet, stream_encoder_encode(&enc, frame, packet));
+    tick();
+    CHECK_EQ(wire(0, 1), 1);
+
+    // Fill the queue without letting the render task drain it
+    uint8_t span[UDP_SPAN_HEADER_SIZE + 64] = {UDP_SPAN_MAGIC, 0, 0, 200, 0, 0};
+    uint32_t overflows = udp_server_get_stats().queue_overflows;
+    for (int i = 0; i < CMD_QUEUE_LENGTH && udp_server_get_stats().queue_overflows == overflows; ++i)
+    {
+        deliver(span, sizeof(span));
+    }
+    CHECK(udp_server_get_stats().queue_overflows > overflows);
+
+    frame[1] = 2; // Delta that cannot be queued
+    deliver(packet, stream_encoder_encode(&enc, frame, packet));
+    CHECK_EQ(dmx_stream_get_stats().resyncs, 1);
+    tick();
+
+    frame[2] = 3; // Builds on the lost delta: must wait for a keyframe
+    deliver(packet, stream_encoder_encode(&enc, frame, packet));
+    tick();
+    CHECK_EQ(wire(0, 2), 0);
+    CHECK_EQ(wire(0, 3), 0);
+    CHECK_EQ(dmx_stream_get_stats().deltas_dropped, 1);
+
+    stream_encoder_init(&enc, 0, 1000); // Sender restarts with a keyframe
+    deliver(packet, stream_encoder_encode(&enc, frame, packet));
+    tick();
+    CHECK_EQ(wire(0, 2), 2);
+    CHECK_EQ(wire(0, 3), 3);
+    server_stop();
+    TEST_PASS("queue_full_desyncs");
+}
+
+int main(void)
+{
+    test_round_trip();
+    test_loss();
+    test_corrupt();
+    host_log_level(ESP_LOG_ERROR); // Queue overflows are logged
+    test_raw_lookalike();
+    test_queue_full_desyncs();
+    return 0;
+}
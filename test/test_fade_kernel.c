@@ -0,0 +1,139 @@
+// The fixed-point fade kernel must produce exactly what the original float
+// interpolation produced, for every start, target, elapsed and duration
+#include "fade_kernel.h"
+#include "dmx_manager.h"
+
+#include "test_util.h"
+
+// Original fade_task step, copied verbatim
+static uint8_t reference(uint8_t start, uint8_t target, int duration, int elapsed)
+{
+    float t = (float)elapsed / (float)duration;
+    float interpolated = start + (target - start) * t;
+    return (uint8_t)roundf(interpolated);
+}
+
+static uint64_t checked = 0;
+static uint64_t rounded_apart = 0; // Steps where exact rounding and float differ
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint32_t)(rng_state >> 32);
+}
+
+static void check_step(const fade_kernel_t *kernel, uint8_t start, uint8_t target, uint32_t duration, uint32_t elapsed)
+{
+    uint8_t expected = reference(start, target, (int)duration, (int)elapsed);
+    uint8_t actual = fade_kernel_value(kernel, start, target, duration, elapsed);
+    if (actual != expected)
+    {
+        fprintf(stderr, "start %u target %u duration %u elapsed %u: kernel %u, float %u\n",
+                start, target, duration, elapsed, actual, expected);
+        exit(1);
+    }
+
+    // Exact round half up, to count the steps the tie fallback saves
+    uint64_t num = 2ull * (target >= start ? target - start : start - target) * elapsed + duration;
+    uint64_t exact = (target >= start) ? start + num / (2ull * duration) : start - (num - 1) / (2ull * duration);
+    rounded_apart += (exact != expected);
+    checked++;
+}
+
+// Every input of the short fades
+static void test_exhaustive_short(void)
+{
+    for (uint32_t duration = 1; duration <= 32; ++duration)
+    {
+        fade_kernel_t kernel = fade_kernel_prepare(duration);
+        for (int start = 0; start < 256; ++start)
+        {
+            for (int target = 0; target < 256; ++target)
+            {
+                for (uint32_t elapsed = 0; elapsed < duration; ++elapsed)
+                {
+                    check_step(&kernel, (uint8_t)start, (uint8_t)target, duration, elapsed);
+                }
+            }
+        }
+    }
+    TEST_PASS("exhaustive_short");
+}
+
+// Every elapsed step of typical fades, all deltas from a few starts
+static void test_typical_durations(void)
+{
+    static const uint32_t durations[] = {33, 100, 255, 256, 500, 1000, 1024, 3000};
+    static const uint8_t starts[] = {0, 1, 127, 128, 254, 255};
+    for (size_t d = 0; d < sizeof(durations) / sizeof(durations[0]); ++d)
+    {
+        fade_kernel_t kernel = fade_kernel_prepare(durations[d]);
+        for (size_t s = 0; s < sizeof(starts) / sizeof(starts[0]); ++s)
+        {
+            for (int target = 0; target < 256; ++target)
+            {
+                for (uint32_t elapsed = 0; elapsed < durations[d]; ++elapsed)
+                {
+                    check_step(&kernel, starts[s], (uint8_t)target, durations[d], elapsed);
+                }
+            }
+        }
+    }
+    TEST_PASS("typical_durations");
+}
+
+// Random inputs up to the longest fade
+static void test_random(void)
+{
+    for (int i = 0; i < 4000000; ++i)
+    {
+        uint32_t duration = 1 + rng() % DMX_MAX_FADE_MS;
+        fade_kernel_t kernel = fade_kernel_prepare(duration);
+        check_step(&kernel, (uint8_t)rng(), (uint8_t)rng(), duration, rng() % duration);
+    }
+    TEST_PASS("random");
+}
+
+// Steps next to x.5, where the float error decides the rounding: elapsed
+// near (k + 1/2) * duration / delta, with every start
+static void test_near_ties(void)
+{
+    for (int i = 0; i < 20000; ++i)
+    {
+        uint32_t duration = 2 + rng() % ((i & 1) ? DMX_MAX_FADE_MS - 1 : 5000);
+        uint32_t delta = 1 + rng() % 255;
+        uint32_t k = rng() % delta;
+        uint32_t tie = (uint32_t)(((2ull * k + 1) * duration + delta) / (2ull * delta));
+        fade_kernel_t kernel = fade_kernel_prepare(duration);
+
+        for (int offset = -2; offset <= 2; ++offset)
+        {
+            uint32_t elapsed = tie + (uint32_t)offset;
+            if ((int64_t)tie + offset < 0 || elapsed >= duration)
+            {
+                continue;
+            }
+            for (uint32_t start = 0; start + delta < 256; start += 1 + rng() % 8)
+            {
+                check_step(&kernel, (uint8_t)start, (uint8_t)(start + delta), duration, elapsed);
+                check_step(&kernel, (uint8_t)(start + delta), (uint8_t)start, duration, elapsed);
+            }
+        }
+    }
+    TEST_PASS("near_ties");
+}
+
+int main(void)
+{
+    test_exhaustive_short();
+    test_typical_durations();
+    test_random();
+    test_near_ties();
+    printf("%llu steps match the float kernel, %llu of them differ from exact rounding\n",
+           (unsigned long long)checked, (unsigned long long)rounded_apart);
+    return 0;
+}
@@ -0,0 +1,235 @@
+// State feedback: subscriptions report their channels over a loopback
+// socket when the render task publishes changes, coalesced per subscriber
+// interval, until the lease runs out or the controller unsubscribes
+#include <string.h>
+#include <stdio.h>
+#include <arpa/inet.h>
+
+#include "feedback.h"
+#include "render_harness.h"
+#include "freertos/task.h"
+
+static TaskHandle_t feedback;
+static int controller = -1;
+static struct sockaddr_in controller_addr;
+
+static void setup(void)
+{
+    start(1);
+    CHECK_EQ(feedback_init(), ESP_OK);
+    feedback = host_task_find("dmx_feedback");
+    CHECK(feedback != NULL);
+
+    controller = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(controller >= 0);
+    memset(&controller_addr, 0, sizeof(controller_addr));
+    controller_addr.sin_family = AF_INET;
+    controller_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK_EQ(bind(controller, (struct sockaddr *)&controller_addr, sizeof(controller_addr)), 0);
+    socklen_t len = sizeof(controller_addr);
+    CHECK_EQ(getsockname(controller, (struct sockaddr *)&controller_addr, &len), 0);
+}
+
+// Wake the feedback task and wait until it has handled everything
+static void feedback_pass(void)
+{
+    uint32_t waits = host_task_waits(feedback);
+    xTaskNotifyGive(feedback);
+    host_task_wait_blocked(feedback, waits + 1);
+}
+
+// One frame; the feedback task has handled what it published
+static void frame(void)
+{
+    tick();
+    host_task_wait_blocked(feedback, host_task_waits(feedback));
+}
+
+// Next notification datagram, or an empty string. Loopback sends are
+// queued by the time sendto returns.
+static const char *receive(void)
+{
+    static char buf[FEEDBACK_MAX_PACKET_SIZE + 1];
+    ssize_t n = recv(controller, buf, FEEDBACK_MAX_PACKET_SIZE, MSG_DONTWAIT);
+    buf[n > 0 ? n : 0] = '\0';
+    return buf;
+}
+
+static void test_subscribe(void)
+{
+    feedback_reset_stats();
+    CHECK_EQ(dmx_set_channel(0, 10, 50, 0), DMX_CMD_SUCCESS);
+    tick();
+
+    // Bad ranges are refused
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 0, 3, 100), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 10, 0, 100), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 510, 5, 100), ESP_ERR_INVALID_ARG);
+    CHECK_EQ(feedback_subscribe(&controller_addr, 1, 10, 3, 100), ESP_ERR_INVALID_ARG);
+
+    // The whole range is reported right away
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 10, 3, 100), ESP_OK);
+    feedback_pass();
+    CHECK(strcmp(receive(), "STATE1:10#50#0\nSTATE1:11#0#0\nSTATE1:12#0#0\n") == 0);
+    CHECK(strcmp(receive(), "") == 0);
+
+    // Subscribing again renews it, nothing is added or reported, not even
+    // once the interval has passed
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 10, 3, 100), ESP_OK);
+    feedback_pass();
+    CHECK(strcmp(receive(), "") == 0);
+    host_advance_us(1000000);
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 10, 3, 100), ESP_OK);
+    feedback_pass();
+    CHECK(strcmp(receive(), "") == 0);
+    feedback_stats_t stats = feedback_get_stats();
+    CHECK_EQ(stats.subscribes, 3);
+    CHECK_EQ(stats.active_subscribers, 1);
+    CHECK_EQ(stats.rejected, 0);
+    TEST_PASS("subscribe");
+}
+
+// A fade is reported as it progresses, at most once per interval, and
+// the last report carries the final value without the fading flag
+static void test_fade_progress(void)
+{
+    host_advance_us(1000000); // Reports above are out of the interval
+    feedback_pass();
+    while (strcmp(receive(), "") != 0)
+    {
+    }
+    feedback_reset_stats();
+
+    CHECK_EQ(dmx_set_channel(0, 11, 200, 300), DMX_CMD_SUCCESS);
+    CHECK_EQ(dmx_set_channel(0, 20, 99, 0), DMX_CMD_SUCCESS); // Not subscribed
+
+    int datagrams = 0;
+    int64_t last_us = 0;
+    char last[FEEDBACK_MAX_PACKET_SIZE + 1] = "";
+    for (int i = 0; i < 40; ++i)
+    {
+        frame();
+        const char *text = receive();
+        if (text[0] == '\0')
+        {
+            continue;
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        if (datagrams > 0)
+        {
+            CHECK(now_us - last_us >= 100 * 1000);
+        }
+        last_us = now_us;
+        datagrams++;
+        snprintf(last, sizeof(last), "%s", text);
+
+        // Only the fading channel, never the unchanged or unsubscribed ones
+        CHECK(strncmp(text, "STATE1:11#", 10) == 0);
+        CHECK(strchr(text, '\n') == text + strlen(text) - 1);
+    }
+
+    CHECK(strcmp(last, "STATE1:11#200#0\n") == 0);
+    CHECK(datagrams >= 3 && datagrams <= 300 / 100 + 2);
+    feedback_stats_t stats = feedback_get_stats();
+    CHECK_EQ(stats.notifications, datagrams);
+    CHECK_EQ(stats.channels_reported, datagrams);
+    CHECK(stats.rate_limited > 0);
+    CHECK_EQ(stats.send_errors, 0);
+    TEST_PASS("fade_progress");
+}
+
+// Changes inside the interval go out together once it has passed
+static void test_coalescing(void)
+{
+    tick_until_idle();
+    host_advance_us(1000000);
+    feedback_pass();
+    receive();
+
+    CHECK_EQ(dmx_set_channel(0, 10, 1, 0), DMX_CMD_SUCCESS);
+    frame();
+    CHECK(strcmp(receive(), "STATE1:10#1#0\n") == 0);
+
+    CHECK_EQ(dmx_set_channel(0, 12, 2, 0), DMX_CMD_SUCCESS);
+    frame();
+    CHECK_EQ(dmx_set_channel(0, 10, 3, 0), DMX_CMD_SUCCESS);
+    frame();
+    CHECK(strcmp(receive(), "") == 0); // Postponed
+
+    host_advance_us(100 * 1000);
+    feedback_pass();
+    CHECK(strcmp(receive(), "STATE1:10#3#0\nSTATE1:12#2#0\n") == 0);
+    TEST_PASS("coalescing");
+}
+
+static void test_unsubscribe_and_lease(void)
+{
+    feedback_reset_stats();
+    CHECK_EQ(feedback_get_stats().active_subscribers, 1);
+
+    // Unsubscribing drops every range of the address
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 100, 1, 20), ESP_OK);
+    feedback_pass();
+    receive();
+    feedback_unsubscribe(&controller_addr);
+    CHECK_EQ(feedback_get_stats().active_subscribers, 0);
+    CHECK_EQ(feedback_get_stats().unsubscribes, 2);
+    CHECK_EQ(dmx_set_channel(0, 10, 4, 0), DMX_CMD_SUCCESS);
+    frame();
+    feedback_pass();
+    CHECK(strcmp(receive(), "") == 0);
+
+    // A lease that is not renewed runs out
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 10, 1, 20), ESP_OK);
+    feedback_pass();
+    CHECK(strcmp(receive(), "STATE1:10#4#0\n") == 0);
+    host_advance_us((FEEDBACK_LEASE_MS + 1) * 1000LL);
+    feedback_pass();
+    CHECK_EQ(feedback_get_stats().expired, 1);
+    CHECK_EQ(feedback_get_stats().active_subscribers, 0);
+    CHECK_EQ(dmx_set_channel(0, 10, 5, 0), DMX_CMD_SUCCESS);
+    frame();
+    CHECK(strcmp(receive(), "") == 0);
+    TEST_PASS("unsubscribe_and_lease");
+}
+
+static void test_table_full(void)
+{
+    feedback_reset_stats();
+    for (int i = 0; i < FEEDBACK_MAX_SUBSCRIBERS; ++i)
+    {
+        CHECK_EQ(feedback_subscribe(&controller_addr, 0, 1 + i, 1, 1000), ESP_OK);
+    }
+    CHECK_EQ(feedback_subscribe(&controller_addr, 0, 300, 1, 1000), ESP_ERR_NO_MEM);
+    feedback_stats_t stats = feedback_get_stats();
+    CHECK_EQ(stats.rejected, 1);
+    CHECK_EQ(stats.active_subscribers, FEEDBACK_MAX_SUBSCRIBERS);
+
+    // Every range got its own initial report
+    feedback_pass();
+    int datagrams = 0;
+    while (strcmp(receive(), "") != 0)
+    {
+        datagrams++;
+    }
+    CHECK_EQ(datagrams, FEEDBACK_MAX_SUBSCRIBERS);
+
+    feedback_unsubscribe(&controller_addr);
+    CHECK_EQ(feedback_get_stats().active_subscribers, 0);
+    TEST_PASS("table_full");
+}
+
+int main(void)
+{
+    host_log_level(ESP_LOG_ERROR); // The full table is logged
+    setup();
+    test_subscribe();
+    test_fade_progress();
+    test_coalescing();
+    test_unsubscribe_and_lease();
+    test_table_full();
+    close(controller);
+    stop();
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Latency histograms: percentiles within the bucket error and resets
+// applied by the writer while it records
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "latency_trace.c"
+#include "test_util.h"
+
+static void test_percentiles(void)
+{
+    latency_trace_reset();
+    latency_summary_t s = latency_trace_summary(LATENCY_STAGE_PARSE);
+    CHECK_EQ(s.count, 0);
+    CHECK_EQ(s.p99_us, 0);
+
+    // Small values have a bucket each
+    for (uint32_t us = 0; us < 8; ++us)
+    {
+        latency_trace_add(LATENCY_STAGE_PARSE, us);
+    }
+    s = latency_trace_summary(LATENCY_STAGE_PARSE);
+    CHECK_EQ(s.count, 8);
+    CHECK_EQ(s.p50_us, 3);
+    CHECK_EQ(s.max_us, 7);
+
+    // 1..100000 us: each percentile is at or above the exact one and
+    // within 12.5% of it
+    for (uint32_t us = 1; us <= 100000; ++us)
+    {
+        latency_trace_add(LATENCY_STAGE_TOTAL, us);
+    }
+    s = latency_trace_summary(LATENCY_STAGE_TOTAL);
+    CHECK_EQ(s.count, 100000);
+    CHECK_EQ(s.max_us, 100000);
+    CHECK(s.p50_us >= 50000 && s.p50_us <= 50000 * 9 / 8);
+    CHECK(s.p95_us >= 95000 && s.p95_us <= 95000 * 9 / 8);
+    CHECK(s.p99_us >= 99000 && s.p99_us <= 100000);
+
+    // Out of range: clamped to the last bucket, capped at the maximum
+    latency_trace_add(LATENCY_STAGE_SEND, UINT32_MAX);
+    s = latency_trace_summary(LATENCY_STAGE_SEND);
+    CHECK_EQ(s.p50_us, UINT32_MAX);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_COUNT).count, 0);
+    CHECK(strcmp(latency_stage_name(LATENCY_STAGE_QUEUE), "queue") == 0);
+    CHECK(strcmp(latency_stage_name(LATENCY_STAGE_COUNT), "unknown") == 0);
+    TEST_PASS("percentiles");
+}
+
+static void test_record(void)
+{
+    latency_trace_reset();
+    latency_trace_t trace = {
+        .received_us = 1000,
+        .queued_us = 1005,
+        .applied_us = 21000,
+        .rendered_us = 21100,
+        .sent_us = 20000}; // A step backwards lands in the first bucket
+    latency_trace_record(&trace);
+
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_PARSE).max_us, 5);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_QUEUE).max_us, 19995);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_RENDER).max_us, 100);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_SEND).max_us, 0);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_SEND).count, 1);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_TOTAL).max_us, 19000);
+    TEST_PASS("record");
+}
+
+// Resets from another task while the writer records: the writer's counts
+// always add up. The ThreadSanitizer build reports a reset that touches
+// the histograms itself.
+static atomic_bool stop_resets;
+
+static void *resetter(void *arg)
+{
+    (void)arg;
+    while (!atomic_load(&stop_resets))
+    {
+        latency_trace_reset();
+    }
+    return NULL;
+}
+
+static bool counts_add_up(void)
+{
+    for (int s = 0; s < LATENCY_STAGE_COUNT; ++s)
+    {
+        uint32_t sum = 0;
+        for (int i = 0; i < LATENCY_TRACE_BUCKETS; ++i)
+        {
+            sum += histograms[s].buckets[i];
+        }
+        if (sum != histograms[s].count)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_reset_while_recording(void)
+{
+    latency_trace_add(LATENCY_STAGE_QUEUE, 10);
+    latency_trace_reset();
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_QUEUE).count, 0);
+    latency_trace_add(LATENCY_STAGE_QUEUE, 20);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_QUEUE).count, 1);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_QUEUE).max_us, 20);
+
+    pthread_t thread;
+    CHECK_EQ(pthread_create(&thread, NULL, resetter, NULL), 0);
+    latency_trace_t trace = {.received_us = 0, .queued_us = 3, .applied_us = 300, .rendered_us = 3000, .sent_us = 30000};
+    int broken = 0;
+    for (int i = 0; i < 200000; ++i)
+    {
+        latency_trace_record(&trace);
+        if ((i & 255) == 0 && !counts_add_up())
+        {
+            broken++;
+        }
+    }
+    atomic_store(&stop_resets, true);
+    pthread_join(thread, NULL);
+    CHECK_EQ(broken, 0);
+    CHECK(counts_add_up());
+    TEST_PASS("reset_while_recording");
+}
+
+int main(void)
+{
+    test_percentiles();
+    test_record();
+    test_reset_while_recording();
+    return 0;
+}
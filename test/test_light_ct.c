@@ -0,0 +1,153 @@
+// DMXL tunable white: pairs resolved at load against the per-command
+// lookup and long division they replaced, over the whole 20BBBTTTT input
+// space
+#include <stdio.h>
+#include <string.h>
+
+#include "dmx_manager.c"
+#include "render_harness.h"
+#include "my_config.h"
+#include "udp_protocol.h"
+#include "legacy_light_ct.h"
+
+typedef struct
+{
+    const char *name;
+    int ch;
+    int ct1;         // ct_config[ch], 0 = not set
+    int ct2;         // ct_config[ch + 1]
+    int default_min;
+    int default_max;
+} ct_case_t;
+
+static const ct_case_t cases[] = {
+    {"defaults", 10, 0, 0, 3500, 6700},
+    {"configured", 10, 2700, 6500, 3500, 6700},
+    {"reversed", 10, 6500, 2700, 3500, 6700},
+    {"first only", 10, 3000, 0, 3500, 6700},
+    {"second only", 10, 0, 5000, 3500, 6700},
+    {"second below default", 10, 0, 2000, 3500, 6700},
+    {"equal ends", 10, 4000, 4000, 3500, 6700},
+    {"narrow", 10, 4000, 4150, 3500, 6700},
+    {"wide", 10, 1000, 20000, 3500, 6700},
+    {"other defaults", 10, 0, 0, 2000, 9000},
+    {"last channel", 511, 6000, 0, 3500, 6700},
+};
+
+static int ct_config[CT_CHANNELS];
+
+static void load(const ct_case_t *c)
+{
+    memset(ct_config, 0, sizeof(ct_config));
+    if (c->ch < CT_CHANNELS)
+    {
+        ct_config[c->ch] = c->ct1;
+    }
+    if (c->ch + 1 < CT_CHANNELS)
+    {
+        ct_config[c->ch + 1] = c->ct2;
+    }
+    ct_pairs_resolve(ct_config, c->default_min, c->default_max);
+}
+
+// Every 20BBBTTTT value: brightness 000-999 (over 100 is full) and
+// 0000-9999 K, through the descriptor mix and through the old code
+static long check_input_space(const ct_case_t *c)
+{
+    load(c);
+    ct_pair_t pair = get_ct_pair(c->ch);
+    long cases_checked = 0;
+
+    for (int bbb = 0; bbb < 1000; ++bbb)
+    {
+        int brightness = bbb > 100 ? 100 : bbb;
+        for (int ct = 0; ct < 10000; ++ct)
+        {
+            uint8_t values[2];
+            light_ct_mix(&pair, (uint32_t)brightness, ct, &values[pair.ww_offset], &values[1 - pair.ww_offset]);
+
+            uint8_t expected[2];
+            legacy_light_ct(ct_config, CT_CHANNELS, c->default_min, c->default_max, c->ch, bbb, ct,
+                            &expected[0], &expected[1]);
+            if (values[0] != expected[0] || values[1] != expected[1])
+            {
+                fprintf(stderr, "%s: 20%03d%04d gives %d/%d, expected %d/%d\n", c->name, bbb, ct,
+                        values[0], values[1], expected[0], expected[1]);
+                exit(1);
+            }
+            cases_checked++;
+        }
+    }
+    return cases_checked;
+}
+
+static void test_input_space(void)
+{
+    long total = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        total += check_input_space(&cases[i]);
+    }
+    CHECK_EQ(total, 10000000L * (long)(sizeof(cases) / sizeof(cases[0])));
+
+    // The parser splits the Lumitech value the same way
+    udp_parsed_command_t cmd;
+    CHECK_EQ(udp_parse_command("DMXL10#200507000", 16, &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.brightness, 50);
+    CHECK_EQ(cmd.color_temp, 7000);
+    CHECK_EQ(udp_parse_command("DMXL10#209999999", 16, &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.brightness, 100);
+    CHECK_EQ(cmd.color_temp, 9999);
+    TEST_PASS("input_space");
+}
+
+// Configured CTs above CT_MAX_K are taken as CT_MAX_K
+static void test_clamp(void)
+{
+    ct_case_t over = {"over", 20, 3000, 30000, 3500, 6700};
+    load(&over);
+    ct_pair_t pair = get_ct_pair(20);
+    CHECK_EQ(pair.ct_ww, 3000);
+    CHECK_EQ(pair.ct_cw, CT_MAX_K);
+
+    ct_config[21] = CT_MAX_K;
+    for (int ct = 0; ct < 25000; ct += 7)
+    {
+        uint8_t values[2];
+        light_ct_mix(&pair, 80, ct, &values[pair.ww_offset], &values[1 - pair.ww_offset]);
+        uint8_t expected[2];
+        legacy_light_ct(ct_config, CT_CHANNELS, 3500, 6700, 20, 80, ct, &expected[0], &expected[1]);
+        CHECK(values[0] == expected[0] && values[1] == expected[1]);
+    }
+
+    // Channels out of range use the defaults
+    pair = get_ct_pair(CT_CHANNELS + 5);
+    CHECK_EQ(pair.ct_ww, 3500);
+    CHECK_EQ(pair.ct_cw, 6700);
+    TEST_PASS("clamp");
+}
+
+// Through the render task: warm channel first or second, as configured
+static void test_on_the_wire(void)
+{
+    ct_case_t reversed = cases[2];
+    load(&reversed);
+    start(1);
+    CHECK_EQ(dmx_set_light_ct(0, 10, 50, 4600, 0), DMX_CMD_SUCCESS);
+    tick();
+    uint8_t expected[2];
+    legacy_light_ct(ct_config, CT_CHANNELS, 3500, 6700, 10, 50, 4600, &expected[0], &expected[1]);
+    CHECK_EQ(wire(0, 10), expected[0]);
+    CHECK_EQ(wire(0, 11), expected[1]);
+    CHECK(wire(0, 10) > 0 && wire(0, 11) > 0);
+    stop();
+    TEST_PASS("on_the_wire");
+}
+
+int main(void)
+{
+    test_input_space();
+    test_clamp();
+    test_on_the_wire();
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Deferred logging: records are formatted per conversion with the type it
+// expects, a full ring drops new records, and the flush task prints and
+// reports what was queued
+#include <string.h>
+
+#include "log_ring.c"
+#include "host.h"
+#include "test_util.h"
+
+static void format(char *line, size_t size, const char *fmt, const uintptr_t *args)
+{
+    log_record_t rec = {.fmt = fmt};
+    memcpy(rec.args, args, sizeof(rec.args));
+    format_record(line, size, &rec);
+}
+
+static void test_format(void)
+{
+    char line[LOG_RING_LINE_MAX];
+
+    format(line, sizeof(line), "Invalid DMX universe data", LOG_RING_ARGS());
+    CHECK(strcmp(line, "Invalid DMX universe data") == 0);
+
+    // Negative ints survive a slot wider than int
+    format(line, sizeof(line), "UDP recvfrom failed: errno %d", LOG_RING_ARGS(-11));
+    CHECK(strcmp(line, "UDP recvfrom failed: errno -11") == 0);
+
+    // Strings next to ints, in any order
+    format(line, sizeof(line), "%d of %d commands rejected (first: %s), length: %d",
+           LOG_RING_ARGS(2, 5, (uintptr_t) "bad channel", 40));
+    CHECK(strcmp(line, "2 of 5 commands rejected (first: bad channel), length: 40") == 0);
+
+    // Flags, width, precision, %%, %c, unsigned and hex
+    format(line, sizeof(line), "Ignoring Art-Net OpCode 0x%04x", LOG_RING_ARGS(0x2000));
+    CHECK(strcmp(line, "Ignoring Art-Net OpCode 0x2000") == 0);
+    format(line, sizeof(line), "Channel %d set to %d%% (%d/255)", LOG_RING_ARGS(7, 50, 128));
+    CHECK(strcmp(line, "Channel 7 set to 50% (128/255)") == 0);
+    format(line, sizeof(line), "[%-4s|%5.2s|%c|%u|%X]",
+           LOG_RING_ARGS((uintptr_t) "ab", (uintptr_t) "xyz", 'Q', 4000000000u, 0xbeef));
+    CHECK(strcmp(line, "[ab  |   xy|Q|4000000000|BEEF]") == 0);
+
+    // Length modifiers are dropped, the value is 32 bits either way
+    format(line, sizeof(line), "%lu %ld", LOG_RING_ARGS(123, -4));
+    CHECK(strcmp(line, "123 -4") == 0);
+
+    // Six arguments, then a conversion without one ends the line
+    format(line, sizeof(line), "%d %d %d %d %d %d|%d", LOG_RING_ARGS(1, 2, 3, 4, 5, 6));
+    CHECK(strcmp(line, "1 2 3 4 5 6|") == 0);
+
+    // Cut at the buffer, in text and in a conversion
+    char small[8];
+    format(small, sizeof(small), "abcdefghij", LOG_RING_ARGS());
+    CHECK(strcmp(small, "abcdefg") == 0);
+    format(small, sizeof(small), "ab%sX", LOG_RING_ARGS((uintptr_t) "cdefghij"));
+    CHECK(strcmp(small, "abcdefg") == 0);
+    format(small, sizeof(small), "abc%", LOG_RING_ARGS());
+    CHECK(strcmp(small, "abc") == 0);
+    TEST_PASS("format");
+}
+
+static void test_drop_and_flush(void)
+{
+    // Levels without the flush task: nothing drains the ring yet
+    log_ring_set_debug(false);
+    LOG_RING_D(LOG_MODULE_UDP_SERVER, "filtered %d", 1);
+    CHECK_EQ(log_ring_get_stats().written, 0);
+
+    for (int i = 0; i < LOG_RING_SIZE + 2; ++i)
+    {
+        LOG_RING_W(LOG_MODULE_DMX_MANAGER, "Invalid channel: %d", i);
+    }
+    LOG_RING_W(LOG_MODULE_DMX_MANAGER, "Invalid DMX universe data");
+    log_ring_stats_t stats = log_ring_get_stats();
+    CHECK_EQ(stats.written, LOG_RING_SIZE);
+    CHECK_EQ(stats.dropped, 3);
+    CHECK_EQ(stats.flushed, 0);
+
+    // The flush task prints the queued records, then reports the drops
+    host_log_level(ESP_LOG_NONE);
+    CHECK_EQ(log_ring_init(false), ESP_OK);
+    for (int i = 0; i < 100 && log_ring_get_stats().flushed < LOG_RING_SIZE; ++i)
+    {
+        vTaskDelay(pdMS_TO_TICKS(LOG_RING_FLUSH_MS));
+    }
+    CHECK_EQ(log_ring_get_stats().flushed, LOG_RING_SIZE);
+    for (int i = 0; i < 100 && strstr(host_log_last(), "dropped") == NULL; ++i)
+    {
+        vTaskDelay(pdMS_TO_TICKS(LOG_RING_FLUSH_MS));
+    }
+    CHECK(strcmp(host_log_last(), "3 log records dropped, ring full") == 0);
+
+    // A record without arguments after the drain
+    LOG_RING_W(LOG_MODULE_UDP_SERVER, "Command queue full, packet dropped");
+    for (int i = 0; i < 100 && log_ring_get_stats().flushed < LOG_RING_SIZE + 1; ++i)
+    {
+        vTaskDelay(pdMS_TO_TICKS(LOG_RING_FLUSH_MS));
+    }
+    CHECK(strstr(host_log_last(), ") Command queue full, packet dropped") != NULL);
+    TEST_PASS("drop_and_flush");
+}
+
+int main(void)
+{
+    test_format();
+    test_drop_and_flush();
+    return 0;
+}
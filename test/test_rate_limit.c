@@ -0,0 +1,242 @@
+// Per-source rate limiter: token buckets, frame reserve, source table, and
+// a simulated 10 kpps flood through the server dispatch next to a well
+// behaved controller
+#include <stdio.h>
+#include <string.h>
+
+#include "server_harness.h"
+
+#define FLOOD_ADDR 0x6401A8C0 // 192.168.1.100
+#define SOURCE(n) (0x0002A8C0u | ((uint32_t)(n) << 24))
+
+static void test_bucket(void)
+{
+    rate_limit_init(100, 10);
+
+    // A full bucket: frames pass while it is more than half full,
+    // commands down to the last token
+    int passed = 0;
+    while (rate_limit_check(SOURCE(1), RATE_LIMIT_FRAME, 0) == RATE_LIMIT_PASS)
+    {
+        passed++;
+    }
+    CHECK_EQ(passed, 5);
+    CHECK_EQ(rate_limit_check(SOURCE(1), RATE_LIMIT_FRAME, 0), RATE_LIMIT_DROP);
+    for (int i = 0; i < 5; ++i)
+    {
+        CHECK_EQ(rate_limit_check(SOURCE(1), RATE_LIMIT_COMMAND, 0), RATE_LIMIT_PASS);
+    }
+    CHECK_EQ(rate_limit_check(SOURCE(1), RATE_LIMIT_COMMAND, 0), RATE_LIMIT_HOLD);
+
+    // 100 pps refill one token every 10 ms; other sources are unaffected
+    CHECK_EQ(rate_limit_check(SOURCE(1), RATE_LIMIT_COMMAND, 9), RATE_LIMIT_HOLD);
+    CHECK_EQ(rate_limit_check(SOURCE(1), RATE_LIMIT_COMMAND, 20), RATE_LIMIT_PASS);
+    CHECK_EQ(rate_limit_check(SOURCE(2), RATE_LIMIT_FRAME, 20), RATE_LIMIT_PASS);
+
+    // A long pause refills up to the burst, not beyond
+    passed = 0;
+    while (rate_limit_check(SOURCE(1), RATE_LIMIT_COMMAND, 100000) == RATE_LIMIT_PASS)
+    {
+        passed++;
+    }
+    CHECK_EQ(passed, 10);
+
+    rate_limit_publish_stats();
+    rate_limit_source_t sources[RATE_LIMIT_MAX_SOURCES + 1];
+    CHECK_EQ(rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1), 2);
+    CHECK_EQ(sources[0].addr, SOURCE(1));
+    CHECK_EQ(sources[0].packets, 26);
+    CHECK_EQ(sources[0].frames_dropped, 2);
+    CHECK_EQ(sources[0].commands_held, 3);
+    rate_limit_stats_t stats = rate_limit_get_stats();
+    CHECK_EQ(stats.packets_checked, 27);
+    CHECK_EQ(stats.frames_dropped, 2);
+    CHECK_EQ(stats.commands_held, 3);
+
+    // Resetting the counters keeps the sources and their buckets
+    rate_limit_reset_stats();
+    rate_limit_publish_stats();
+    CHECK_EQ(rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1), 2);
+    CHECK_EQ(sources[0].addr, SOURCE(1));
+    CHECK_EQ(sources[0].packets, 0);
+    CHECK_EQ(rate_limit_check(SOURCE(1), RATE_LIMIT_COMMAND, 100000), RATE_LIMIT_HOLD);
+
+    // Disabled: everything passes, nothing is tracked
+    rate_limit_init(0, 0);
+    for (int i = 0; i < 1000; ++i)
+    {
+        CHECK_EQ(rate_limit_check(SOURCE(1), RATE_LIMIT_FRAME, 0), RATE_LIMIT_PASS);
+    }
+    rate_limit_publish_stats();
+    CHECK_EQ(rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1), 0);
+    TEST_PASS("bucket");
+}
+
+static void test_source_table(void)
+{
+    rate_limit_init(100, 4);
+    for (int i = 0; i < RATE_LIMIT_MAX_SOURCES; ++i)
+    {
+        CHECK_EQ(rate_limit_check(SOURCE(i + 1), RATE_LIMIT_COMMAND, (uint32_t)i), RATE_LIMIT_PASS);
+    }
+
+    // A full table of active sources: newcomers share the overflow bucket
+    CHECK_EQ(rate_limit_check(SOURCE(50), RATE_LIMIT_COMMAND, 100), RATE_LIMIT_PASS);
+    CHECK_EQ(rate_limit_check(SOURCE(51), RATE_LIMIT_COMMAND, 100), RATE_LIMIT_PASS);
+    CHECK_EQ(rate_limit_check(SOURCE(52), RATE_LIMIT_COMMAND, 100), RATE_LIMIT_PASS);
+    CHECK_EQ(rate_limit_check(SOURCE(53), RATE_LIMIT_COMMAND, 100), RATE_LIMIT_PASS);
+    CHECK_EQ(rate_limit_check(SOURCE(54), RATE_LIMIT_COMMAND, 100), RATE_LIMIT_HOLD);
+    rate_limit_publish_stats();
+    CHECK_EQ(rate_limit_get_stats().sources_overflowed, 5);
+
+    rate_limit_source_t sources[RATE_LIMIT_MAX_SOURCES + 1];
+    CHECK_EQ(rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1), RATE_LIMIT_MAX_SOURCES + 1);
+    CHECK_EQ(sources[RATE_LIMIT_MAX_SOURCES].addr, 0);
+    CHECK_EQ(sources[RATE_LIMIT_MAX_SOURCES].packets, 5);
+
+    // Keep all but the first source active; the idle one is handed over
+    uint32_t later = RATE_LIMIT_IDLE_MS + 100;
+    for (int i = 1; i < RATE_LIMIT_MAX_SOURCES; ++i)
+    {
+        rate_limit_check(SOURCE(i + 1), RATE_LIMIT_COMMAND, later - 50);
+    }
+    CHECK_EQ(rate_limit_check(SOURCE(60), RATE_LIMIT_COMMAND, later), RATE_LIMIT_PASS);
+    rate_limit_publish_stats();
+    CHECK_EQ(rate_limit_get_stats().sources_evicted, 1);
+    rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1);
+    CHECK_EQ(sources[0].addr, SOURCE(60));
+    CHECK_EQ(sources[0].packets, 1);
+    TEST_PASS("source_table");
+}
+
+// udp_flood.py's packet mix: raw universes, ASCII and binary commands on
+// the same eight channels
+static size_t flood_packet(uint8_t *buf, int n, int kind)
+{
+    switch (kind)
+    {
+    case 0:
+        for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i)
+        {
+            buf[i] = (uint8_t)(n + i);
+        }
+        return DMX_UNIVERSE_SIZE;
+    case 1:
+        return (size_t)sprintf((char *)buf, "DMXC%d#%d#0", 1 + n % 8, n & 0xFF);
+    default:
+    {
+        const uint8_t fill[] = {UDP_BINARY_MAGIC, UDP_BINARY_VERSION,
+                                UDP_BIN_OP_FILL, 0, 0, (uint8_t)(1 + n % 8), 0, 1, 0, 0, (uint8_t)n};
+        memcpy(buf, fill, sizeof(fill));
+        return sizeof(fill);
+    }
+    }
+}
+
+// About a second of 10 kpps from one sender, 100 us apart, while a controller
+// sets channel 100 once per frame. Once the flood has used up its burst,
+// the controller's commands must show up on the next frame, the flood's
+// frames are shed, and its commands are held with the latest value per
+// channel winning.
+static void test_flood(void)
+{
+    server_start(1);
+    rate_limit_init(RATE_LIMIT_DEFAULT_PPS, RATE_LIMIT_DEFAULT_BURST);
+    CHECK_EQ(dmx_set_channel(0, 400, 255, 60000), DMX_CMD_SUCCESS); // Keeps the clock running
+    tick();
+    udp_server_stats_t before = udp_server_get_stats();
+    dmx_manager_stats_t render_before = dmx_manager_get_stats();
+
+    const int pps = 10000;
+    const int per_frame = pps / 1000 * DMX_FRAME_INTERVAL_MS;
+    const int frames = 1000 / DMX_FRAME_INTERVAL_MS;
+    uint8_t packet[DMX_UNIVERSE_SIZE];
+    int expected[9] = {0};
+    int n = 0;
+    uint64_t flood_ns = 0;
+    uint32_t burst_overflows = 0;
+
+    for (int f = 0; f < frames; ++f)
+    {
+        for (int i = 0; i < per_frame; ++i, ++n)
+        {
+            // The last packets of the flood are commands, so the final
+            // value of each channel is known
+            int kind = (f == frames - 1 && i >= per_frame - 16) ? 1 + (n & 1) : n % 3;
+            size_t size = flood_packet(packet, n, kind);
+            if (kind != 0)
+            {
+                expected[1 + n % 8] = n & 0xFF;
+            }
+            host_advance_us(1000000 / pps);
+            uint64_t t0 = bench_now_ns();
+            deliver_from(FLOOD_ADDR, packet, size);
+            flood_ns += bench_now_ns() - t0;
+        }
+
+        // Sent last, so no flood frame of this period overwrites it
+        char command[16];
+        int len = sprintf(command, "DMXC100#%d", f + 1);
+        deliver_from(SOURCE(7), command, (size_t)len);
+
+        uint32_t waits = host_task_waits(render);
+        host_timer_fire(frame_timer);
+        wait_pass(waits);
+        if (f == 0)
+        {
+            // The sender's burst may fill the queue within its first frame
+            burst_overflows = udp_server_get_stats().queue_overflows;
+            continue;
+        }
+        CHECK_EQ(wire(0, 100), f + 1);
+    }
+
+    // Held commands go out at the next wakeup after UDP_HOLD_FLUSH_MS
+    host_advance_us(UDP_HOLD_FLUSH_MS * 1000);
+    deliver_from(SOURCE(7), "DMXC100#0", 9);
+    tick();
+    for (int ch = 1; ch <= 8; ++ch)
+    {
+        CHECK_EQ(wire(0, ch), expected[ch]);
+    }
+
+    udp_server_stats_t stats = udp_server_get_stats();
+    dmx_manager_stats_t render_stats = dmx_manager_get_stats();
+    CHECK_EQ(stats.packets_received - before.packets_received, frames * per_frame + frames + 1);
+    CHECK_EQ(stats.queue_overflows, burst_overflows);
+    CHECK(stats.packets_shed - before.packets_shed > (uint32_t)(frames * per_frame / 3 * 9 / 10));
+    CHECK(stats.commands_held - before.commands_held > 0);
+    CHECK_EQ(render_stats.render_wakeups - render_before.render_wakeups, frames + 1);
+
+    rate_limit_source_t sources[RATE_LIMIT_MAX_SOURCES + 1];
+    int count = rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1);
+    CHECK_EQ(count, 2);
+    for (int i = 0; i < count; ++i)
+    {
+        if (sources[i].addr == FLOOD_ADDR)
+        {
+            CHECK_EQ(sources[i].packets, frames * per_frame);
+            CHECK(sources[i].frames_dropped > 0 && sources[i].commands_held > 0);
+        }
+        else
+        {
+            CHECK_EQ(sources[i].addr, SOURCE(7));
+            CHECK_EQ(sources[i].frames_dropped + sources[i].commands_held, 0);
+        }
+    }
+
+    printf("flood: %d packets, %u shed, %u commands held, %.0f ns host time per packet\n", n,
+           stats.packets_shed - before.packets_shed, stats.commands_held - before.commands_held,
+           (double)flood_ns / n);
+    server_stop();
+    TEST_PASS("flood");
+}
+
+int main(void)
+{
+    test_bucket();
+    test_source_table();
+    host_log_level(ESP_LOG_ERROR);
+    test_flood();
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Batched receive: one server wakeup reads every datagram waiting on a
+// loopback socket, up to UDP_RX_BATCH, and the render task applies them
+// in a single pass
+#include <stdio.h>
+#include <string.h>
+#include <sys/select.h>
+#include <arpa/inet.h>
+
+#include "server_harness.h"
+
+static int sender = -1;
+static struct sockaddr_in server_addr;
+
+static void setup(void)
+{
+    server_start(1);
+    tick_until_idle();
+
+    // The server task would bind it; the test stands in for its socket
+    server_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(server_socket >= 0);
+    memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK_EQ(bind(server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)), 0);
+    socklen_t len = sizeof(server_addr);
+    CHECK_EQ(getsockname(server_socket, (struct sockaddr *)&server_addr, &len), 0);
+
+    sender = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(sender >= 0);
+}
+
+static void teardown(void)
+{
+    close(sender);
+    close(server_socket);
+    server_socket = -1;
+    server_stop();
+}
+
+// Loopback sends are queued on the server socket by the time sendto returns
+static void send_commands(int first_channel, int count)
+{
+    char text[32];
+    for (int i = 0; i < count; ++i)
+    {
+        int len = snprintf(text, sizeof(text), "DMXC%d#%d", first_channel + i, 100 + i);
+        CHECK_EQ(sendto(sender, text, len, 0, (struct sockaddr *)&server_addr, sizeof(server_addr)), len);
+    }
+}
+
+// What select() reports for the server socket right now
+static bool readable(fd_set *read_fds)
+{
+    struct timeval none = {0};
+    FD_ZERO(read_fds);
+    FD_SET(server_socket, read_fds);
+    return select(server_socket + 1, read_fds, NULL, NULL, &none) > 0;
+}
+
+// One wakeup of the server task; returns once the render task has run the
+// pass it requested, the frame clock being stopped
+static void wakeup(fd_set *read_fds)
+{
+    static char rx_buffer[UDP_BUFFER_SIZE];
+    uint32_t waits = host_task_waits(render);
+    handle_wakeup(read_fds, rx_buffer);
+    wait_pass(waits);
+}
+
+static void test_burst_in_one_pass(void)
+{
+    setup();
+    send_commands(10, 10);
+
+    fd_set read_fds;
+    CHECK(readable(&read_fds));
+    wakeup(&read_fds);
+
+    // All ten in the pass the wakeup requested, nothing left on the socket
+    for (int i = 0; i < 10; ++i)
+    {
+        CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[10 + i], 100 + i);
+    }
+    CHECK(!readable(&read_fds));
+
+    udp_server_stats_t stats = udp_server_get_stats();
+    CHECK_EQ(stats.rx_datagrams, 10);
+    CHECK_EQ(stats.rx_wakeups, 1);
+    CHECK_EQ(stats.rx_batch_max, 10);
+    CHECK_EQ(stats.rx_batch_limited, 0);
+    CHECK_EQ(stats.rx_errors, 0);
+    CHECK_EQ(stats.queue_high_water, 10);
+    CHECK_EQ(stats.commands_executed, 10);
+    teardown();
+    TEST_PASS("burst_in_one_pass");
+}
+
+static void test_batch_limit(void)
+{
+    setup();
+    send_commands(40, UDP_RX_BATCH + 4);
+
+    // The first wakeup stops at UDP_RX_BATCH, select() reports the rest
+    fd_set read_fds;
+    CHECK(readable(&read_fds));
+    wakeup(&read_fds);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[40 + UDP_RX_BATCH - 1], 100 + UDP_RX_BATCH - 1);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[40 + UDP_RX_BATCH], 0);
+    udp_server_stats_t stats = udp_server_get_stats();
+    CHECK_EQ(stats.rx_datagrams, UDP_RX_BATCH);
+    CHECK_EQ(stats.rx_batch_limited, 1);
+
+    tick_until_idle(); // The writes restarted the clock
+    CHECK(readable(&read_fds));
+    wakeup(&read_fds);
+    CHECK_EQ(host_dmx_port(DMX_NUM_1)->wire[40 + UDP_RX_BATCH + 3], 100 + UDP_RX_BATCH + 3);
+    CHECK(!readable(&read_fds));
+
+    stats = udp_server_get_stats();
+    CHECK_EQ(stats.rx_datagrams, UDP_RX_BATCH + 4);
+    CHECK_EQ(stats.rx_wakeups, 2);
+    CHECK_EQ(stats.rx_batch_max, UDP_RX_BATCH);
+    CHECK_EQ(stats.rx_batch_limited, 1);
+
+    // A hold timeout with nothing held reads nothing and wakes nobody
+    tick_until_idle();
+    uint32_t waits = host_task_waits(render);
+    static char rx_buffer[UDP_BUFFER_SIZE];
+    handle_wakeup(NULL, rx_buffer);
+    CHECK_EQ(host_task_waits(render), waits);
+    CHECK(!host_timer_running(frame_timer));
+    CHECK_EQ(udp_server_get_stats().rx_wakeups, 2);
+    teardown();
+    TEST_PASS("batch_limit");
+}
+
+// SO_RCVBUF holds UDP_RX_BATCH datagrams of the configured size
+static void test_receive_buffer(void)
+{
+    start(1);
+    CHECK_EQ(udp_server_init(UDP_DEFAULT_PORT, 600), ESP_OK);
+    CHECK_EQ(server_rcvbuf, 600 * UDP_RX_BATCH);
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(sock >= 0);
+    set_receive_buffer(sock);
+    int rcvbuf = 0;
+    socklen_t len = sizeof(rcvbuf);
+    CHECK_EQ(getsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &len), 0);
+    CHECK(rcvbuf >= 600 * UDP_RX_BATCH);
+    close(sock);
+    udp_server_deinit();
+
+    // Without a size, full-size datagrams
+    CHECK_EQ(udp_server_init(UDP_DEFAULT_PORT, 0), ESP_OK);
+    CHECK_EQ(server_rcvbuf, UDP_BUFFER_SIZE * UDP_RX_BATCH);
+    udp_server_deinit();
+    stop();
+    TEST_PASS("receive_buffer");
+}
+
+int main(void)
+{
+    test_burst_in_one_pass();
+    test_batch_limit();
+    test_receive_buffer();
+    return 0;
+}
@@ -0,0 +1,313 @@
+// sACN (E1.31) receiver: packet parsing, source tracking and priority,
+// and frames sent over a loopback socket to the running server task
+#include <string.h>
+#include <errno.h>
+
+#include "server_harness.h"
+#include "freertos/task.h"
+
+static const uint8_t cid_a[16] = {0x5a, 0x3c, 0x11, 0x8e, 0x02, 0x44, 0x4f, 0x61,
+                                  0x9b, 0x27, 0xd0, 0x13, 0x6e, 0xa8, 0x40, 0x01};
+static const uint8_t cid_b[16] = {0x5a, 0x3c, 0x11, 0x8e, 0x02, 0x44, 0x4f, 0x61,
+                                  0x9b, 0x27, 0xd0, 0x13, 0x6e, 0xa8, 0x40, 0x02};
+
+typedef struct
+{
+    const uint8_t *cid;
+    uint8_t priority;
+    uint8_t sequence;
+    uint8_t options;
+    uint16_t universe;
+    uint8_t start_code;
+} sacn_header_t;
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put_pdu_length(uint8_t *p, size_t length)
+{
+    put_u16(p, (uint16_t)(0x7000 | length));
+}
+
+// E1.31 data packet as a sender puts it on the wire, returns its size
+static size_t sacn_packet(uint8_t *buf, const sacn_header_t *h, const uint8_t *slots, size_t count)
+{
+    static const uint8_t acn_id[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+    size_t len = SACN_DMP_DATA_OFFSET + count;
+    memset(buf, 0, SACN_DMP_DATA_OFFSET);
+
+    // Root layer
+    put_u16(&buf[0], 0x0010);
+    memcpy(&buf[4], acn_id, sizeof(acn_id));
+    put_pdu_length(&buf[16], len - 16);
+    buf[21] = 0x04;
+    memcpy(&buf[22], h->cid, 16);
+
+    // Framing layer
+    put_pdu_length(&buf[38], len - 38);
+    buf[43] = 0x02;
+    strcpy((char *)&buf[44], "host test");
+    buf[108] = h->priority;
+    buf[111] = h->sequence;
+    buf[112] = h->options;
+    put_u16(&buf[113], h->universe);
+
+    // DMP layer
+    put_pdu_length(&buf[115], len - 115);
+    buf[117] = 0x02;
+    buf[118] = 0xa1;
+    put_u16(&buf[121], 0x0001);
+    put_u16(&buf[123], (uint16_t)(count + 1));
+    buf[125] = h->start_code;
+    memcpy(&buf[SACN_DMP_DATA_OFFSET], slots, count);
+    return len;
+}
+
+static void test_parse(void)
+{
+    sacn_reset_stats();
+    sacn_publish_stats();
+    uint8_t buf[SACN_MAX_PACKET_SIZE];
+    uint8_t slots[DMX_UNIVERSE_SIZE];
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i)
+    {
+        slots[i] = (uint8_t)(i * 3);
+    }
+    sacn_header_t h = {.cid = cid_a, .priority = 100, .sequence = 7, .universe = 1};
+
+    size_t len = sacn_packet(buf, &h, slots, DMX_UNIVERSE_SIZE);
+    CHECK_EQ(len, SACN_MAX_PACKET_SIZE);
+    sacn_packet_t packet;
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_OK);
+    CHECK(memcmp(packet.cid, cid_a, 16) == 0);
+    CHECK_EQ(packet.priority, 100);
+    CHECK_EQ(packet.sequence, 7);
+    CHECK_EQ(packet.universe, 1);
+    CHECK_EQ(packet.length, DMX_UNIVERSE_SIZE);
+    CHECK(packet.data == buf + SACN_DMP_DATA_OFFSET);
+    CHECK_EQ(packet.data[511], (uint8_t)(511 * 3));
+
+    len = sacn_packet(buf, &h, slots, 24);
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_OK);
+    CHECK_EQ(packet.length, 24);
+
+    // Malformed packets
+    CHECK_EQ(sacn_parse(buf, SACN_DMP_DATA_OFFSET - 1, &packet), SACN_ERR_HEADER);
+    CHECK_EQ(sacn_parse(buf, len - 1, &packet), SACN_ERR_LENGTH);
+    buf[4] = 'a';
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_ERR_HEADER);
+    buf[4] = 'A';
+    buf[43] = 0x01;
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_ERR_VECTOR);
+    buf[43] = 0x02;
+    put_pdu_length(&buf[38], len - 37);
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_ERR_LENGTH);
+    h.universe = 0;
+    len = sacn_packet(buf, &h, slots, 24);
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_ERR_HEADER);
+    h.universe = 1;
+    h.priority = SACN_MAX_PRIORITY + 1;
+    len = sacn_packet(buf, &h, slots, 24);
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_ERR_HEADER);
+    h.priority = 100;
+
+    // Preview data, alternate START codes and extended packets are ignored
+    h.options = 0x80;
+    len = sacn_packet(buf, &h, slots, 24);
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_IGNORED);
+    h.options = 0;
+    h.start_code = 0xdd;
+    len = sacn_packet(buf, &h, slots, 24);
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_IGNORED);
+    h.start_code = 0;
+    len = sacn_packet(buf, &h, slots, 24);
+    buf[21] = 0x08;
+    CHECK_EQ(sacn_parse(buf, len, &packet), SACN_IGNORED);
+
+    sacn_publish_stats();
+    sacn_stats_t stats = sacn_get_stats();
+    CHECK_EQ(stats.packets_received, 4);
+    CHECK_EQ(stats.packets_filtered, 3);
+    CHECK_EQ(stats.packets_invalid, 7);
+    CHECK_EQ(sacn_multicast_address(0x1234), 0xEFFF1234);
+    TEST_PASS("parse");
+}
+
+static sacn_result_t source_accept(const uint8_t *cid, uint8_t priority, uint8_t sequence, uint8_t options,
+                            uint16_t universe, uint32_t now_ms, int *local)
+{
+    sacn_packet_t packet = {.cid = cid, .priority = priority, .sequence = sequence,
+                            .options = options, .universe = universe, .length = 1};
+    return sacn_accept(&packet, now_ms, local);
+}
+
+static void test_sources(void)
+{
+    sacn_init(10, 2);
+    sacn_reset_stats();
+    sacn_publish_stats();
+    int local = -1;
+
+    CHECK_EQ(source_accept(cid_a, 100, 1, 0, 9, 0, &local), SACN_NOT_OURS);
+    CHECK_EQ(source_accept(cid_a, 100, 1, 0, 12, 0, &local), SACN_NOT_OURS);
+    CHECK_EQ(source_accept(cid_a, 100, 1, 0, 11, 0, &local), SACN_OK);
+    CHECK_EQ(local, 1);
+    CHECK_EQ(source_accept(cid_a, 100, 1, 0, 10, 0, &local), SACN_OK);
+    CHECK_EQ(local, 0);
+
+    // E1.31 6.7.2: a step back of less than 20 is out of order
+    CHECK_EQ(source_accept(cid_a, 100, 1, 0, 10, 10, &local), SACN_OUT_OF_ORDER);
+    CHECK_EQ(source_accept(cid_a, 100, 238, 0, 10, 10, &local), SACN_OUT_OF_ORDER);
+    CHECK_EQ(source_accept(cid_a, 100, 237, 0, 10, 10, &local), SACN_OK);
+    CHECK_EQ(source_accept(cid_a, 100, 240, 0, 10, 10, &local), SACN_OK);
+    CHECK_EQ(source_accept(cid_a, 100, 4, 0, 10, 10, &local), SACN_OK); // Wrapped
+
+    // Equal priority: the owner keeps the universe; higher takes it over
+    CHECK_EQ(source_accept(cid_b, 100, 1, 0, 10, 20, &local), SACN_LOW_PRIORITY);
+    CHECK_EQ(source_accept(cid_b, 150, 2, 0, 10, 30, &local), SACN_OK);
+    CHECK_EQ(source_accept(cid_a, 100, 5, 0, 10, 40, &local), SACN_LOW_PRIORITY);
+
+    // Stream_Terminated hands the universe to the remaining source
+    CHECK_EQ(source_accept(cid_b, 150, 3, 0x40, 10, 50, &local), SACN_TERMINATED);
+    CHECK_EQ(source_accept(cid_a, 100, 6, 0, 10, 60, &local), SACN_OK);
+
+    // A silent source times out
+    CHECK_EQ(source_accept(cid_b, 150, 1, 0, 10, 70, &local), SACN_OK);
+    CHECK_EQ(source_accept(cid_a, 100, 7, 0, 10, 70 + SACN_SOURCE_TIMEOUT_MS, &local), SACN_LOW_PRIORITY);
+    CHECK_EQ(source_accept(cid_a, 100, 8, 0, 10, 71 + SACN_SOURCE_TIMEOUT_MS, &local), SACN_OK);
+
+    // No more than SACN_MAX_SOURCES per universe
+    uint8_t cid[16];
+    memcpy(cid, cid_a, sizeof(cid));
+    for (int i = 0; i < SACN_MAX_SOURCES - 1; ++i)
+    {
+        cid[0] = (uint8_t)(0x80 + i);
+        CHECK_EQ(source_accept(cid, 10, 1, 0, 10, 2600, &local), SACN_LOW_PRIORITY);
+    }
+    cid[0] = 0xff;
+    CHECK_EQ(source_accept(cid, 200, 1, 0, 10, 2600, &local), SACN_SOURCES_FULL);
+
+    sacn_publish_stats();
+    sacn_stats_t stats = sacn_get_stats();
+    CHECK_EQ(stats.packets_accepted, 9);
+    CHECK_EQ(stats.packets_filtered, 2);
+    CHECK_EQ(stats.out_of_order, 2);
+    CHECK_EQ(stats.low_priority, 2 + 1 + SACN_MAX_SOURCES - 1);
+    CHECK_EQ(stats.sources_terminated, 1);
+    CHECK_EQ(stats.sources_timed_out, 2);
+    CHECK_EQ(stats.sources_full, 1);
+    CHECK_EQ(stats.active_sources, 1 + SACN_MAX_SOURCES);
+    TEST_PASS("sources");
+}
+
+static int sender = -1;
+
+// Send a packet to the server's sACN socket and wait until the server
+// has read it and the render task has run any pass it was woken for
+static void send_sacn(const uint8_t *packet, size_t len)
+{
+    struct sockaddr_in dest = {
+        .sin_family = AF_INET,
+        .sin_port = htons(SACN_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+
+    uint32_t before = udp_server_get_stats().rx_datagrams;
+    CHECK_EQ(sendto(sender, packet, len, 0, (struct sockaddr *)&dest, sizeof(dest)), (long long)len);
+    for (int i = 0; i < 2000 && udp_server_get_stats().rx_datagrams == before; ++i)
+    {
+        vTaskDelay(1);
+    }
+    CHECK(udp_server_get_stats().rx_datagrams > before);
+    host_task_wait_blocked(render, host_task_waits(render));
+}
+
+static void test_loopback(void)
+{
+    start(2);
+    sacn_init(1, 2);
+    rate_limit_init(0, 0);
+    CHECK_EQ(udp_server_init(0, 0), ESP_OK); // Main port: any free one
+    CHECK_EQ(udp_server_start(), ESP_OK);
+    sender = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(sender >= 0);
+
+    // Wait for the sACN socket
+    for (int i = 0; i < 2000 && sacn_socket < 0; ++i)
+    {
+        vTaskDelay(1);
+    }
+    CHECK(sacn_socket >= 0);
+
+    uint8_t buf[SACN_MAX_PACKET_SIZE];
+    uint8_t slots[DMX_UNIVERSE_SIZE];
+    memset(slots, 0, sizeof(slots));
+    sacn_header_t a = {.cid = cid_a, .priority = 100, .sequence = 1, .universe = 1};
+
+    // Full frame on universe 1, sACN universe 2 drives DMX universe 2
+    slots[0] = 11;
+    slots[99] = 22;
+    send_sacn(buf, sacn_packet(buf, &a, slots, DMX_UNIVERSE_SIZE));
+    tick();
+    CHECK_EQ(wire(0, 1), 11);
+    CHECK_EQ(wire(0, 100), 22);
+    sacn_header_t a2 = a;
+    a2.universe = 2;
+    slots[0] = 33;
+    send_sacn(buf, sacn_packet(buf, &a2, slots, 4));
+    tick();
+    CHECK_EQ(wire(1, 1), 33);
+    CHECK_EQ(wire(0, 1), 11);
+
+    // A short frame leaves the fade past its end running, a full one stops it
+    CHECK_EQ(dmx_set_channel(0, 200, 255, 5000), DMX_CMD_SUCCESS);
+    a.sequence++;
+    slots[0] = 44;
+    send_sacn(buf, sacn_packet(buf, &a, slots, 24));
+    tick();
+    CHECK_EQ(wire(0, 1), 44);
+    CHECK(dmx_is_channel_fading(0, 200));
+    a.sequence++;
+    send_sacn(buf, sacn_packet(buf, &a, slots, DMX_UNIVERSE_SIZE));
+    tick();
+    CHECK(!dmx_is_channel_fading(0, 200));
+
+    // Out of order and lower priority data is not applied
+    slots[0] = 55;
+    a.sequence--;
+    send_sacn(buf, sacn_packet(buf, &a, slots, 24));
+    sacn_header_t b = {.cid = cid_b, .priority = 50, .sequence = 1, .universe = 1};
+    send_sacn(buf, sacn_packet(buf, &b, slots, 24));
+    tick();
+    CHECK_EQ(wire(0, 1), 44);
+
+    // The owner goes silent: after the data loss timeout the other source
+    // takes over with its next packet
+    host_advance_us((SACN_SOURCE_TIMEOUT_MS + 1) * 1000);
+    b.sequence++;
+    slots[0] = 66;
+    send_sacn(buf, sacn_packet(buf, &b, slots, 24));
+    tick();
+    CHECK_EQ(wire(0, 1), 66);
+
+    sacn_stats_t stats = sacn_get_stats();
+    CHECK(stats.out_of_order >= 1);
+    CHECK(stats.low_priority >= 1);
+    CHECK(stats.sources_timed_out >= 1);
+
+    close(sender);
+    udp_server_stop(); // The server thread is left blocked in select()
+    stop();
+    TEST_PASS("loopback");
+}
+
+int main(void)
+{
+    host_log_level(ESP_LOG_ERROR); // Multicast joins fail without a route
+    test_parse();
+    test_sources();
+    test_loopback();
+    return 0;
+}
@@ -0,0 +1,211 @@
+// Statistics snapshots: readers on other threads never see a half-written
+// publish, resets requested from any task are applied by the counting
+// task, and fades armed off the render task are all counted
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "artnet.h"
+#include "rate_limit.h"
+#include "stats_seqlock.h"
+#include "render_harness.h"
+
+// Large enough that a publish is far from a single store
+typedef struct
+{
+    uint32_t values[64];
+} wide_stats_t;
+
+static wide_stats_t wide_shared;
+static stats_seqlock_t wide_lock = STATS_SEQLOCK_INIT;
+static atomic_bool stop_writer;
+
+// Publishes until the reader has done its reads
+static void *wide_writer(void *arg)
+{
+    (void)arg;
+    wide_stats_t local;
+    for (uint32_t n = 1; !atomic_load(&stop_writer); ++n)
+    {
+        for (int i = 0; i < 64; ++i)
+        {
+            local.values[i] = n;
+        }
+        stats_seqlock_publish(&wide_lock, &wide_shared, &local, sizeof(local));
+    }
+    return NULL;
+}
+
+static void test_no_torn_reads(void)
+{
+    pthread_t thread;
+    CHECK_EQ(pthread_create(&thread, NULL, wide_writer, NULL), 0);
+    int torn = 0;
+    uint32_t last = 0;
+    bool backwards = false;
+    for (int n = 0; n < 4000000; ++n)
+    {
+        wide_stats_t copy;
+        stats_seqlock_read(&wide_lock, &copy, &wide_shared, sizeof(copy));
+        for (int i = 1; i < 64; ++i)
+        {
+            if (copy.values[i] != copy.values[0])
+            {
+                torn++;
+                break;
+            }
+        }
+        backwards |= copy.values[0] < last;
+        last = copy.values[0];
+    }
+    atomic_store(&stop_writer, true);
+    pthread_join(thread, NULL);
+    CHECK_EQ(torn, 0);
+    CHECK(!backwards);
+    TEST_PASS("no_torn_reads");
+}
+
+// ArtPoll, ProtVer 14
+static const uint8_t artpoll[] = {
+    'A', 'r', 't', '-', 'N', 'e', 't', 0x00,
+    0x00, 0x20,
+    0x00, 0x0e,
+    0x06, 0x00};
+
+static void test_deferred_reset(void)
+{
+    artnet_init(artnet_port_address(0, 0, 0), 1);
+    artnet_reset_stats();
+    artnet_publish_stats();
+
+    // Counts show at the next publish
+    CHECK_EQ(artnet_parse_poll(artpoll, sizeof(artpoll)), ARTNET_OK);
+    CHECK_EQ(artnet_get_stats().polls_received, 0);
+    artnet_publish_stats();
+    CHECK_EQ(artnet_get_stats().polls_received, 1);
+
+    // So does a reset, and counts in between are cleared with it
+    artnet_reset_stats();
+    CHECK_EQ(artnet_get_stats().polls_received, 1);
+    CHECK_EQ(artnet_parse_poll(artpoll, sizeof(artpoll)), ARTNET_OK);
+    artnet_publish_stats();
+    CHECK_EQ(artnet_get_stats().polls_received, 0);
+
+    // The rate limiter keeps its sources across a reset
+    rate_limit_init(1000, 100);
+    CHECK_EQ(rate_limit_check(0x0100000a, RATE_LIMIT_COMMAND, 0), RATE_LIMIT_PASS);
+    rate_limit_publish_stats();
+    rate_limit_source_t source;
+    CHECK_EQ(rate_limit_get_sources(&source, 1), 1);
+    CHECK_EQ(source.packets, 1);
+    rate_limit_reset_stats();
+    rate_limit_publish_stats();
+    CHECK_EQ(rate_limit_get_sources(&source, 1), 1);
+    CHECK_EQ(source.addr, 0x0100000a);
+    CHECK_EQ(source.packets, 0);
+    CHECK_EQ(rate_limit_get_stats().packets_checked, 0);
+    TEST_PASS("deferred_reset");
+}
+
+// The server task charges every source once per publish while another
+// task reads and resets: each snapshot has the same count for all of them
+#define SOURCES 3
+
+static atomic_bool reader_done;
+
+static void *source_reader(void *arg)
+{
+    int *uneven = arg;
+    for (uint32_t n = 1; n <= 1000000; ++n)
+    {
+        rate_limit_source_t sources[RATE_LIMIT_MAX_SOURCES + 1];
+        int count = rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1);
+        for (int i = 1; i < count; ++i)
+        {
+            if (sources[i].packets != sources[0].packets)
+            {
+                (*uneven)++;
+                break;
+            }
+        }
+        if ((n & 1023) == 0)
+        {
+            rate_limit_reset_stats();
+        }
+    }
+    atomic_store(&reader_done, true);
+    return NULL;
+}
+
+static void test_sources_from_another_task(void)
+{
+    rate_limit_init(1000000, 1000);
+    int uneven = 0;
+    pthread_t thread;
+    CHECK_EQ(pthread_create(&thread, NULL, source_reader, &uneven), 0);
+    for (uint32_t now_ms = 0; !atomic_load(&reader_done); ++now_ms)
+    {
+        for (uint32_t addr = 1; addr <= SOURCES; ++addr)
+        {
+            CHECK_EQ(rate_limit_check(addr, RATE_LIMIT_COMMAND, now_ms), RATE_LIMIT_PASS);
+        }
+        rate_limit_publish_stats();
+    }
+    pthread_join(thread, NULL);
+    CHECK_EQ(uneven, 0);
+
+    rate_limit_source_t sources[RATE_LIMIT_MAX_SOURCES + 1];
+    CHECK_EQ(rate_limit_get_sources(sources, RATE_LIMIT_MAX_SOURCES + 1), SOURCES);
+    TEST_PASS("sources_from_another_task");
+}
+
+// Fades started from several tasks at once, as the command and REST paths
+// do; the render task folds them into fades_started at its next publish
+#define FADE_TASKS 4
+#define FADES_PER_TASK 2000
+
+static void *fade_starter(void *arg)
+{
+    int channel = 1 + (int)(intptr_t)arg;
+    for (int i = 0; i < FADES_PER_TASK; ++i)
+    {
+        dmx_set_channel(0, channel, (uint8_t)i, 1000);
+    }
+    return NULL;
+}
+
+static void test_fades_from_other_tasks(void)
+{
+    start(1);
+    dmx_manager_stats_t before = dmx_manager_get_stats();
+    pthread_t threads[FADE_TASKS];
+    for (intptr_t t = 0; t < FADE_TASKS; ++t)
+    {
+        CHECK_EQ(pthread_create(&threads[t], NULL, fade_starter, (void *)t), 0);
+    }
+    for (int t = 0; t < FADE_TASKS; ++t)
+    {
+        pthread_join(threads[t], NULL);
+    }
+
+    // The second pass starts after the last fade was armed
+    tick();
+    tick();
+    dmx_manager_stats_t stats = dmx_manager_get_stats();
+    CHECK_EQ(stats.fades_started - before.fades_started, FADE_TASKS * FADES_PER_TASK);
+
+    dmx_stop_all_fades(0);
+    tick_until_idle();
+    stop();
+    TEST_PASS("fades_from_other_tasks");
+}
+
+int main(void)
+{
+    test_no_torn_reads();
+    test_deferred_reset();
+    test_sources_from_another_task();
+    test_fades_from_other_tasks();
+    return 0;
+}
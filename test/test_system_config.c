@@ -0,0 +1,89 @@
+// system_config in NVS: a stored blob is only taken when its layout
+// version and size match this firmware, otherwise the defaults apply
+#include "system_config.h"
+
+#include "nvs.h"
+#include "host.h"
+#include "test_util.h"
+
+static void store(const void *blob, size_t size, const uint32_t *version)
+{
+    host_nvs_erase();
+    nvs_handle_t handle;
+    CHECK_EQ(nvs_open("system_cfg", NVS_READWRITE, &handle), ESP_OK);
+    CHECK_EQ(nvs_set_blob(handle, "config", blob, size), ESP_OK);
+    if (version)
+    {
+        CHECK_EQ(nvs_set_u32(handle, "config_ver", *version), ESP_OK);
+    }
+    nvs_close(handle);
+}
+
+static void check_defaults(void)
+{
+    const system_config_t *config = system_config_get();
+    CHECK_EQ(config->dmx.universe_size, 512);
+    CHECK_EQ(config->network.udp_port, 6454);
+}
+
+static void test_round_trip(void)
+{
+    host_nvs_erase();
+    CHECK_EQ(system_config_init(), ESP_OK);
+    check_defaults();
+
+    CHECK_EQ(system_config_set_dmx_output(64, 10), ESP_OK);
+    CHECK_EQ(system_config_load_defaults(), ESP_OK);
+    CHECK_EQ(system_config_load_from_nvs(), ESP_OK);
+    CHECK_EQ(system_config_get()->dmx.universe_size, 64);
+    CHECK_EQ(system_config_get()->dmx.fade_interval_ms, 10);
+    TEST_PASS("round_trip");
+}
+
+static void test_layout_mismatch(void)
+{
+    system_config_t config = *system_config_get();
+    config.dmx.universe_size = 100;
+    uint32_t version = SYSTEM_CONFIG_VERSION;
+    uint32_t old_version = SYSTEM_CONFIG_VERSION - 1;
+
+    // Blob written before the version key existed
+    store(&config, sizeof(config), NULL);
+    CHECK_EQ(system_config_load_from_nvs(), ESP_ERR_INVALID_VERSION);
+    check_defaults();
+
+    // Older layout version
+    store(&config, sizeof(config), &old_version);
+    CHECK_EQ(system_config_load_from_nvs(), ESP_ERR_INVALID_VERSION);
+    check_defaults();
+
+    // Right version, wrong size (a field added without a version bump)
+    uint8_t longer[sizeof(config) + 8] = {0};
+    memcpy(longer, &config, sizeof(config));
+    store(longer, sizeof(longer), &version);
+    CHECK_EQ(system_config_load_from_nvs(), ESP_ERR_INVALID_VERSION);
+    check_defaults();
+    store(&config, sizeof(config) - 4, &version);
+    CHECK_EQ(system_config_load_from_nvs(), ESP_ERR_INVALID_VERSION);
+    check_defaults();
+
+    // Matching layout, out-of-range content
+    config.dmx.universe_size = 0;
+    store(&config, sizeof(config), &version);
+    CHECK_EQ(system_config_load_from_nvs(), ESP_ERR_INVALID_CRC);
+    check_defaults();
+
+    config.dmx.universe_size = 100;
+    store(&config, sizeof(config), &version);
+    CHECK_EQ(system_config_load_from_nvs(), ESP_OK);
+    CHECK_EQ(system_config_get()->dmx.universe_size, 100);
+    TEST_PASS("layout_mismatch");
+}
+
+int main(void)
+{
+    host_log_level(ESP_LOG_NONE);
+    test_round_trip();
+    test_layout_mismatch();
+    return 0;
+}
@@ -0,0 +1,438 @@
+// Datagram parsers. ASCII: field decoding, every error code, explicit
+// lengths, batches, and agreement with the old strdup/strtok parser on
+// well-formed commands. Binary and span: records, payloads and rejection.
+// Subscriptions: fields, and that nothing chooses where notifications go.
+#include <stdio.h>
+#include <string.h>
+
+#include "udp_protocol.h"
+#include "legacy_udp_parser.h"
+#include "test_util.h"
+
+static udp_parse_error_t parse(const char *text, udp_parsed_command_t *cmd)
+{
+    return udp_parse_command(text, strlen(text), cmd);
+}
+
+static void test_fields(void)
+{
+    udp_parsed_command_t cmd;
+
+    CHECK_EQ(parse("DMXC10#255", &cmd), UDP_PARSE_OK);
+    CHECK(cmd.valid);
+    CHECK_EQ(cmd.type, UDP_CMD_CHANNEL);
+    CHECK_EQ(cmd.universe, 0);
+    CHECK_EQ(cmd.channel, 10);
+    CHECK_EQ(cmd.count, 1);
+    CHECK_EQ(cmd.levels[0], 255);
+    CHECK_EQ(cmd.fade_ms, 0);
+
+    CHECK_EQ(parse("DMXC10#300", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.value, 300);
+    CHECK_EQ(cmd.levels[0], 255);
+
+    CHECK_EQ(parse("DMXP5#50#10", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.type, UDP_CMD_PERCENTAGE);
+    CHECK_EQ(cmd.levels[0], 127);
+    CHECK_EQ(cmd.fade_ms, 10 * 591);
+
+    CHECK_EQ(parse("DMXP5#150", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.levels[0], 255);
+
+    // RGB is bbbgggrrr
+    CHECK_EQ(parse("DMXR1#255128064#202", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.count, 3);
+    CHECK_EQ(cmd.levels[0], 64);
+    CHECK_EQ(cmd.levels[1], 128);
+    CHECK_EQ(cmd.levels[2], 255);
+    CHECK_EQ(cmd.fade_ms, 2 * 72);
+
+    CHECK_EQ(parse("DMXR1#999999", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.levels[0], 255);
+    CHECK_EQ(cmd.levels[1], 255);
+    CHECK_EQ(cmd.levels[2], 0);
+
+    // Tunable white is wwwccc
+    CHECK_EQ(parse("DMXW3#100200#102", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.count, 2);
+    CHECK_EQ(cmd.levels[0], 100);
+    CHECK_EQ(cmd.levels[1], 200);
+    CHECK_EQ(cmd.fade_ms, 2 * 146 + 1);
+
+    // Light CT is 20BBBTTTT, brightness capped at 100%
+    CHECK_EQ(parse("DMXL7#200506500", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.count, 2);
+    CHECK_EQ(cmd.brightness, 50);
+    CHECK_EQ(cmd.color_temp, 6500);
+    CHECK_EQ(parse("DMXL7#209992700", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.brightness, 100);
+    CHECK_EQ(cmd.color_temp, 2700);
+
+    // Universe prefix counts from 1
+    CHECK_EQ(parse("DMXC2:10#1", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.universe, 1);
+    CHECK_EQ(cmd.channel, 10);
+
+    // Line endings, padding and a sent terminator are tolerated
+    CHECK_EQ(parse("DMXC1#1\r\n", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(parse("DMXC1#1 ", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(udp_parse_command("DMXC1#1\0", 8, &cmd), UDP_PARSE_OK);
+
+    // An empty speed field is no fade, like a missing one
+    CHECK_EQ(parse("DMXC1#1#", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.fade_ms, 0);
+
+    TEST_PASS("fields");
+}
+
+static void test_errors(void)
+{
+    static const struct {
+        const char *text;
+        udp_parse_error_t err;
+    } cases[] = {
+        {"", UDP_PARSE_ERR_EMPTY},
+        {"\r\n", UDP_PARSE_ERR_EMPTY},
+        {"DMX", UDP_PARSE_ERR_PREFIX},
+        {"DMY1#1", UDP_PARSE_ERR_PREFIX},
+        {"dmxC1#1", UDP_PARSE_ERR_PREFIX},
+        {"DMXZ1#1", UDP_PARSE_ERR_TYPE},
+        {"DMXS1#1", UDP_PARSE_ERR_TYPE}, // Binary only
+        {"DMXC0:1#1", UDP_PARSE_ERR_UNIVERSE},
+        {"DMXC#1", UDP_PARSE_ERR_CHANNEL},
+        {"DMXC1:#1", UDP_PARSE_ERR_CHANNEL},
+        {"DMXC-1#1", UDP_PARSE_ERR_CHANNEL},
+        {"DMXC1", UDP_PARSE_ERR_VALUE},
+        {"DMXC1#", UDP_PARSE_ERR_VALUE},
+        {"DMXC1#-5", UDP_PARSE_ERR_VALUE},
+        {"DMXC1:2:3#1", UDP_PARSE_ERR_VALUE},
+        {"DMXC1#1#x", UDP_PARSE_ERR_SPEED},
+        {"DMXC1#2147483648", UDP_PARSE_ERR_OVERFLOW},
+        {"DMXC99999999999#1", UDP_PARSE_ERR_OVERFLOW},
+        {"DMXC1#1#99999999999", UDP_PARSE_ERR_OVERFLOW},
+        {"DMXC1#1#1x", UDP_PARSE_ERR_TRAILING},
+        {"DMXC1#1#1#1", UDP_PARSE_ERR_TRAILING},
+        {"DMXC1#1x", UDP_PARSE_ERR_TRAILING},
+        {"DMXR1#1000000000", UDP_PARSE_ERR_VALUE},
+        {"DMXL1#199999999", UDP_PARSE_ERR_VALUE},
+        {"DMXL1#210000000", UDP_PARSE_ERR_VALUE},
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        udp_parsed_command_t cmd;
+        udp_parse_error_t err = parse(cases[i].text, &cmd);
+        if (err != cases[i].err)
+        {
+            fprintf(stderr, "\"%s\": %s, expected %s\n", cases[i].text,
+                    udp_parse_error_name(err), udp_parse_error_name(cases[i].err));
+        }
+        CHECK_EQ(err, cases[i].err);
+        CHECK(!cmd.valid);
+    }
+
+    udp_parsed_command_t cmd;
+    CHECK_EQ(parse("DMXC1#2147483647", &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.value, 2147483647);
+    CHECK_EQ(udp_parse_command(NULL, 4, &cmd), UDP_PARSE_ERR_EMPTY);
+    CHECK_EQ(udp_parse_command("DMXC1#1", 7, NULL), UDP_PARSE_ERR_EMPTY);
+
+    TEST_PASS("errors");
+}
+
+// The parser reads buf[0..len) only, the datagram is not terminated
+static void test_explicit_length(void)
+{
+    static const char datagram[] = "DMXC12#345#1999";
+    udp_parsed_command_t cmd;
+
+    CHECK_EQ(udp_parse_command(datagram, 10, &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.channel, 12);
+    CHECK_EQ(cmd.value, 345);
+    CHECK_EQ(cmd.fade_ms, 0);
+
+    CHECK_EQ(udp_parse_command(datagram, 12, &cmd), UDP_PARSE_OK);
+    CHECK_EQ(cmd.fade_ms, 591);
+
+    CHECK_EQ(udp_parse_command(datagram, 7, &cmd), UDP_PARSE_ERR_VALUE);
+    CHECK_EQ(udp_parse_command(datagram, 3, &cmd), UDP_PARSE_ERR_PREFIX);
+
+    TEST_PASS("explicit_length");
+}
+
+static void test_batch(void)
+{
+    udp_parsed_command_t cmds[UDP_MAX_BATCH_COMMANDS];
+
+    static const char mixed[] = "DMXC1#1;DMXC2#2\r\n\nDMXZ3#3;;DMXP4#50;DMXC5#1x\n";
+    udp_batch_result_t result = udp_parse_batch(mixed, sizeof(mixed) - 1, cmds, UDP_MAX_BATCH_COMMANDS);
+    CHECK_EQ(result.count, 3);
+    CHECK_EQ(result.rejected, 2);
+    CHECK_EQ(result.first_error, UDP_PARSE_ERR_TYPE);
+    CHECK_EQ(result.errors[UDP_PARSE_ERR_TYPE], 1);
+    CHECK_EQ(result.errors[UDP_PARSE_ERR_TRAILING], 1);
+    CHECK_EQ(cmds[0].channel, 1);
+    CHECK_EQ(cmds[1].channel, 2);
+    CHECK_EQ(cmds[2].channel, 4);
+    CHECK_EQ(cmds[2].levels[0], 127);
+
+    // Only separators
+    result = udp_parse_batch(";\r\n;", 4, cmds, UDP_MAX_BATCH_COMMANDS);
+    CHECK_EQ(result.count, 0);
+    CHECK_EQ(result.first_error, UDP_PARSE_ERR_EMPTY);
+
+    // Commands past the limit are rejected, not dropped silently
+    char many[64 * 12];
+    size_t len = 0;
+    for (int i = 1; i <= UDP_MAX_BATCH_COMMANDS + 3; ++i)
+    {
+        len += (size_t)snprintf(many + len, sizeof(many) - len, "DMXC%d#%d;", i, i);
+    }
+    result = udp_parse_batch(many, len, cmds, UDP_MAX_BATCH_COMMANDS);
+    CHECK_EQ(result.count, UDP_MAX_BATCH_COMMANDS);
+    CHECK_EQ(result.rejected, 3);
+    CHECK_EQ(result.first_error, UDP_PARSE_ERR_TOO_MANY);
+    CHECK_EQ(cmds[UDP_MAX_BATCH_COMMANDS - 1].channel, UDP_MAX_BATCH_COMMANDS);
+
+    TEST_PASS("batch");
+}
+
+static uint32_t rng_state = 0x2545f491;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Every command the old parser accepted in a well-formed shape gives the
+// same channel, value and fade time
+static void test_legacy_agreement(void)
+{
+    static const char types[] = "CPRWL";
+    static const int speeds[] = {-1, 1, 50, 98, 101, 104, 201, 254, 255};
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        char type = types[rng() % 5];
+        int channel = 1 + (int)(rng() % 511);
+        int value;
+        switch (type)
+        {
+        case 'R':
+            value = (int)(rng() % 1000000000);
+            break;
+        case 'W':
+            value = (int)(rng() % 1000000);
+            break;
+        case 'L':
+            value = 200000000 + (int)(rng() % 10000000);
+            break;
+        default:
+            value = (int)(rng() % 1000);
+            break;
+        }
+        int speed = speeds[rng() % (sizeof(speeds) / sizeof(speeds[0]))];
+
+        char text[48];
+        if (speed < 0)
+        {
+            snprintf(text, sizeof(text), "DMX%c%d#%d", type, channel, value);
+        }
+        else
+        {
+            snprintf(text, sizeof(text), "DMX%c%d#%d#%d", type, channel, value, speed);
+        }
+
+        legacy_udp_command_t old = legacy_udp_parse_command(text);
+        udp_parsed_command_t cmd;
+        CHECK_EQ(parse(text, &cmd), UDP_PARSE_OK);
+        CHECK(old.valid);
+        CHECK_EQ(cmd.type, old.type);
+        CHECK_EQ(cmd.channel, old.channel);
+        CHECK_EQ(cmd.value, old.value);
+        CHECK_EQ(cmd.fade_ms, udp_speed_to_milliseconds(old.speed));
+    }
+
+    TEST_PASS("legacy_agreement");
+}
+
+// Binary record header
+static size_t put_record(uint8_t *p, uint8_t op, uint8_t universe, uint16_t start, uint16_t count, uint16_t fade_ms)
+{
+    p[0] = op;
+    p[1] = universe;
+    p[2] = (uint8_t)(start >> 8);
+    p[3] = (uint8_t)start;
+    p[4] = (uint8_t)(count >> 8);
+    p[5] = (uint8_t)count;
+    p[6] = (uint8_t)(fade_ms >> 8);
+    p[7] = (uint8_t)fade_ms;
+    return UDP_BINARY_RECORD_SIZE;
+}
+
+static void test_binary(void)
+{
+    udp_parsed_command_t cmds[UDP_MAX_BATCH_COMMANDS];
+    uint8_t buf[MAX_UDP_BUFFER_SIZE];
+    size_t len = 0;
+
+    buf[len++] = UDP_BINARY_MAGIC;
+    buf[len++] = UDP_BINARY_VERSION;
+    len += put_record(&buf[len], UDP_BIN_OP_SET, 1, 10, 3, 500);
+    buf[len++] = 1;
+    buf[len++] = 2;
+    buf[len++] = 3;
+    len += put_record(&buf[len], UDP_BIN_OP_FILL, 0, 100, 50, 0);
+    buf[len++] = 200;
+    len += put_record(&buf[len], UDP_BIN_OP_LIGHT_CT, 0, 300, 2, 1000);
+    buf[len++] = 150; // Brightness is capped at 100%
+    buf[len++] = 0x19;
+    buf[len++] = 0x64; // 6500 K
+
+    CHECK(udp_is_binary_packet(buf, len));
+    udp_batch_result_t result = udp_parse_binary(buf, len, cmds, UDP_MAX_BATCH_COMMANDS);
+    CHECK_EQ(result.count, 3);
+    CHECK_EQ(result.rejected, 0);
+
+    CHECK_EQ(cmds[0].type, UDP_CMD_SET_RANGE);
+    CHECK_EQ(cmds[0].universe, 1);
+    CHECK_EQ(cmds[0].channel, 10);
+    CHECK_EQ(cmds[0].count, 3);
+    CHECK_EQ(cmds[0].fade_ms, 500);
+    CHECK(cmds[0].payload == buf + UDP_BINARY_HEADER_SIZE + UDP_BINARY_RECORD_SIZE);
+    CHECK_EQ(cmds[0].payload[2], 3);
+
+    CHECK_EQ(cmds[1].type, UDP_CMD_FILL);
+    CHECK_EQ(cmds[1].channel, 100);
+    CHECK_EQ(cmds[1].count, 50);
+    CHECK_EQ(cmds[1].levels[0], 200);
+    CHECK(cmds[1].payload == NULL);
+
+    CHECK_EQ(cmds[2].type, UDP_CMD_LIGHT_CT);
+    CHECK_EQ(cmds[2].brightness, 100);
+    CHECK_EQ(cmds[2].color_temp, 6500);
+    CHECK_EQ(cmds[2].fade_ms, 1000);
+
+    // The magic byte never starts an ASCII command or an Art-Net packet
+    CHECK(!udp_is_binary_packet((const uint8_t *)"DMXC1#1", 7));
+    CHECK(!udp_is_binary_packet((const uint8_t *)"Art-Net", 8));
+
+    // One bad record rejects the whole datagram
+    static const struct {
+        size_t cut;      // Bytes removed from the end
+        uint8_t op;      // Opcode of the second record
+        uint16_t count;  // Count of the second record
+        udp_parse_error_t err;
+    } bad[] = {
+        {1, UDP_BIN_OP_FILL, 50, UDP_PARSE_ERR_LENGTH},   // Truncated payload
+        {0, 0x7f, 50, UDP_PARSE_ERR_TYPE},                // Unknown opcode
+        {0, UDP_BIN_OP_FILL, 0, UDP_PARSE_ERR_LENGTH},    // Empty range
+        {0, UDP_BIN_OP_FILL, DMX_UNIVERSE_SIZE, UDP_PARSE_ERR_LENGTH},
+        {0, UDP_BIN_OP_SET, 50, UDP_PARSE_ERR_LENGTH},    // Payload runs past the datagram
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i)
+    {
+        uint8_t copy[MAX_UDP_BUFFER_SIZE];
+        memcpy(copy, buf, len);
+        size_t second = UDP_BINARY_HEADER_SIZE + UDP_BINARY_RECORD_SIZE + 3;
+        put_record(&copy[second], bad[i].op, 0, 100, bad[i].count, 0);
+        result = udp_parse_binary(copy, second + UDP_BINARY_RECORD_SIZE + 1 - bad[i].cut,
+                                  cmds, UDP_MAX_BATCH_COMMANDS);
+        CHECK_EQ(result.count, 0);
+        CHECK_EQ(result.rejected, 1);
+        CHECK_EQ(result.first_error, bad[i].err);
+    }
+
+    // A CT record covers exactly two channels; a stray byte is a short record
+    buf[len - 3 - UDP_BINARY_RECORD_SIZE + 5] = 3;
+    CHECK_EQ(udp_parse_binary(buf, len, cmds, UDP_MAX_BATCH_COMMANDS).first_error, UDP_PARSE_ERR_LENGTH);
+    buf[len - 3 - UDP_BINARY_RECORD_SIZE + 5] = 2;
+    CHECK_EQ(udp_parse_binary(buf, len + 1, cmds, UDP_MAX_BATCH_COMMANDS).first_error, UDP_PARSE_ERR_LENGTH);
+
+    // Header problems
+    buf[1] = UDP_BINARY_VERSION + 1;
+    CHECK_EQ(udp_parse_binary(buf, len, cmds, UDP_MAX_BATCH_COMMANDS).first_error, UDP_PARSE_ERR_VERSION);
+    buf[1] = UDP_BINARY_VERSION;
+    CHECK_EQ(udp_parse_binary(buf, UDP_BINARY_HEADER_SIZE, cmds, UDP_MAX_BATCH_COMMANDS).first_error,
+             UDP_PARSE_ERR_EMPTY);
+    CHECK_EQ(udp_parse_binary(buf, len, cmds, 2).first_error, UDP_PARSE_ERR_TOO_MANY);
+    CHECK_EQ(udp_parse_binary(buf, len, cmds, 2).count, 0);
+
+    TEST_PASS("binary");
+}
+
+static void test_span(void)
+{
+    uint8_t buf[UDP_SPAN_HEADER_SIZE + DMX_UNIVERSE_SIZE] = {UDP_SPAN_MAGIC, 1, 0, 100, 0x01, 0xf4};
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; ++i)
+    {
+        buf[UDP_SPAN_HEADER_SIZE + i] = (uint8_t)i;
+    }
+
+    udp_span_t span;
+    CHECK(udp_is_span_packet(buf, 10));
+    CHECK_EQ(udp_parse_span(buf, UDP_SPAN_HEADER_SIZE + 61, &span), UDP_PARSE_OK);
+    CHECK_EQ(span.universe, 1);
+    CHECK_EQ(span.start, 100);
+    CHECK_EQ(span.length, 61);
+    CHECK_EQ(span.fade_ms, 500);
+    CHECK(span.data == buf + UDP_SPAN_HEADER_SIZE);
+
+    // The span must fit channels 1-511
+    CHECK_EQ(udp_parse_span(buf, UDP_SPAN_HEADER_SIZE, &span), UDP_PARSE_ERR_LENGTH);
+    CHECK_EQ(udp_parse_span(buf, UDP_SPAN_HEADER_SIZE + 412, &span), UDP_PARSE_OK);
+    CHECK_EQ(udp_parse_span(buf, UDP_SPAN_HEADER_SIZE + 413, &span), UDP_PARSE_ERR_CHANNEL);
+    CHECK_EQ(udp_parse_span(buf, sizeof(buf), &span), UDP_PARSE_ERR_LENGTH);
+    buf[3] = 0;
+    CHECK_EQ(udp_parse_span(buf, UDP_SPAN_HEADER_SIZE + 1, &span), UDP_PARSE_ERR_CHANNEL);
+    buf[3] = 1;
+    CHECK_EQ(udp_parse_span(buf, UDP_SPAN_HEADER_SIZE + DMX_UNIVERSE_SIZE - 1, &span), UDP_PARSE_OK);
+    buf[0] = UDP_BINARY_MAGIC;
+    CHECK_EQ(udp_parse_span(buf, 10, &span), UDP_PARSE_ERR_EMPTY);
+
+    TEST_PASS("span");
+}
+
+static udp_parse_error_t parse_sub(const char *text, udp_subscription_t *sub)
+{
+    return udp_parse_subscription(text, strlen(text), sub);
+}
+
+static void test_subscription(void)
+{
+    udp_subscription_t sub;
+    CHECK_EQ(parse_sub("SUB2:10#6#200\n", &sub), UDP_PARSE_OK);
+    CHECK(sub.subscribe);
+    CHECK_EQ(sub.universe, 1);
+    CHECK_EQ(sub.channel, 10);
+    CHECK_EQ(sub.count, 6);
+    CHECK_EQ(sub.interval_ms, 200);
+    CHECK_EQ(parse_sub("SUB5#3", &sub), UDP_PARSE_OK);
+    CHECK_EQ(sub.universe, 0);
+    CHECK_EQ(sub.interval_ms, 0);
+    CHECK_EQ(parse_sub("UNSUB", &sub), UDP_PARSE_OK);
+    CHECK(!sub.subscribe);
+
+    // Notifications go back to the sender; a target port is not accepted
+    CHECK_EQ(parse_sub("SUB2:10#6#200#7000", &sub), UDP_PARSE_ERR_TRAILING);
+    CHECK_EQ(parse_sub("SUB510#5", &sub), UDP_PARSE_ERR_CHANNEL);
+    CHECK_EQ(parse_sub("SUB10", &sub), UDP_PARSE_ERR_VALUE);
+
+    TEST_PASS("subscription");
+}
+
+int main(void)
+{
+    test_fields();
+    test_errors();
+    test_explicit_length();
+    test_batch();
+    test_legacy_agreement();
+    test_binary();
+    test_span();
+    test_subscription();
+    return 0;
+}
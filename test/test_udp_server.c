@@ -0,0 +1,212 @@
+// Datagram dispatch of the UDP server: every format on the main port is
+// told apart by its first bytes and length and ends up on the wire
+#include <string.h>
+#include <netinet/in.h>
+
+#include "latency_trace.h"
+#include "server_harness.h"
+
+static size_t put_record(uint8_t *p, uint8_t op, uint8_t universe, uint16_t start, uint16_t count, uint16_t fade_ms)
+{
+    p[0] = op;
+    p[1] = universe;
+    p[2] = (uint8_t)(start >> 8);
+    p[3] = (uint8_t)start;
+    p[4] = (uint8_t)(count >> 8);
+    p[5] = (uint8_t)count;
+    p[6] = (uint8_t)(fade_ms >> 8);
+    p[7] = (uint8_t)fade_ms;
+    return UDP_BINARY_RECORD_SIZE;
+}
+
+static void test_binary(void)
+{
+    server_start(2);
+    udp_server_stats_t before = udp_server_get_stats();
+
+    // Ranges on two universes and a fill in one datagram, applied together
+    uint8_t buf[DMX_UNIVERSE_SIZE];
+    size_t len = 0;
+    buf[len++] = UDP_BINARY_MAGIC;
+    buf[len++] = UDP_BINARY_VERSION;
+    len += put_record(&buf[len], UDP_BIN_OP_SET, 0, 10, 3, 0);
+    buf[len++] = 1;
+    buf[len++] = 2;
+    buf[len++] = 3;
+    len += put_record(&buf[len], UDP_BIN_OP_SET, 1, 500, 2, 0);
+    buf[len++] = 4;
+    buf[len++] = 5;
+    len += put_record(&buf[len], UDP_BIN_OP_FILL, 0, 100, 50, 1000);
+    buf[len++] = 200;
+    deliver(buf, len);
+    tick();
+    CHECK_EQ(wire(0, 10), 1);
+    CHECK_EQ(wire(0, 12), 3);
+    CHECK_EQ(wire(1, 500), 4);
+    CHECK_EQ(wire(1, 501), 5);
+    CHECK(dmx_is_channel_fading(0, 100));
+    CHECK(dmx_is_channel_fading(0, 149));
+    CHECK(!dmx_is_channel_fading(0, 150));
+
+    // ASCII commands still take the text path
+    deliver("DMXC5#77", 8);
+    tick();
+    CHECK_EQ(wire(0, 5), 77);
+
+    // A malformed binary datagram is rejected as a whole
+    buf[UDP_BINARY_HEADER_SIZE + UDP_BINARY_RECORD_SIZE] = 9;         // First level
+    buf[UDP_BINARY_HEADER_SIZE + UDP_BINARY_RECORD_SIZE + 3] = 0x7f;  // Second record's opcode
+    deliver(buf, len);
+    tick();
+    CHECK_EQ(wire(0, 10), 1);
+
+    // 512 bytes that are not valid binary are a raw universe
+    memset(buf, 0, sizeof(buf));
+    buf[0] = UDP_BINARY_MAGIC;
+    buf[1] = 0x42;
+    buf[300] = 99;
+    deliver(buf, DMX_UNIVERSE_SIZE);
+    tick();
+    CHECK_EQ(wire(0, 1), UDP_BINARY_MAGIC);
+    CHECK_EQ(wire(0, 2), 0x42);
+    CHECK_EQ(wire(0, 301), 99);
+    CHECK_EQ(wire(0, 10), 0);
+    CHECK_EQ(dmx_get_active_fade_count(), 0);
+
+    udp_server_stats_t stats = udp_server_get_stats();
+    CHECK_EQ(stats.packets_processed - before.packets_processed, 3);
+    CHECK_EQ(stats.packets_invalid - before.packets_invalid, 1);
+    CHECK_EQ(stats.commands_executed - before.commands_executed, 5); // Raw universe included
+    CHECK_EQ(stats.commands_by_type[UDP_STATS_CMD_SET_RANGE] - before.commands_by_type[UDP_STATS_CMD_SET_RANGE], 2);
+    CHECK_EQ(stats.commands_by_type[UDP_STATS_CMD_FILL] - before.commands_by_type[UDP_STATS_CMD_FILL], 1);
+    server_stop();
+    TEST_PASS("binary");
+}
+
+// A span only touches its channels and their fades
+static void test_span(void)
+{
+    server_start(1);
+    udp_server_stats_t before = udp_server_get_stats();
+
+    CHECK_EQ(dmx_set_channel(0, 50, 255, 5000), DMX_CMD_SUCCESS);
+    CHECK_EQ(dmx_set_channel(0, 120, 255, 5000), DMX_CMD_SUCCESS);
+    CHECK_EQ(dmx_set_channel(0, 200, 40, 0), DMX_CMD_SUCCESS);
+    tick();
+
+    // Channels 100-160, no fade
+    uint8_t buf[DMX_UNIVERSE_SIZE] = {UDP_SPAN_MAGIC, 0, 0, 100, 0, 0};
+    memset(&buf[UDP_SPAN_HEADER_SIZE], 10, 61);
+    deliver(buf, UDP_SPAN_HEADER_SIZE + 61);
+    tick();
+    CHECK_EQ(wire(0, 100), 10);
+    CHECK_EQ(wire(0, 160), 10);
+    CHECK_EQ(wire(0, 161), 0);
+    CHECK(!dmx_is_channel_fading(0, 120));
+    CHECK(dmx_is_channel_fading(0, 50));
+    CHECK_EQ(wire(0, 200), 40);
+
+    // Faded span
+    buf[3] = 200;
+    buf[4] = 0x03;
+    buf[5] = 0xe8; // 1000 ms
+    buf[UDP_SPAN_HEADER_SIZE] = 240;
+    deliver(buf, UDP_SPAN_HEADER_SIZE + 1);
+    tick(); // Starts the fade
+    tick();
+    CHECK(dmx_is_channel_fading(0, 200));
+    CHECK(wire(0, 200) > 40 && wire(0, 200) < 240);
+    for (int i = 0; i < 1000 / DMX_FRAME_INTERVAL_MS + 1; ++i)
+    {
+        tick();
+    }
+    CHECK_EQ(wire(0, 200), 240);
+
+    // Past channel 511: rejected. 512 bytes starting with the magic: raw.
+    buf[2] = 0x01;
+    buf[3] = 0xff;
+    deliver(buf, UDP_SPAN_HEADER_SIZE + 2);
+    memset(buf, 7, sizeof(buf));
+    buf[0] = UDP_SPAN_MAGIC;
+    deliver(buf, DMX_UNIVERSE_SIZE);
+    tick();
+    CHECK_EQ(wire(0, 1), UDP_SPAN_MAGIC);
+    CHECK_EQ(wire(0, 511), 7);
+    CHECK_EQ(dmx_get_active_fade_count(), 0);
+
+    udp_server_stats_t stats = udp_server_get_stats();
+    CHECK_EQ(stats.packets_processed - before.packets_processed, 3);
+    CHECK_EQ(stats.packets_invalid - before.packets_invalid, 1);
+    CHECK_EQ(stats.parse_errors[UDP_PARSE_ERR_CHANNEL] - before.parse_errors[UDP_PARSE_ERR_CHANNEL], 1);
+    server_stop();
+    TEST_PASS("span");
+}
+
+// A rejected subscription is counted under its parse error, one from a
+// source that is not IPv4 only as an invalid packet
+static void test_subscription_errors(void)
+{
+    server_start(1);
+    udp_server_stats_t before = udp_server_get_stats();
+
+    const char bad[] = "SUB0#3";
+    deliver(bad, sizeof(bad) - 1);
+    const char good[] = "SUB1#4";
+    struct sockaddr_in6 source6 = {.sin6_family = AF_INET6, .sin6_port = htons(6454)};
+    CHECK_EQ(handle_subscription(good, sizeof(good) - 1, (const struct sockaddr *)&source6), ESP_ERR_NOT_SUPPORTED);
+    publish_server_stats();
+
+    udp_server_stats_t stats = udp_server_get_stats();
+    CHECK_EQ(stats.packets_invalid - before.packets_invalid, 1);
+    CHECK_EQ(stats.parse_errors[UDP_PARSE_ERR_CHANNEL] - before.parse_errors[UDP_PARSE_ERR_CHANNEL], 1);
+    CHECK_EQ(stats.parse_errors[UDP_PARSE_OK], 0);
+    server_stop();
+    TEST_PASS("subscription_errors");
+}
+
+// Stage latencies on the virtual clock: with the frame clock stopped a
+// command goes out in the pass it wakes, with it running it waits for the
+// tick
+static void test_latency(void)
+{
+    server_start(1);
+    tick_until_idle();
+    latency_trace_reset();
+
+    const char *cmd = "DMXC5#100";
+    deliver(cmd, strlen(cmd));
+    latency_summary_t total = latency_trace_summary(LATENCY_STAGE_TOTAL);
+    CHECK_EQ(total.count, 1);
+    CHECK_EQ(total.max_us, 0);
+
+    // The clock is running now
+    CHECK(host_timer_running(frame_timer));
+    cmd = "DMXC5#200";
+    for (int i = 0; i < 4; ++i)
+    {
+        deliver(cmd, strlen(cmd));
+        tick();
+    }
+    CHECK_EQ(wire(0, 5), 200);
+
+    uint32_t period_us = DMX_FRAME_INTERVAL_MS * 1000;
+    latency_summary_t queue = latency_trace_summary(LATENCY_STAGE_QUEUE);
+    total = latency_trace_summary(LATENCY_STAGE_TOTAL);
+    CHECK_EQ(queue.count, 5);
+    CHECK_EQ(queue.max_us, period_us);
+    CHECK_EQ(queue.p50_us, period_us);
+    CHECK_EQ(total.max_us, period_us);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_PARSE).max_us, 0);
+    CHECK_EQ(latency_trace_summary(LATENCY_STAGE_SEND).count, 5);
+    server_stop();
+    TEST_PASS("latency");
+}
+
+int main(void)
+{
+    test_binary();
+    test_span();
+    test_subscription_errors();
+    test_latency();
+    return 0;
+}
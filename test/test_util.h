@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+// Minimal assertions for the host tests: a failed check prints where and
+// exits, so ctest reports the test as failed
+#define CHECK(cond)                                                               \
+    do                                                                            \
+    {                                                                             \
+        if (!(cond))                                                              \
+        {                                                                         \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1);                                                              \
+        }                                                                         \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                \
+    do                                                                            \
+    {                                                                             \
+        long long _a = (long long)(actual);                                       \
+        long long _e = (long long)(expected);                                     \
+        if (_a != _e)                                                             \
+        {                                                                         \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %lld, expected %lld\n", \
+                    __FILE__, __LINE__, #actual, _a, _e);                         \
+            exit(1);                                                              \
+        }                                                                         \
+    } while (0)
+
+#define TEST_PASS(name) printf("%s: ok\n", name)
+
+// Wall clock for the benchmarks
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Cycle counter where the host has one, nanoseconds otherwise
+static inline uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return bench_now_ns();
+#endif
+}
+
+// Keeps the compiler from dropping a benchmarked result
+static inline void bench_use(uint64_t value)
+{
+    __asm__ volatile("" : : "r"(value) : "memory");
+}
+
+// Benchmarks run a short pass under ctest; BENCH_SCALE=<n> runs n times more
+static inline long bench_iterations(long base)
+{
+    const char *scale = getenv("BENCH_SCALE");
+    long n = scale ? atol(scale) : 1;
+    return base * (n > 0 ? n : 1);
+}
@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+"""Encoder for the UDP2DMX compressed universe stream.
+
+Frames are keyframes (RLE over an all-zero universe) or deltas (RLE over
+the previous frame). See main/include/dmx_stream.h for the wire format.
+
+    dmx_stream.py record capture.dmx            # save raw / ArtDmx universes
+    dmx_stream.py bench capture.dmx             # bytes per frame vs. raw
+    dmx_stream.py send capture.dmx udp2dmx      # stream a recording
+
+Recordings are plain concatenated 512-byte universes.
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+MAGIC = 0xDD
+VERSION = 1
+KEYFRAME = 0
+DELTA = 1
+UNIVERSE_SIZE = 512
+
+TOKEN_SKIP = 0x00      # 00nnnnnn: skip n+1 slots
+TOKEN_LITERAL = 0x40   # 01nnnnnn: n+1 literal levels follow
+TOKEN_REPEAT = 0x80    # 1nnnnnnn: repeat the next level n+1 times
+MAX_SKIP = 64
+MAX_LITERAL = 64
+MAX_REPEAT = 128
+MIN_REPEAT = 3         # Shorter runs are cheaper as literals
+
+
+def encode_tokens(frame, ref):
+    """RLE tokens that turn ref into frame."""
+    out = bytearray()
+    end = len(frame)
+    while end > 0 and frame[end - 1] == ref[end - 1]:
+        end -= 1
+
+    def unchanged(j, n):
+        return all(j + k < end and frame[j + k] == ref[j + k] for k in range(n))
+
+    def repeats(j, n):
+        return all(j + k < end and frame[j + k] == frame[j] for k in range(n))
+
+    i = 0
+    while i < end:
+        if frame[i] == ref[i]:
+            run = 1
+            while i + run < end and frame[i + run] == ref[i + run] and run < MAX_SKIP:
+                run += 1
+            out.append(TOKEN_SKIP | (run - 1))
+            i += run
+            continue
+
+        run = 1
+        while i + run < end and frame[i + run] == frame[i] and run < MAX_REPEAT:
+            run += 1
+        if run >= MIN_REPEAT:
+            out += bytes([TOKEN_REPEAT | (run - 1), frame[i]])
+            i += run
+            continue
+
+        # Literal run; short unchanged gaps are cheaper to send than a skip
+        j = i + 1
+        while j < end and j - i < MAX_LITERAL and not unchanged(j, 2) and not repeats(j, MIN_REPEAT):
+            j += 1
+        out.append(TOKEN_LITERAL | (j - i - 1))
+        out += frame[i:j]
+        i = j
+
+    return bytes(out)
+
+
+def decode_tokens(body, ref):
+    """Reference decoder, mirrors dmx_stream.c."""
+    levels = bytearray(ref)
+    slot = 0
+    p = 0
+    while p < len(body):
+        token = body[p]
+        p += 1
+        if token & TOKEN_REPEAT:
+            run = (token & 0x7F) + 1
+            levels[slot:slot + run] = bytes([body[p]]) * run
+            p += 1
+        elif token & TOKEN_LITERAL:
+            run = (token & 0x3F) + 1
+            levels[slot:slot + run] = body[p:p + run]
+            p += run
+        else:
+            run = (token & 0x3F) + 1
+        slot += run
+        if slot > UNIVERSE_SIZE:
+            raise ValueError("tokens run past the universe")
+    return bytes(levels)
+
+
+class StreamEncoder:
+    """Turns a sequence of universes into stream packets."""
+
+    def __init__(self, universe=0, keyframe_interval=30):
+        self.universe = universe
+        self.keyframe_interval = keyframe_interval
+        self.sequence = 0
+        self.previous = None
+        self.since_keyframe = 0
+
+    def encode(self, frame):
+        frame = bytes(frame[:UNIVERSE_SIZE]).ljust(UNIVERSE_SIZE, b"\0")
+        base = self.sequence
+        self.sequence = (self.sequence + 1) & 0xFF
+
+        keyframe_body = None
+        if self.previous is None or self.since_keyframe + 1 >= self.keyframe_interval:
+            kind, body = KEYFRAME, encode_tokens(frame, bytes(UNIVERSE_SIZE))
+        else:
+            kind, body = DELTA, encode_tokens(frame, self.previous)
+            # Big changes can be cheaper as a keyframe
+            keyframe_body = encode_tokens(frame, bytes(UNIVERSE_SIZE))
+            if len(keyframe_body) <= len(body):
+                kind, body = KEYFRAME, keyframe_body
+
+        self.since_keyframe = 0 if kind == KEYFRAME else self.since_keyframe + 1
+        self.previous = frame
+        header = struct.pack("BBBBBB", MAGIC, VERSION, kind, self.universe,
+                             self.sequence, base if kind == DELTA else 0)
+        return header + body
+
+
+def read_recording(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    return [data[i:i + UNIVERSE_SIZE] for i in range(0, len(data) - UNIVERSE_SIZE + 1, UNIVERSE_SIZE)]
+
+
+def percentile(values, p):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100))]
+
+
+def cmd_bench(args):
+    frames = read_recording(args.recording)
+    if not frames:
+        sys.exit("recording holds no complete universe")
+
+    encoder = StreamEncoder(keyframe_interval=args.keyframe_interval)
+    sizes = []
+    keyframes = 0
+    reference = bytes(UNIVERSE_SIZE)
+    for frame in frames:
+        packet = encoder.encode(frame)
+        sizes.append(len(packet))
+        if packet[2] == KEYFRAME:
+            keyframes += 1
+            reference = bytes(UNIVERSE_SIZE)
+        reference = decode_tokens(packet[6:], reference)
+        if reference != frame:
+            sys.exit("round trip mismatch at frame %d" % len(sizes))
+
+    total = sum(sizes)
+    print("frames:          %d (%d keyframes, interval %d)" % (len(frames), keyframes, args.keyframe_interval))
+    print("raw bytes/frame: %d" % UNIVERSE_SIZE)
+    print("bytes/frame:     avg %.1f  p50 %d  p95 %d  max %d"
+          % (total / len(sizes), percentile(sizes, 50), percentile(sizes, 95), max(sizes)))
+    print("compression:     %.1fx" % (UNIVERSE_SIZE * len(frames) / total))
+
+
+def cmd_record(args):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", args.port))
+    count = 0
+    with open(args.recording, "wb") as f:
+        try:
+            while args.frames == 0 or count < args.frames:
+                data, _ = sock.recvfrom(2048)
+                if len(data) == UNIVERSE_SIZE:
+                    frame = data
+                elif data[:8] == b"Art-Net\0" and data[8:10] == b"\x00\x50" and len(data) > 18:
+                    length = struct.unpack(">H", data[16:18])[0]
+                    frame = data[18:18 + length].ljust(UNIVERSE_SIZE, b"\0")
+                else:
+                    continue
+                f.write(frame)
+                count += 1
+        except KeyboardInterrupt:
+            pass
+    print("recorded %d frames" % count)
+
+
+def cmd_send(args):
+    frames = read_recording(args.recording)
+    if not frames:
+        sys.exit("recording holds no complete universe")
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    encoder = StreamEncoder(universe=args.universe, keyframe_interval=args.keyframe_interval)
+    period = 1.0 / args.fps
+    sent = 0
+    next_time = time.monotonic()
+    try:
+        while True:
+            for frame in frames:
+                packet = encoder.encode(frame)
+                sock.sendto(packet, (args.host, args.port))
+                sent += len(packet)
+                next_time += period
+                time.sleep(max(0.0, next_time - time.monotonic()))
+            if not args.loop:
+                break
+    except KeyboardInterrupt:
+        pass
+    print("sent %d bytes" % sent)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("bench", help="encode a recording and report bytes per frame")
+    p.add_argument("recording")
+    p.add_argument("--keyframe-interval", type=int, default=30)
+    p.set_defaults(func=cmd_bench)
+
+    p = sub.add_parser("record", help="record raw 512-byte or ArtDmx universes")
+    p.add_argument("recording")
+    p.add_argument("--port", type=int, default=6454)
+    p.add_argument("--frames", type=int, default=0, help="stop after this many frames (0 = Ctrl+C)")
+    p.set_defaults(func=cmd_record)
+
+    p = sub.add_parser("send", help="stream a recording to the gateway")
+    p.add_argument("recording")
+    p.add_argument("host")
+    p.add_argument("--port", type=int, default=6454)
+    p.add_argument("--universe", type=int, default=0, help="0 = universe 1")
+    p.add_argument("--fps", type=float, default=40.0)
+    p.add_argument("--keyframe-interval", type=int, default=30)
+    p.add_argument("--loop", action="store_true")
+    p.set_defaults(func=cmd_send)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
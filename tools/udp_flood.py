@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Flood generator for the UDP2DMX per-source rate limiter.
+
+Sends a mix of raw universes, DMX commands and binary commands at a fixed
+packet rate, the way a misbehaving logic block would:
+
+    udp_flood.py udp2dmx                        # 10 kpps for 10 s
+    udp_flood.py udp2dmx --pps 2000 --mix frames
+
+While it runs, the gateway's serial log should keep reporting its normal
+render frames/s and print one rate limit summary per stats interval
+instead of a line per packet.
+"""
+
+import argparse
+import random
+import socket
+import struct
+import time
+
+UNIVERSE_SIZE = 512
+BINARY_MAGIC = 0xDB
+BINARY_VERSION = 1
+OP_FILL = 2
+
+
+def raw_frame(n):
+    return bytes([(n + i) & 0xFF for i in range(UNIVERSE_SIZE)])
+
+
+def ascii_command(n):
+    # Latest-wins target: the same few channels over and over
+    return ("DMXC%d#%d#0" % (1 + n % 8, n & 0xFF)).encode()
+
+
+def binary_command(n):
+    record = struct.pack(">BBHHHB", OP_FILL, 0, 1 + n % 8, 1, 0, n & 0xFF)
+    return bytes([BINARY_MAGIC, BINARY_VERSION]) + record
+
+
+GENERATORS = {
+    "frames": [raw_frame],
+    "commands": [ascii_command, binary_command],
+    "mixed": [raw_frame, ascii_command, binary_command],
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=6454)
+    parser.add_argument("--pps", type=int, default=10000, help="packets per second")
+    parser.add_argument("--seconds", type=float, default=10.0)
+    parser.add_argument("--mix", choices=sorted(GENERATORS), default="mixed")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    generators = GENERATORS[args.mix]
+    packets = [random.choice(generators)(n) for n in range(1024)]
+
+    period = 1.0 / args.pps
+    start = time.monotonic()
+    deadline = start + args.seconds
+    next_time = start
+    sent = 0
+    errors = 0
+    try:
+        while time.monotonic() < deadline:
+            # Send in bursts of whatever is due; sleeping per packet cannot
+            # reach 10 kpps
+            now = time.monotonic()
+            while next_time <= now:
+                try:
+                    sock.sendto(packets[sent % len(packets)], (args.host, args.port))
+                except OSError:
+                    errors += 1
+                sent += 1
+                next_time += period
+            time.sleep(max(0.0, min(0.001, next_time - time.monotonic())))
+    except KeyboardInterrupt:
+        pass
+
+    elapsed = time.monotonic() - start
+    print("sent %d packets in %.1f s (%.0f pps, %d send errors)" % (sent, elapsed, sent / elapsed, errors))
+
+
+if __name__ == "__main__":
+    main()